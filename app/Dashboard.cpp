@@ -0,0 +1,450 @@
+#include "Dashboard.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <future>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "imgui.h"
+
+#include "Blas.hpp"
+#include "LinAlg.hpp"
+#include "Matrix.hpp"
+#include "Parallel.hpp"
+#include "Progress.hpp"
+#include "Solve.hpp"
+#include "Timer.hpp"
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace
+{
+    enum Op { kMatVec, kMatMul, kSolve, kOpCount };
+    enum Backend { kNaive, kBlas, kThreaded, kBackendCount };
+
+    const char* kOpNames[kOpCount] = { "MatVec", "MatMul", "Solve" };
+    const char* kBackendNames[kBackendCount] = { "naive", "blas", "threaded" };
+
+    // naive: Matrix::Multiply / SolvePartialPivot. blas: Gemv, Gemm (per blocs) i FactorizeLU + SolveFactorized
+    // (la mateixa eliminaci sense blocs, per amb la factoritzaci separada de la soluci).
+    // threaded: GemmParallel. MatVec i Solve no tenen versi amb fils.
+    bool Supported(int op, int be)
+    {
+        return be != kThreaded || op == kMatMul;
+    }
+
+    // Flops terics (termes dominants): 2n^2, 2n^3 i 2n^3/3.
+    double TheoryFlops(int op, double n)
+    {
+        if (op == kMatVec) return 2.0 * n * n;
+        if (op == kMatMul) return 2.0 * n * n * n;
+        return 2.0 * n * n * n / 3.0;
+    }
+
+    struct Point
+    {
+        int op = 0, backend = 0, n = 0;
+        double ms = 0.0, gflops = 0.0, resid = 0.0;
+    };
+
+    struct SweepConfig
+    {
+        bool ops[kOpCount] = { true, true, true };
+        bool backends[kBackendCount] = { true, true, true };
+        int n_min = 64, n_max = 1024;
+        float step = 1.5f;
+        int reps = 3;
+        int threads = 0;        // 0 => tots
+    };
+
+    // Estat compartit amb el fil de l'escombrat: 'points' creix a mesura que acaben les mesures.
+    struct SweepState
+    {
+        std::mutex mtx;
+        std::vector<Point> points;
+        std::string status;
+        LinAlg::ProgressToken progress;
+        std::future<void> task;
+        Timer clock;
+    };
+
+    SweepConfig g_cfg;
+    SweepState g_sweep;
+
+    bool Running() { return g_sweep.task.valid(); }
+
+    // Matrius n x n vives alhora en el pitjor punt: A, B, C, el resultat de Multiply i la cpia de FactorizeLU.
+    const double kLiveMatrices = 5.0;
+
+    // Memria fsica lliure en bytes (0 si no es pot saber).
+    double AvailableBytes()
+    {
+#if defined(_WIN32)
+        MEMORYSTATUSEX st;
+        st.dwLength = sizeof(st);
+        return GlobalMemoryStatusEx(&st) ? double(st.ullAvailPhys) : 0.0;
+#elif defined(_SC_AVPHYS_PAGES)
+        const long pages = sysconf(_SC_AVPHYS_PAGES), page = sysconf(_SC_PAGESIZE);
+        return pages > 0 && page > 0 ? double(pages) * double(page) : 0.0;
+#else
+        return 0.0;
+#endif
+    }
+
+    // n mxim perqu l'escombrat no ocupi ms de la meitat de la memria lliure (es mesura en obrir el panell).
+    int MaxSweepN()
+    {
+        static const double avail = AvailableBytes();
+        if (avail <= 0.0) return 8192;
+        return std::max(2, int(std::sqrt(0.5 * avail / (kLiveMatrices * sizeof(double)))));
+    }
+
+    std::vector<int> Sizes(const SweepConfig& cfg)
+    {
+        std::vector<int> out;
+        for (double v = cfg.n_min; v <= cfg.n_max + 0.5; v *= std::max(1.05f, cfg.step)) {
+            int n = int(std::lround(v));
+            if (out.empty() || n > out.back()) out.push_back(n);
+        }
+        return out;
+    }
+
+    double RelDiff(const Vec& a, const Vec& b)
+    {
+        double num = 0.0, den = 0.0;
+        for (std::size_t i = 0; i < a.size(); ++i) { num += (a[i] - b[i]) * (a[i] - b[i]); den += b[i] * b[i]; }
+        return den > 0.0 ? std::sqrt(num / den) : std::sqrt(num);
+    }
+
+    // Una mesura: el millor de 'reps' execucions. Retorna false si s'ha cancellat.
+    bool MeasurePoint(const SweepConfig& cfg, int op, int be, const Matrix& A, const Matrix& B, const Vec& x, const Vec& b, Point& p)
+    {
+        const std::size_t n = A.rows;
+        LinAlg::ProgressToken* tok = &g_sweep.progress;
+        double best = 1e300, resid = 0.0;
+        for (int r = 0; r < std::max(1, cfg.reps); ++r) {
+            if (tok->Cancelled()) return false;
+            Timer t; t.Tic();
+            if (op == kMatVec) {
+                Vec y(n);
+                if (be == kNaive) y = A.Multiply(x, nullptr);
+                else LinAlg::Gemv(LinAlg::Trans::No, 1.0, A, x, 0.0, y, nullptr);
+                best = std::min(best, t.TocMs());
+                resid = RelDiff(y, b);      // b = A*x calculat amb Multiply
+            }
+            else if (op == kMatMul) {
+                Matrix C(n, n);
+                if (be == kNaive) C = A.Multiply(B, nullptr, tok);
+                else if (be == kBlas) LinAlg::Gemm(LinAlg::Trans::No, LinAlg::Trans::No, 1.0, A, B, 0.0, C, nullptr);
+                else LinAlg::GemmParallel(LinAlg::Trans::No, LinAlg::Trans::No, 1.0, A, B, 0.0, C, std::size_t(cfg.threads), nullptr);
+                if (tok->Cancelled()) return false;
+                best = std::min(best, t.TocMs());
+                // Prova de Freivalds: C x contra A (B x), en O(n^2).
+                resid = RelDiff(C.Multiply(x, nullptr), A.Multiply(B.Multiply(x, nullptr), nullptr));
+            }
+            else {
+                Vec sol;
+                if (be == kNaive) {
+                    LinAlg::SolveReport rep = LinAlg::SolvePartialPivot(A, b, 1e-12, tok);
+                    if (rep.cancelled) return false;
+                    sol = rep.x;
+                }
+                else {
+                    LinAlg::LUFactors F = LinAlg::FactorizeLU(A, 1e-12);
+                    sol = b;
+                    if (!F.singular) LinAlg::SolveFactorized(F, sol);
+                }
+                best = std::min(best, t.TocMs());
+                resid = sol.size() == n ? LinAlg::RelativeResidual(A, sol, b, nullptr) : std::nan("");
+            }
+        }
+        p.op = op; p.backend = be; p.n = int(n);
+        p.ms = best;
+        p.gflops = best > 0.0 ? TheoryFlops(op, double(n)) / (best * 1e6) : 0.0;
+        p.resid = resid;
+        return true;
+    }
+
+    void RunSweep(SweepConfig cfg)
+    {
+        const std::vector<int> sizes = Sizes(cfg);
+
+        // Progrs ponderat per flops: les mides grans dominen el temps.
+        double total = 0.0, done = 0.0;
+        for (int n : sizes)
+            for (int op = 0; op < kOpCount; ++op)
+                for (int be = 0; be < kBackendCount; ++be)
+                    if (cfg.ops[op] && cfg.backends[be] && Supported(op, be)) total += TheoryFlops(op, n);
+
+        std::mt19937 rng(42);
+        std::uniform_real_distribution<double> U(-1.0, 1.0);
+        for (int n : sizes) {
+            // A diagonalment dominant (Solve sense sorpreses), B i x aleatoris, b = A*x.
+            Matrix A(n, n), B(n, n);
+            Vec x((std::size_t)n);
+            for (int i = 0; i < n; ++i) {
+                double rowsum = 0.0;
+                for (int j = 0; j < n; ++j) {
+                    if (i != j) { double v = U(rng); A.a[(std::size_t)i * n + j] = v; rowsum += std::fabs(v); }
+                    B.a[(std::size_t)i * n + j] = U(rng);
+                }
+                A.a[(std::size_t)i * n + i] = rowsum + 1.0;
+                x[(std::size_t)i] = U(rng);
+            }
+            Vec b = A.Multiply(x, nullptr);
+
+            for (int op = 0; op < kOpCount; ++op) {
+                for (int be = 0; be < kBackendCount; ++be) {
+                    if (!cfg.ops[op] || !cfg.backends[be] || !Supported(op, be)) continue;
+                    {
+                        std::lock_guard<std::mutex> lock(g_sweep.mtx);
+                        g_sweep.status = std::string(kOpNames[op]) + "/" + kBackendNames[be] + " n=" + std::to_string(n);
+                    }
+                    Point p;
+                    if (!MeasurePoint(cfg, op, be, A, B, x, b, p)) {
+                        std::lock_guard<std::mutex> lock(g_sweep.mtx);
+                        g_sweep.status = "Aturat";
+                        return;
+                    }
+                    done += TheoryFlops(op, n);
+                    g_sweep.progress.Set(total > 0.0 ? done / total : 1.0);
+                    std::lock_guard<std::mutex> lock(g_sweep.mtx);
+                    g_sweep.points.push_back(p);
+                }
+            }
+        }
+        std::lock_guard<std::mutex> lock(g_sweep.mtx);
+        g_sweep.status = "Fet";
+    }
+
+    // ---------------- Grfiques log-log amb ImDrawList ----------------
+    struct Series
+    {
+        std::string label;
+        ImU32 col = 0;
+        bool dashed = false;
+        std::vector<ImVec2> pts;    // (log10 n, log10 valor)
+    };
+
+    ImU32 SeriesColor(int op, int be)
+    {
+        // Mateixa famlia de color per operaci; el backend en canvia la lluminositat.
+        static const ImVec4 base[kOpCount] = { ImVec4(0.30f, 0.70f, 1.00f, 1), ImVec4(1.00f, 0.55f, 0.20f, 1), ImVec4(0.45f, 0.90f, 0.45f, 1) };
+        const float k = 1.0f - 0.28f * float(be);
+        const ImVec4 c = base[op];
+        return ImGui::ColorConvertFloat4ToU32(ImVec4(c.x * k, c.y * k, c.z * k, 1.0f));
+    }
+
+    void DashedLine(ImDrawList* dl, ImVec2 a, ImVec2 b, ImU32 col)
+    {
+        const float dx = b.x - a.x, dy = b.y - a.y;
+        const float len = std::sqrt(dx * dx + dy * dy);
+        const int segs = std::max(1, int(len / 6.0f));
+        for (int s = 0; s < segs; s += 2) {
+            const float t0 = float(s) / segs, t1 = float(std::min(s + 1, segs)) / segs;
+            dl->AddLine(ImVec2(a.x + dx * t0, a.y + dy * t0), ImVec2(a.x + dx * t1, a.y + dy * t1), col, 1.5f);
+        }
+    }
+
+    void DrawLogPlot(const char* id, const char* ylabel, const std::vector<Series>& series, float height)
+    {
+        ImGui::SeparatorText(ylabel);
+        float x0 = 1e30f, x1 = -1e30f, y0 = 1e30f, y1 = -1e30f;
+        for (const Series& s : series) {
+            for (const ImVec2& p : s.pts) {
+                x0 = std::min(x0, p.x); x1 = std::max(x1, p.x);
+                y0 = std::min(y0, p.y); y1 = std::max(y1, p.y);
+            }
+        }
+        if (x0 > x1) { ImGui::TextDisabled("(sense dades)"); return; }
+        // Eixos ajustats a dcades senceres.
+        x0 = std::floor(x0); x1 = std::max(std::ceil(x1), x0 + 1.0f);
+        y0 = std::floor(y0); y1 = std::max(std::ceil(y1), y0 + 1.0f);
+
+        const float margin_l = 48.0f, margin_b = 18.0f;
+        const ImVec2 origin = ImGui::GetCursorScreenPos();
+        const float width = std::max(120.0f, ImGui::GetContentRegionAvail().x);
+        ImGui::InvisibleButton(id, ImVec2(width, height));
+        const bool hovered = ImGui::IsItemHovered();
+
+        const ImVec2 pmin(origin.x + margin_l, origin.y + 4.0f), pmax(origin.x + width - 8.0f, origin.y + height - margin_b);
+        auto to_screen = [&](ImVec2 p) {
+            return ImVec2(pmin.x + (p.x - x0) / (x1 - x0) * (pmax.x - pmin.x), pmax.y - (p.y - y0) / (y1 - y0) * (pmax.y - pmin.y));
+        };
+
+        ImDrawList* dl = ImGui::GetWindowDrawList();
+        dl->AddRectFilled(pmin, pmax, IM_COL32(25, 25, 30, 255));
+        char buf[32];
+        for (float d = x0; d <= x1 + 0.01f; d += 1.0f) {
+            ImVec2 a = to_screen(ImVec2(d, y0)), b = to_screen(ImVec2(d, y1));
+            dl->AddLine(a, b, IM_COL32(70, 70, 80, 255));
+            std::snprintf(buf, sizeof(buf), "%g", std::pow(10.0, double(d)));
+            dl->AddText(ImVec2(a.x - 10.0f, pmax.y + 2.0f), IM_COL32(180, 180, 180, 255), buf);
+        }
+        for (float d = y0; d <= y1 + 0.01f; d += 1.0f) {
+            ImVec2 a = to_screen(ImVec2(x0, d)), b = to_screen(ImVec2(x1, d));
+            dl->AddLine(a, b, IM_COL32(70, 70, 80, 255));
+            std::snprintf(buf, sizeof(buf), "1e%d", int(d));
+            dl->AddText(ImVec2(origin.x + 2.0f, a.y - 7.0f), IM_COL32(180, 180, 180, 255), buf);
+        }
+        dl->AddRect(pmin, pmax, IM_COL32(120, 120, 130, 255));
+
+        dl->PushClipRect(pmin, pmax, true);
+        std::vector<ImVec2> scr;
+        for (const Series& s : series) {
+            scr.clear();
+            for (const ImVec2& p : s.pts) scr.push_back(to_screen(p));
+            if (s.dashed) {
+                for (std::size_t i = 1; i < scr.size(); ++i) DashedLine(dl, scr[i - 1], scr[i], s.col);
+            }
+            else {
+                if (scr.size() > 1) dl->AddPolyline(scr.data(), int(scr.size()), s.col, 0, 2.0f);
+                for (const ImVec2& q : scr) dl->AddCircleFilled(q, 3.0f, s.col);
+            }
+        }
+        dl->PopClipRect();
+
+        // Llegenda a dalt a l'esquerra.
+        float ly = pmin.y + 4.0f;
+        for (const Series& s : series) {
+            dl->AddRectFilled(ImVec2(pmin.x + 6.0f, ly + 3.0f), ImVec2(pmin.x + 16.0f, ly + 11.0f), s.col);
+            dl->AddText(ImVec2(pmin.x + 20.0f, ly), IM_COL32(220, 220, 220, 255), s.label.c_str());
+            ly += ImGui::GetTextLineHeight();
+        }
+
+        // Tooltip amb el punt mesurat ms proper al cursor.
+        if (hovered) {
+            const ImVec2 m = ImGui::GetIO().MousePos;
+            const Series* best_s = nullptr; ImVec2 best_p; float best_d = 15.0f * 15.0f;
+            for (const Series& s : series) {
+                if (s.dashed) continue;
+                for (const ImVec2& p : s.pts) {
+                    ImVec2 q = to_screen(p);
+                    float d = (q.x - m.x) * (q.x - m.x) + (q.y - m.y) * (q.y - m.y);
+                    if (d < best_d) { best_d = d; best_s = &s; best_p = p; }
+                }
+            }
+            if (best_s) ImGui::SetTooltip("%s\nn = %.0f\n%s = %.4g", best_s->label.c_str(), std::pow(10.0, double(best_p.x)), ylabel, std::pow(10.0, double(best_p.y)));
+        }
+    }
+}
+
+void DrawDashboard(bool* open)
+{
+    if (!ImGui::Begin("Rendiment", open)) { ImGui::End(); return; }
+
+    // Recollim l'escombrat quan acaba (tamb desprs d'una cancellaci).
+    if (Running() && g_sweep.task.wait_for(std::chrono::seconds(0)) == std::future_status::ready) g_sweep.task.get();
+
+    ImGui::BeginDisabled(Running());
+    ImGui::TextUnformatted("Operacions:");
+    for (int op = 0; op < kOpCount; ++op) { ImGui::SameLine(); ImGui::Checkbox(kOpNames[op], &g_cfg.ops[op]); }
+    ImGui::TextUnformatted("Backends:   ");
+    for (int be = 0; be < kBackendCount; ++be) { ImGui::SameLine(); ImGui::Checkbox(kBackendNames[be], &g_cfg.backends[be]); }
+    ImGui::SetNextItemWidth(120); ImGui::InputInt("n min", &g_cfg.n_min); ImGui::SameLine();
+    ImGui::SetNextItemWidth(120); ImGui::InputInt("n max", &g_cfg.n_max);
+    ImGui::SetNextItemWidth(120); ImGui::SliderFloat("factor", &g_cfg.step, 1.1f, 4.0f, "%.2f"); ImGui::SameLine();
+    ImGui::SetNextItemWidth(120); ImGui::SliderInt("reps", &g_cfg.reps, 1, 10); ImGui::SameLine();
+    ImGui::SetNextItemWidth(120); ImGui::InputInt("fils (0=tots)", &g_cfg.threads);
+    g_cfg.n_min = std::max(2, g_cfg.n_min);
+    g_cfg.n_min = std::min(g_cfg.n_min, MaxSweepN());
+    g_cfg.n_max = std::min(std::max(g_cfg.n_min, g_cfg.n_max), MaxSweepN());
+    g_cfg.threads = std::max(0, g_cfg.threads);
+    ImGui::EndDisabled();
+    ImGui::TextDisabled("n max limitat a %d per la memoria lliure", MaxSweepN());
+    ImGui::TextDisabled("threaded: nomes MatMul (GemmParallel, %d fils disponibles)", int(LinAlg::HardwareThreads()));
+
+    if (Running()) {
+        char overlay[96];
+        std::string status;
+        { std::lock_guard<std::mutex> lock(g_sweep.mtx); status = g_sweep.status; }
+        std::snprintf(overlay, sizeof(overlay), "%s  %.0f%% (%.1f s)", status.c_str(), g_sweep.progress.Fraction() * 100.0, g_sweep.clock.TocMs() / 1000.0);
+        ImGui::ProgressBar(float(g_sweep.progress.Fraction()), ImVec2(-1.0f, 0.0f), overlay);
+        ImGui::BeginDisabled(g_sweep.progress.Cancelled());
+        if (ImGui::Button("Atura")) g_sweep.progress.Cancel();
+        ImGui::EndDisabled();
+    }
+    else {
+        if (ImGui::Button("Executa escombrat")) {
+            {
+                std::lock_guard<std::mutex> lock(g_sweep.mtx);
+                g_sweep.points.clear();
+                g_sweep.status = "Iniciant";
+            }
+            g_sweep.progress.Reset();
+            g_sweep.clock.Tic();
+            g_sweep.task = std::async(std::launch::async, RunSweep, g_cfg);
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Neteja")) { std::lock_guard<std::mutex> lock(g_sweep.mtx); g_sweep.points.clear(); g_sweep.status.clear(); }
+        std::lock_guard<std::mutex> lock(g_sweep.mtx);
+        if (!g_sweep.status.empty()) { ImGui::SameLine(); ImGui::TextDisabled("%s", g_sweep.status.c_str()); }
+    }
+
+    std::vector<Point> pts;
+    { std::lock_guard<std::mutex> lock(g_sweep.mtx); pts = g_sweep.points; }
+
+    // Una srie per (operaci, backend), en l'ordre de mesura (n creixent).
+    std::vector<Series> t_series, g_series, r_series;
+    double peak = 0.0;
+    int n_lo = 1 << 30, n_hi = 0;
+    for (int op = 0; op < kOpCount; ++op) {
+        for (int be = 0; be < kBackendCount; ++be) {
+            Series t, g, r;
+            t.label = g.label = r.label = std::string(kOpNames[op]) + " " + kBackendNames[be];
+            t.col = g.col = r.col = SeriesColor(op, be);
+            for (const Point& p : pts) {
+                if (p.op != op || p.backend != be) continue;
+                const float lx = float(std::log10(double(p.n)));
+                if (p.ms > 0.0) t.pts.push_back(ImVec2(lx, float(std::log10(p.ms))));
+                if (p.gflops > 0.0) g.pts.push_back(ImVec2(lx, float(std::log10(p.gflops))));
+                if (p.resid > 0.0) r.pts.push_back(ImVec2(lx, float(std::log10(p.resid))));
+                peak = std::max(peak, p.gflops);
+                n_lo = std::min(n_lo, p.n); n_hi = std::max(n_hi, p.n);
+            }
+            if (!t.pts.empty()) t_series.push_back(t);
+            if (!g.pts.empty()) g_series.push_back(g);
+            if (!r.pts.empty()) r_series.push_back(r);
+        }
+    }
+
+    // Referncies teriques: temps que trigarien n^3 i 2n^3/3 flops al millor ritme mesurat.
+    if (peak > 0.0 && n_hi > n_lo) {
+        const char* labels[2] = { "n^3 @ pic", "2n^3/3 @ pic" };
+        const double coef[2] = { 1.0, 2.0 / 3.0 };
+        for (int k = 0; k < 2; ++k) {
+            Series s; s.label = labels[k]; s.dashed = true;
+            s.col = k == 0 ? IM_COL32(200, 200, 200, 255) : IM_COL32(150, 150, 150, 255);
+            for (int i = 0; i <= 16; ++i) {
+                const double n = n_lo * std::pow(double(n_hi) / n_lo, i / 16.0);
+                s.pts.push_back(ImVec2(float(std::log10(n)), float(std::log10(coef[k] * n * n * n / (peak * 1e6)))));
+            }
+            t_series.push_back(s);
+        }
+    }
+
+    const float h = std::max(140.0f, (ImGui::GetContentRegionAvail().y - 60.0f) / 3.0f);
+    DrawLogPlot("##temps", "temps (ms)", t_series, h);
+    DrawLogPlot("##gflops", "GFLOP/s", g_series, h);
+    DrawLogPlot("##residu", "residu relatiu", r_series, h);
+
+    ImGui::End();
+}
+
+void ShutdownDashboard()
+{
+    if (Running()) {
+        g_sweep.progress.Cancel();
+        g_sweep.task.wait();
+    }
+}
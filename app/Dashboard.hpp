@@ -0,0 +1,8 @@
+#pragma once
+
+// Panell "Rendiment": escombrat de mides en segon pla (operaci x backend) i grfiques
+// log-log de temps, GFLOP/s i residu en funci de n, amb els comptatges terics superposats.
+void DrawDashboard(bool* open);
+
+// Cancella l'escombrat en curs (si n'hi ha) i l'espera. Cal cridar-la abans de tancar la GUI.
+void ShutdownDashboard();
\ No newline at end of file
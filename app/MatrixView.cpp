@@ -0,0 +1,424 @@
+#include "MatrixView.hpp"
+
+#include <GL/glew.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <future>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "imgui.h"
+
+#include "Parallel.hpp"
+
+namespace
+{
+    constexpr std::size_t kBaseTiles = 512;     // costat mxim del nivell 0 de la pirmide
+
+    // Resum d'una tessella: |a| mnim, mxim i mnim no nul, i quants elements no nuls t.
+    struct Tile
+    {
+        float mn = 0.0f, mx = 0.0f, mnz = 0.0f;
+        std::uint32_t nnz = 0, count = 0;
+    };
+
+    Tile Merge(const Tile& a, const Tile& b)
+    {
+        if (!a.count) return b;
+        if (!b.count) return a;
+        Tile t;
+        t.mn = std::min(a.mn, b.mn);
+        t.mx = std::max(a.mx, b.mx);
+        t.mnz = !a.nnz ? b.mnz : !b.nnz ? a.mnz : std::min(a.mnz, b.mnz);
+        t.nnz = a.nnz + b.nnz;
+        t.count = a.count + b.count;
+        return t;
+    }
+
+    struct Level
+    {
+        std::size_t rows = 0, cols = 0;
+        std::vector<Tile> t;
+        const Tile& At(std::size_t i, std::size_t j) const { return t[i * cols + j]; }
+    };
+
+    // Rang d'elements [r0, r1) x [c0, c1) que cobreix la pirmide.
+    struct Region
+    {
+        std::size_t r0 = 0, r1 = 0, c0 = 0, c1 = 0;
+        bool operator==(const Region& o) const { return r0 == o.r0 && r1 == o.r1 && c0 == o.c0 && c1 == o.c1; }
+        bool operator!=(const Region& o) const { return !(*this == o); }
+    };
+
+    struct Pyramid
+    {
+        Region reg;
+        std::size_t tile_r = 1, tile_c = 1;     // elements per tessella al nivell 0
+        std::vector<Level> levels;              // levels[0] el ms fi; l'ltim s 1x1
+        float lo = 0.0f, hi = 0.0f;             // rang de colors en log10 |a|
+        bool ok = false;
+    };
+
+    // Nivell 0: cada tessella resumeix tile_r x tile_c elements, recorreguts per files (accs
+    // contigu). Els nivells segents agrupen 2x2 fins arribar a una sola tessella.
+    Pyramid BuildPyramid(const Matrix* M, Region reg, const std::atomic<bool>* cancel)
+    {
+        Pyramid p;
+        p.reg = reg;
+        const std::size_t h = reg.r1 - reg.r0, w = reg.c1 - reg.c0;
+        if (!h || !w) return p;
+        p.tile_r = (h + kBaseTiles - 1) / kBaseTiles;
+        p.tile_c = (w + kBaseTiles - 1) / kBaseTiles;
+
+        Level L0;
+        L0.rows = (h + p.tile_r - 1) / p.tile_r;
+        L0.cols = (w + p.tile_c - 1) / p.tile_c;
+        L0.t.resize(L0.rows * L0.cols);
+        LinAlg::ParallelFor(L0.rows, [&](std::size_t ti) {
+            if (cancel->load(std::memory_order_relaxed)) return;
+            const std::size_t i0 = reg.r0 + ti * p.tile_r, i1 = std::min(reg.r1, i0 + p.tile_r);
+            Tile* row = &L0.t[ti * L0.cols];
+            for (std::size_t i = i0; i < i1; ++i) {
+                const double* a = &M->a[i * M->cols];
+                for (std::size_t tj = 0; tj < L0.cols; ++tj) {
+                    const std::size_t j0 = reg.c0 + tj * p.tile_c, j1 = std::min(reg.c1, j0 + p.tile_c);
+                    Tile& t = row[tj];
+                    for (std::size_t j = j0; j < j1; ++j) {
+                        const float v = float(std::fabs(a[j]));
+                        if (!t.count) { t.mn = t.mx = v; }
+                        else { t.mn = std::min(t.mn, v); t.mx = std::max(t.mx, v); }
+                        if (v > 0.0f) { t.mnz = t.nnz ? std::min(t.mnz, v) : v; ++t.nnz; }
+                        ++t.count;
+                    }
+                }
+            }
+        });
+        if (cancel->load()) return p;
+
+        p.levels.push_back(std::move(L0));
+        while (p.levels.back().rows > 1 || p.levels.back().cols > 1) {
+            const Level& prev = p.levels.back();
+            Level L;
+            L.rows = (prev.rows + 1) / 2;
+            L.cols = (prev.cols + 1) / 2;
+            L.t.resize(L.rows * L.cols);
+            for (std::size_t i = 0; i < L.rows; ++i) {
+                for (std::size_t j = 0; j < L.cols; ++j) {
+                    Tile t = prev.At(2 * i, 2 * j);
+                    if (2 * j + 1 < prev.cols) t = Merge(t, prev.At(2 * i, 2 * j + 1));
+                    if (2 * i + 1 < prev.rows) {
+                        t = Merge(t, prev.At(2 * i + 1, 2 * j));
+                        if (2 * j + 1 < prev.cols) t = Merge(t, prev.At(2 * i + 1, 2 * j + 1));
+                    }
+                    L.t[i * L.cols + j] = t;
+                }
+            }
+            p.levels.push_back(std::move(L));
+        }
+
+        // L'arrel dona el rang global; limitem a 16 dcades perqu un 1e-300 no ho aplani tot.
+        const Tile& root = p.levels.back().t[0];
+        p.hi = root.mx > 0.0f ? std::log10(root.mx) : 0.0f;
+        p.lo = root.nnz ? std::max(std::log10(root.mnz), p.hi - 16.0f) : p.hi;
+        p.ok = true;
+        return p;
+    }
+
+    enum HeatMode { kMax, kMin, kDensity };
+
+    // Aproximaci de viridis; RGBA en l'ordre de bytes que espera GL_RGBA / GL_UNSIGNED_BYTE.
+    std::uint32_t Ramp(float t)
+    {
+        static const float k[5][3] = { {68, 1, 84}, {59, 82, 139}, {33, 145, 140}, {94, 201, 98}, {253, 231, 37} };
+        t = std::min(1.0f, std::max(0.0f, t)) * 4.0f;
+        const int i = std::min(3, int(t));
+        const float f = t - float(i);
+        std::uint32_t c = 0xFF000000u;
+        for (int ch = 0; ch < 3; ++ch) c |= std::uint32_t(k[i][ch] + f * (k[i + 1][ch] - k[i][ch])) << (8 * ch);
+        return c;
+    }
+
+    std::uint32_t TileColor(const Tile& t, int mode, float lo, float hi)
+    {
+        const std::uint32_t empty = 0xFF181818u;
+        if (mode == kDensity) return t.nnz ? Ramp(float(t.nnz) / float(t.count)) : empty;
+        const float v = mode == kMax ? t.mx : t.mn;
+        if (v <= 0.0f) return empty;
+        return Ramp(hi > lo ? (std::log10(v) - lo) / (hi - lo) : 1.0f);
+    }
+
+    struct View
+    {
+        const double* data = nullptr;
+        std::size_t rows = 0, cols = 0;
+        std::uint64_t generation = 0;
+
+        Region want;                    // regi que es vol veure (la roda l'apropa/allunya)
+        std::atomic<bool> cancel{ false };
+        std::future<Pyramid> job;
+        Pyramid pyr;
+
+        GLuint tex = 0;
+        int tex_level = -1, tex_mode = -1;
+        int mode = kMax;
+
+        // Finestra de la taula visible ara mateix (es marca sobre el mapa) i salt pendent.
+        std::size_t vis_r0 = 0, vis_r1 = 0, vis_c0 = 0, vis_c1 = 0;
+        long long goto_r = -1, goto_c = -1;
+
+        void Stop()
+        {
+            if (!job.valid()) return;
+            cancel = true;
+            job.wait();
+            job = std::future<Pyramid>();
+        }
+    };
+
+    std::map<std::string, std::unique_ptr<View>> g_views;
+    std::uint64_t g_generation = 1;
+
+    View& GetView(const char* label, const Matrix& M)
+    {
+        std::unique_ptr<View>& slot = g_views[label];
+        if (!slot) slot.reset(new View());
+        View& v = *slot;
+        if (v.data != M.a.data() || v.rows != M.rows || v.cols != M.cols || v.generation != g_generation) {
+            v.Stop();
+            v.data = M.a.data(); v.rows = M.rows; v.cols = M.cols;
+            v.generation = g_generation;
+            v.want = Region{ 0, M.rows, 0, M.cols };
+            v.pyr = Pyramid();
+            v.tex_level = -1;
+        }
+        return v;
+    }
+
+    void UpdateJob(View& v, const Matrix& M)
+    {
+        if (v.job.valid() && v.job.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+            Pyramid p = v.job.get();
+            if (p.ok) { v.pyr = std::move(p); v.tex_level = -1; }
+        }
+        if (!v.job.valid() && (!v.pyr.ok || v.pyr.reg != v.want)) {
+            v.cancel = false;
+            v.job = std::async(std::launch::async, BuildPyramid, &M, v.want, &v.cancel);
+        }
+    }
+
+    // Primer nivell que cap en 'pixels' per costat: mostrar-ne un de ms fi faria que la GPU en
+    // descarts tesselles, i amb el mxim per tessella un element allat no es perd mai.
+    int PickLevel(const Pyramid& p, float pixels)
+    {
+        for (std::size_t l = 0; l < p.levels.size(); ++l)
+            if (float(std::max(p.levels[l].rows, p.levels[l].cols)) <= pixels) return int(l);
+        return int(p.levels.size()) - 1;
+    }
+
+    void UploadLevel(View& v, int level)
+    {
+        const Level& L = v.pyr.levels[(std::size_t)level];
+        std::vector<std::uint32_t> rgba(L.t.size());
+        for (std::size_t k = 0; k < L.t.size(); ++k) rgba[k] = TileColor(L.t[k], v.mode, v.pyr.lo, v.pyr.hi);
+        if (!v.tex) glGenTextures(1, &v.tex);
+        glBindTexture(GL_TEXTURE_2D, v.tex);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, GLsizei(L.cols), GLsizei(L.rows), 0, GL_RGBA, GL_UNSIGNED_BYTE, rgba.data());
+        glBindTexture(GL_TEXTURE_2D, 0);
+        v.tex_level = level;
+        v.tex_mode = v.mode;
+    }
+
+    // Taula virtualitzada en les dues direccions: el contingut t la mida de tota la matriu,
+    // per noms es dibuixen les celles que cauen dins la finestra. Capaleres fixes.
+    void DrawCellGrid(const Matrix& M, View& v, ImVec2 size)
+    {
+        ImGui::BeginChild("##cells", size, ImGuiChildFlags_Borders, ImGuiWindowFlags_HorizontalScrollbar);
+        const float cw = ImGui::CalcTextSize("-0.0000e+00").x + 8.0f;
+        const float ch = ImGui::GetTextLineHeightWithSpacing();
+        const float hw = ImGui::CalcTextSize("00000").x + 8.0f;
+
+        if (v.goto_r >= 0) {
+            ImGui::SetScrollY(float(v.goto_r) * ch);
+            ImGui::SetScrollX(float(v.goto_c) * cw);
+            v.goto_r = v.goto_c = -1;
+        }
+
+        const ImVec2 origin = ImGui::GetCursorScreenPos();     // ja desplaat pel scroll
+        const float sx = ImGui::GetScrollX(), sy = ImGui::GetScrollY();
+        const ImVec2 vis = ImGui::GetContentRegionAvail();
+        const std::size_t c0 = std::min(M.cols, std::size_t(std::max(0.0f, sx / cw)));
+        const std::size_t c1 = std::min(M.cols, c0 + std::size_t(std::max(0.0f, vis.x - hw) / cw) + 2);
+        const std::size_t r0 = std::min(M.rows, std::size_t(std::max(0.0f, sy / ch)));
+        const std::size_t r1 = std::min(M.rows, r0 + std::size_t(std::max(0.0f, vis.y - ch) / ch) + 2);
+        v.vis_r0 = r0; v.vis_r1 = r1; v.vis_c0 = c0; v.vis_c1 = c1;
+
+        ImGui::Dummy(ImVec2(hw + float(M.cols) * cw, ch + float(M.rows) * ch));
+        const bool hovered = ImGui::IsItemHovered();
+
+        ImDrawList* dl = ImGui::GetWindowDrawList();
+        const ImU32 text = IM_COL32(220, 220, 220, 255), head = IM_COL32(150, 170, 200, 255);
+        const ImVec2 top_left(origin.x + sx, origin.y + sy);
+        char buf[32];
+        for (std::size_t i = r0; i < r1; ++i) {
+            const float y = origin.y + ch + float(i) * ch;
+            for (std::size_t j = c0; j < c1; ++j) {
+                std::snprintf(buf, sizeof(buf), "% .4e", M.a[i * M.cols + j]);
+                dl->AddText(ImVec2(origin.x + hw + float(j) * cw, y), text, buf);
+            }
+        }
+        // Capaleres: fila superior i columna esquerra enganxades a la vora visible.
+        dl->AddRectFilled(top_left, ImVec2(top_left.x + vis.x + sx, top_left.y + ch), IM_COL32(35, 40, 50, 255));
+        dl->AddRectFilled(top_left, ImVec2(top_left.x + hw, top_left.y + vis.y + ch), IM_COL32(35, 40, 50, 255));
+        for (std::size_t j = c0; j < c1; ++j) {
+            std::snprintf(buf, sizeof(buf), "%zu", j);
+            dl->AddText(ImVec2(origin.x + hw + float(j) * cw, top_left.y), head, buf);
+        }
+        for (std::size_t i = r0; i < r1; ++i) {
+            std::snprintf(buf, sizeof(buf), "%zu", i);
+            dl->AddText(ImVec2(top_left.x + 2.0f, origin.y + ch + float(i) * ch), head, buf);
+        }
+
+        if (hovered) {
+            const ImVec2 m = ImGui::GetIO().MousePos;
+            const float fx = (m.x - origin.x - hw) / cw, fy = (m.y - origin.y - ch) / ch;
+            if (m.x > top_left.x + hw && m.y > top_left.y + ch && fx >= 0.0f && fy >= 0.0f) {
+                const std::size_t i = std::size_t(fy), j = std::size_t(fx);
+                if (i < M.rows && j < M.cols) ImGui::SetTooltip("[%zu, %zu] = %.17g", i, j, M.a[i * M.cols + j]);
+            }
+        }
+        ImGui::EndChild();
+    }
+
+    void DrawHeatmap(View& v, float side)
+    {
+        const Pyramid& p = v.pyr;
+        if (!p.ok) {
+            ImGui::Dummy(ImVec2(side, side));
+            return;
+        }
+        const int level = PickLevel(p, side);
+        if (v.tex_level != level || v.tex_mode != v.mode) UploadLevel(v, level);
+        const Level& L = p.levels[(std::size_t)level];
+
+        // Mantenim la proporci de la regi.
+        const float h = float(p.reg.r1 - p.reg.r0), w = float(p.reg.c1 - p.reg.c0);
+        const ImVec2 disp = h >= w ? ImVec2(side * w / h, side) : ImVec2(side, side * h / w);
+        ImGui::Image((ImTextureID)(std::intptr_t)v.tex, ImVec2(std::max(disp.x, 2.0f), std::max(disp.y, 2.0f)));
+        const ImVec2 q0 = ImGui::GetItemRectMin(), q1 = ImGui::GetItemRectMax();
+
+        // Elements per tessella en aquest nivell, i conversi element -> pantalla.
+        const double er = double(p.tile_r) * double(std::size_t(1) << level), ec = double(p.tile_c) * double(std::size_t(1) << level);
+        auto to_screen = [&](double i, double j) {
+            return ImVec2(q0.x + float((j - double(p.reg.c0)) / w) * (q1.x - q0.x), q0.y + float((i - double(p.reg.r0)) / h) * (q1.y - q0.y));
+        };
+
+        // Finestra visible de la taula.
+        ImDrawList* dl = ImGui::GetWindowDrawList();
+        dl->PushClipRect(q0, q1, true);
+        dl->AddRect(to_screen(double(v.vis_r0), double(v.vis_c0)), to_screen(double(v.vis_r1), double(v.vis_c1)), IM_COL32(255, 80, 80, 255), 0.0f, 0, 1.5f);
+        dl->PopClipRect();
+
+        if (!ImGui::IsItemHovered()) return;
+        ImGui::SetItemKeyOwner(ImGuiKey_MouseWheelY);
+        const ImVec2 m = ImGui::GetIO().MousePos;
+        const std::size_t ti = std::min(L.rows - 1, std::size_t(std::max(0.0f, (m.y - q0.y) / (q1.y - q0.y)) * float(L.rows)));
+        const std::size_t tj = std::min(L.cols - 1, std::size_t(std::max(0.0f, (m.x - q0.x) / (q1.x - q0.x)) * float(L.cols)));
+        const Tile& t = L.At(ti, tj);
+        const std::size_t i0 = p.reg.r0 + std::size_t(double(ti) * er), j0 = p.reg.c0 + std::size_t(double(tj) * ec);
+        const std::size_t i1 = std::min(p.reg.r1, i0 + std::size_t(er)), j1 = std::min(p.reg.c1, j0 + std::size_t(ec));
+        ImGui::SetTooltip("files %zu-%zu, cols %zu-%zu\nmax |a| = %.4g\nmin |a| = %.4g\nno nuls = %.1f%%\n(clic: ves-hi a la taula, roda: zoom, clic dret: tot)",
+            i0, i1 - 1, j0, j1 - 1, double(t.mx), double(t.mn), 100.0 * double(t.nnz) / double(std::max<std::uint32_t>(1, t.count)));
+
+        if (ImGui::IsMouseClicked(0)) { v.goto_r = (long long)i0; v.goto_c = (long long)j0; }
+        if (ImGui::IsMouseClicked(1)) v.want = Region{ 0, v.rows, 0, v.cols };
+
+        // Roda: meitat o doble de regi centrada al cursor, sense sortir de la matriu.
+        const float wheel = ImGui::GetIO().MouseWheel;
+        if (wheel != 0.0f) {
+            const double ci = p.reg.r0 + double((m.y - q0.y) / (q1.y - q0.y)) * h;
+            const double cj = p.reg.c0 + double((m.x - q0.x) / (q1.x - q0.x)) * w;
+            const double f = wheel > 0.0f ? 0.5 : 2.0;
+            auto span = [](double c, double extent, std::size_t n) {
+                const double e = std::min(double(n), std::max(8.0, extent));
+                double a = std::max(0.0, std::min(double(n) - e, c - e / 2.0));
+                return std::make_pair(std::size_t(a), std::min(n, std::size_t(a + e + 0.5)));
+            };
+            const auto rs = span(ci, h * f, v.rows), cs = span(cj, w * f, v.cols);
+            v.want = Region{ rs.first, rs.second, cs.first, cs.second };
+        }
+    }
+}
+
+void DrawMatrixView(const char* label, const Matrix& M)
+{
+    ImGui::SeparatorText(label);
+    if (M.rows == 0 || M.cols == 0) { ImGui::TextDisabled("(buida)"); return; }
+
+    ImGui::PushID(label);
+    View& v = GetView(label, M);
+    UpdateJob(v, M);
+
+    const float side = std::min(256.0f, std::max(96.0f, ImGui::GetContentRegionAvail().x * 0.4f));
+    const float grid_w = std::max(120.0f, ImGui::GetContentRegionAvail().x - side - ImGui::GetStyle().ItemSpacing.x);
+    DrawCellGrid(M, v, ImVec2(grid_w, side));
+    ImGui::SameLine();
+    DrawHeatmap(v, side);
+
+    ImGui::RadioButton("max |a|", &v.mode, kMax); ImGui::SameLine();
+    ImGui::RadioButton("min |a|", &v.mode, kMin); ImGui::SameLine();
+    ImGui::RadioButton("densitat", &v.mode, kDensity); ImGui::SameLine();
+    ImGui::TextDisabled("%zux%zu", M.rows, M.cols);
+    if (v.pyr.ok) {
+        const Region& r = v.pyr.reg;
+        ImGui::SameLine();
+        ImGui::TextDisabled("| regio %zu-%zu x %zu-%zu, |a| 1e%.1f..1e%.1f", r.r0, r.r1 - 1, r.c0, r.c1 - 1, double(v.pyr.lo), double(v.pyr.hi));
+    }
+    if (v.job.valid()) { ImGui::SameLine(); ImGui::TextDisabled("(calculant mapa...)"); }
+    ImGui::PopID();
+}
+
+void DrawVecView(const char* label, const Vec& x)
+{
+    ImGui::SeparatorText(label);
+    if (x.empty()) { ImGui::TextDisabled("(buit)"); return; }
+
+    ImGui::PushID(label);
+    const float ch = ImGui::GetTextLineHeightWithSpacing();
+    ImGui::BeginChild("##vec", ImVec2(-1.0f, std::min(200.0f, ch * float(x.size()) + 8.0f)), ImGuiChildFlags_Borders);
+    ImGuiListClipper clipper;
+    clipper.Begin(int(x.size()), ch);
+    while (clipper.Step()) {
+        for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i) {
+            ImGui::TextDisabled("%6d", i); ImGui::SameLine();
+            ImGui::Text("% .10e", x[(std::size_t)i]);
+        }
+    }
+    clipper.End();
+    ImGui::EndChild();
+    ImGui::TextDisabled("%zu elements", x.size());
+    ImGui::PopID();
+}
+
+void ReleaseMatrixViews()
+{
+    for (auto& kv : g_views) kv.second->Stop();
+    ++g_generation;
+}
+
+void ShutdownMatrixViews()
+{
+    ReleaseMatrixViews();
+    for (auto& kv : g_views) if (kv.second->tex) glDeleteTextures(1, &kv.second->tex);
+    g_views.clear();
+}
@@ -0,0 +1,15 @@
+#pragma once
+#include "Matrix.hpp"
+
+// Visors per a matrius i vectors grans. La taula s virtualitzada (noms es dibuixen les celles
+// visibles) i el mapa de calor de |a_ij| es calcula en segon pla amb una pirmide min/max per
+// tesselles, de manera que una 10k x 10k no atura el bucle de frames.
+void DrawMatrixView(const char* label, const Matrix& M);
+void DrawVecView(const char* label, const Vec& v);
+
+// Atura i espera els mapes de calor en curs i els marca per recalcular. Cal cridar-la abans de
+// modificar o reassignar una matriu que s'estigui mostrant: el fil la llegeix directament.
+void ReleaseMatrixViews();
+
+// ReleaseMatrixViews i, a ms, allibera les textures. Abans de destruir el context GL.
+void ShutdownMatrixViews();
\ No newline at end of file
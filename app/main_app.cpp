@@ -4,6 +4,9 @@
 #include <string>
 #include <random>
 #include <cmath>
+#include <cfloat>
+#include <chrono>
+#include <future>
 
 // Dear ImGui
 #include "imgui.h"
@@ -17,6 +20,10 @@
 #include "DatasetIO.hpp"
 #include "OpsCounter.hpp"
 #include "Timer.hpp"
+#include "Progress.hpp"
+#include "Dashboard.hpp"
+#include "MatrixView.hpp"
+#include "QR.hpp"
 
 static void Check(bool ok, const char* msg) {
     if (!ok) { std::fprintf(stderr, "%s: %s", msg, SDL_GetError()); std::fflush(stderr); std::exit(1); }
@@ -27,6 +34,7 @@ static void Check(bool ok, const char* msg) {
 static bool show_datasets = true;
 static bool show_ops = true;
 static bool show_results = true;
+static bool show_dashboard = true;
 
 // Dimensions (permet no-quadrat per a MatVec/MatMul)
 static int m_rows = 700; // files d'A
@@ -40,7 +48,7 @@ static int n_solve = 700;
 
 // Parmetres
 static double tol = 1e-12;
-static int op_selected = 0; // 0=MatVec, 1=MatMul, 2=Solve(NoPivot), 3=Solve(PartialPivot)
+static int op_selected = 0; // 0=MatVec, 1=MatMul, 2=Solve(NoPivot), 3=Solve(PartialPivot), 4=Minims quadrats (QR)
 
 // Dades
 static Matrix A, B; // entrades (A: m x k), (B: k x n)
@@ -51,17 +59,120 @@ static Vec    y;      // per MatVec
 static Matrix C;      // per MatMul
 static Vec    x_sol;  // per Solve
 
-enum class SolveStatus { Ok, Singular, PivotFailure, DimError, None };
+enum class SolveStatus { Ok, Singular, PivotFailure, DimError, Cancelled, None };
 static SolveStatus last_status = SolveStatus::None;
 
 // Comptatge i temps
 static OpsCounter last_ops{};
 static double     last_time_ms = 0.0;
 static double     last_rel_res = std::numeric_limits<double>::quiet_NaN();
+static double     last_cond1 = 0.0;      // kappa_1 estimat (0: no aplica)
+static double     last_growth = 0.0;
+static double     last_log_det = 0.0;    // log|det(A)| (valid si last_det_sign != 0)
+static int        last_det_sign = 0;
+
+// ---------------- Clcul en segon pla ----------------
+// Run llana l'operaci en un fil de treball i el bucle de frames noms en consulta el progrs.
+// Mentre hi ha feina en marxa, A, B, x i b no es poden modificar (el fil les llegeix directament).
+struct JobResult
+{
+    int op = 0;
+    Vec y; Matrix C; Vec x_sol;
+    OpsCounter ops{};
+    double time_ms = 0.0;
+    double rel_res = std::numeric_limits<double>::quiet_NaN();
+    double cond1 = 0.0, growth = 0.0;
+    double log_det = 0.0; int det_sign = 0;
+    SolveStatus status = SolveStatus::None;
+    bool error = false;
+};
+
+static LinAlg::ProgressToken job_progress;
+static std::future<JobResult> job;   // vlid mentre hi ha un clcul pendent de recollir
+static Timer job_clock;
+static bool  job_error = false;      // excepci al fil: s'obre el popup des del panell
+static float cancelled_at = 0.0f;
+
+static bool JobRunning() { return job.valid(); }
+
+static JobResult RunOperation(int op)
+{
+    JobResult r;
+    r.op = op;
+    try
+    {
+        if (op == 0)
+        {
+            // MatVec: A (m x k) * x (k) -> y (m)
+            Timer t; t.Tic();
+            r.y = A.Multiply(x, &r.ops);
+            r.time_ms = t.TocMs();
+            r.status = SolveStatus::Ok;
+        }
+        else if (op == 1)
+        {
+            // MatMul: A (m x k) * B (k x n) -> C (m x n)
+            Timer t; t.Tic();
+            r.C = A.Multiply(B, &r.ops, &job_progress);
+            r.time_ms = t.TocMs();
+            r.status = job_progress.Cancelled() ? SolveStatus::Cancelled : SolveStatus::Ok;
+            if (job_progress.Cancelled()) r.C = Matrix();
+        }
+        else if (op == 4)
+        {
+            // Minims quadrats: A (m x k, m >= k), b (m) -> x (k) amb TSQR
+            LinAlg::LeastSquaresReport rep = LinAlg::SolveLeastSquares(A, b, LinAlg::QRMethod::TSQR, 0, 1e-12, &job_progress);
+            r.x_sol = rep.x; r.time_ms = rep.ms; r.ops = rep.ops; r.rel_res = rep.rel_resid;
+            if (rep.cancelled) r.status = SolveStatus::Cancelled;
+            else r.status = rep.rank_deficient ? SolveStatus::Singular : SolveStatus::Ok;
+        }
+        else
+        {
+            LinAlg::SolveReport rep = (op == 2) ? LinAlg::SolveNoPivot(A, b, tol, &job_progress)
+                                                : LinAlg::SolvePartialPivot(A, b, tol, &job_progress);
+            r.x_sol = rep.x; r.time_ms = rep.ms; r.ops = rep.ops; r.rel_res = rep.rel_resid;
+            r.cond1 = rep.cond1; r.growth = rep.pivot_growth;
+            r.log_det = rep.log_abs_det; r.det_sign = rep.det_sign;
+            if (rep.cancelled) r.status = SolveStatus::Cancelled;
+            else if (rep.pivot_zero) r.status = SolveStatus::PivotFailure;
+            else if (rep.singular) r.status = SolveStatus::Singular;
+            else r.status = SolveStatus::Ok;
+        }
+    }
+    catch (const std::exception&)
+    {
+        r.error = true;
+    }
+    return r;
+}
+
+static void LaunchJob(int op)
+{
+    job_progress.Reset();
+    job_clock.Tic();
+    job = std::async(std::launch::async, RunOperation, op);
+}
 
-// Helpers UI: renderitzar taules breus (n <= 8 o preview 8x8)
+// Es crida un cop per frame: si el fil ha acabat, bolquem el resultat a l'estat de la UI.
+static void PollJob()
+{
+    if (!job.valid() || job.wait_for(std::chrono::seconds(0)) != std::future_status::ready) return;
+    JobResult r = job.get();
+    if (r.error) { job_error = true; return; }
+
+    last_status = r.status;
+    if (r.status == SolveStatus::Cancelled) { cancelled_at = float(job_progress.Fraction()); return; }
+    ReleaseMatrixViews();   // els mapes de calor poden estar llegint el C anterior
+    y = std::move(r.y); C = std::move(r.C); x_sol = std::move(r.x_sol);
+    last_ops = r.ops; last_time_ms = r.time_ms; last_rel_res = r.rel_res;
+    last_cond1 = r.cond1; last_growth = r.growth;
+    last_log_det = r.log_det; last_det_sign = r.det_sign;
+}
+
+// Helpers UI: taules editables per a n <= 8; la resta va al visor virtualitzat (MatrixView)
 static void DrawVecPreview(const char* label, Vec& v, bool editable)
 {
+    if (!editable && v.size() > 8) { DrawVecView(label, v); return; }
     ImGui::SeparatorText(label);
     int m = (int)std::min<std::size_t>(8, v.size());
     if (m == 0) { ImGui::TextDisabled("(buit)"); return; }
@@ -73,6 +184,7 @@ static void DrawVecPreview(const char* label, Vec& v, bool editable)
                 double tmp = v[(size_t)j];
                 ImGui::SetNextItemWidth(80);
                 if (ImGui::InputDouble((std::string(label) + "[" + std::to_string(j) + "]").c_str(), &tmp, 0, 0, "%.4f")) {
+                    ReleaseMatrixViews();
                     v[(size_t)j] = tmp;
                 }
             }
@@ -87,6 +199,7 @@ static void DrawVecPreview(const char* label, Vec& v, bool editable)
 
 static void DrawMatPreview(const char* label, Matrix& M, bool editable)
 {
+    if (!editable && (M.rows > 8 || M.cols > 8)) { DrawMatrixView(label, M); return; }
     ImGui::SeparatorText(label);
     if (M.rows == 0 || M.cols == 0) { ImGui::TextDisabled("(buida)"); return; }
     int r = (int)std::min<std::size_t>(8, M.rows);
@@ -100,6 +213,7 @@ static void DrawMatPreview(const char* label, Matrix& M, bool editable)
                     double tmp = M.At((size_t)i, (size_t)j);
                     ImGui::SetNextItemWidth(80);
                     if (ImGui::InputDouble((std::string(label) + "[" + std::to_string(i) + "," + std::to_string(j) + "]").c_str(), &tmp, 0, 0, "%.4f")) {
+                        ReleaseMatrixViews();
                         M.At((size_t)i, (size_t)j) = tmp;
                     }
                 }
@@ -173,6 +287,9 @@ int main()
                 e.window.windowID == SDL_GetWindowID(window)) running = false;
         }
 
+        // Recollim el resultat del fil de treball si ja ha acabat.
+        PollJob();
+
         // --- NEW FRAME ---
         ImGui_ImplOpenGL3_NewFrame();
         ImGui_ImplSDL3_NewFrame();
@@ -205,12 +322,21 @@ int main()
                         ImGui::InputInt("|x| (mida del vector)", &x_len); if (x_len < 1) x_len = 1;
                     }
                 }
+                else if (op_selected == 4) { // Minims quadrats: A alta (m >= k), b de mida m
+                    ImGui::InputInt("m (files A)", &m_rows); if (m_rows < 1) m_rows = 1;
+                    ImGui::InputInt("kA (cols A)", &a_cols); if (a_cols < 1) a_cols = 1;
+                    if (m_rows < a_cols) m_rows = a_cols;
+                }
                 else { // Solve
                     ImGui::InputInt("n (mida quadrada)", &n_solve); if (n_solve < 1) n_solve = 1;
                 }
 
-                if (ImGui::Button("Genera aleatori"))
+                ImGui::BeginDisabled(JobRunning());
+                bool generate = ImGui::Button("Genera aleatori");
+                ImGui::EndDisabled();
+                if (generate)
                 {
+                    ReleaseMatrixViews();
                     // RNG amb llavor variable per evitar repetir
                     std::random_device rd; std::mt19937 rng(rd());
                     std::uniform_real_distribution<double> U(-1.0, 1.0);
@@ -231,6 +357,18 @@ int main()
                         for (int j = 0; j < x_len; ++j) x[(size_t)j] = U(rng);
                         // b no s'usa en MatVec/MatMul
                     }
+                    else if (op_selected == 4) {
+                        // b = A*x + soroll: sistema sobredeterminat sense solucio exacta
+                        int m = m_rows, k = a_cols;
+                        A = Matrix(m, k, 0.0); b = Vec((size_t)m);
+                        Vec xt((size_t)k);
+                        for (int j = 0; j < k; ++j) xt[(size_t)j] = U(rng);
+                        for (int i = 0; i < m; ++i) {
+                            double acc = 0.0;
+                            for (int j = 0; j < k; ++j) { A.At((size_t)i, (size_t)j) = U(rng); acc += A.At((size_t)i, (size_t)j) * xt[(size_t)j]; }
+                            b[(size_t)i] = acc + 0.05 * U(rng);
+                        }
+                    }
                     else {
                         int n = n_solve;
                         A = Matrix(n, n, 0.0); b = Vec((size_t)n);
@@ -242,18 +380,22 @@ int main()
                     }
                     // neteja resultats
                     y.clear(); C = Matrix(); x_sol.clear();
-                    last_ops = OpsCounter{}; last_time_ms = 0.0; last_rel_res = std::numeric_limits<double>::quiet_NaN(); last_status = SolveStatus::None;
+                    last_ops = OpsCounter{}; last_time_ms = 0.0; last_rel_res = std::numeric_limits<double>::quiet_NaN(); last_cond1 = last_growth = 0.0; last_det_sign = 0; last_status = SolveStatus::None;
                 }
 
                 ImGui::Separator();
                 ImGui::Text("Tolerancia numerica (pivot ~ 0)");
+                ImGui::BeginDisabled(JobRunning());    // el fil de treball llegeix tol
                 ImGui::InputDouble("tol", &tol, 0, 0, "%.1e");
+                ImGui::EndDisabled();
 
+                // Amb un clcul en marxa les dades sn de noms lectura.
                 bool small = false;
                 if (op_selected <= 1)
                     small = (A.rows <= 8 && A.cols <= 8) && (op_selected == 0 || (B.rows <= 8 && B.cols <= 8));
                 else
                     small = (A.rows <= 8 && A.cols <= 8) && (b.size() <= 8);
+                small = small && !JobRunning();
 
 
                 DrawMatPreview("A", A, small);
@@ -271,69 +413,54 @@ int main()
         {
             if (ImGui::Begin("Operacio", &show_ops))
             {
-                const char* ops[] = { "MatVec (A*x)", "MatMul (A*B)", "Solve (No Pivot)", "Solve (Partial Pivot)" };
+                const char* ops[] = { "MatVec (A*x)", "MatMul (A*B)", "Solve (No Pivot)", "Solve (Partial Pivot)", "Minims quadrats (QR)" };
+                ImGui::BeginDisabled(JobRunning());
                 ImGui::Combo("Operacio", &op_selected, ops, IM_ARRAYSIZE(ops));
-                if (ImGui::Button("Run"))
+                ImGui::EndDisabled();
+
+                if (JobRunning())
                 {
-                    last_ops = OpsCounter{}; last_time_ms = 0.0; last_rel_res = std::numeric_limits<double>::quiet_NaN(); last_status = SolveStatus::None;
-                    try
-                    {
-                        if (op_selected == 0)
-                        {
-                            // MatVec: A (m x k) * x (k) -> y (m)
-                            if ((int)A.rows != m_rows || (int)A.cols != a_cols || (int)x.size() != a_cols) { last_status = SolveStatus::DimError; }
-                            else {
-                                Timer t; t.Tic();
-                                y = A.Multiply(x, &last_ops);
-                                last_time_ms = t.TocMs();
-                                C = Matrix(); x_sol.clear();
-                            }
-                        }
-                        else if (op_selected == 1)
-                        {
-                            // MatMul: A (m x k) * B (k x n) -> C (m x n)
-                            if ((int)A.rows != m_rows || (int)A.cols != a_cols || (int)B.rows != a_cols || (int)B.cols != n_cols) { last_status = SolveStatus::DimError; }
-                            else {
-                                Timer t; t.Tic();
-                                C = A.Multiply(B, &last_ops);
-                                last_time_ms = t.TocMs();
-                                y.clear(); x_sol.clear();
-                            }
-                        }
-                        else if (op_selected == 2)
-                        {
-                            // Solve (No Pivot)
-                            if ((int)A.rows != n_solve || (int)A.cols != n_solve || (int)b.size() != n_solve) { last_status = SolveStatus::DimError; }
-                            else {
-                                LinAlg::SolveReport r = LinAlg::SolveNoPivot(A, b, tol);
-                                x_sol = r.x; last_time_ms = r.ms; last_ops = r.ops; last_rel_res = r.rel_resid;
-                                last_status = r.pivot_zero ? SolveStatus::PivotFailure : SolveStatus::Ok;
-                                y.clear(); C = Matrix();
-                            }
-                        }
-                        else if (op_selected == 3)
-                        {
-                            // Solve (Partial Pivot)
-                            if ((int)A.rows != n_solve || (int)A.cols != n_solve || (int)b.size() != n_solve) { last_status = SolveStatus::DimError; }
-                            else {
-                                LinAlg::SolveReport r = LinAlg::SolvePartialPivot(A, b, tol);
-                                x_sol = r.x; last_time_ms = r.ms; last_ops = r.ops; last_rel_res = r.rel_resid;
-                                last_status = r.singular ? SolveStatus::Singular : SolveStatus::Ok;
-                                y.clear(); C = Matrix();
-                            }
-                        }
+                    // El fil de treball publica la fracci feta; la UI continua a vsync.
+                    char overlay[64];
+                    std::snprintf(overlay, sizeof(overlay), "%.0f%% (%.1f s)", job_progress.Fraction() * 100.0, job_clock.TocMs() / 1000.0);
+                    ImGui::ProgressBar(float(job_progress.Fraction()), ImVec2(-1.0f, 0.0f), overlay);
+                    ImGui::BeginDisabled(job_progress.Cancelled());
+                    if (ImGui::Button("Atura")) job_progress.Cancel();
+                    ImGui::EndDisabled();
+                }
+                else if (ImGui::Button("Run"))
+                {
+                    last_ops = OpsCounter{}; last_time_ms = 0.0; last_rel_res = std::numeric_limits<double>::quiet_NaN(); last_cond1 = last_growth = 0.0; last_det_sign = 0; last_status = SolveStatus::None;
+
+                    // Les dimensions es validen aqu; el fil noms rep operacions coherents.
+                    bool dims_ok = true;
+                    if (op_selected == 0) dims_ok = (int)A.rows == m_rows && (int)A.cols == a_cols && (int)x.size() == a_cols;
+                    else if (op_selected == 1) dims_ok = (int)A.rows == m_rows && (int)A.cols == a_cols && (int)B.rows == a_cols && (int)B.cols == n_cols;
+                    else if (op_selected == 4) dims_ok = (int)A.rows == m_rows && (int)A.cols == a_cols && (int)b.size() == m_rows && m_rows >= a_cols;
+                    else dims_ok = (int)A.rows == n_solve && (int)A.cols == n_solve && (int)b.size() == n_solve;
+
+                    if (!dims_ok) {
+                        last_status = SolveStatus::DimError;
                     }
-                    catch (const std::exception&)
-                    {
-                        ImGui::OpenPopup("error_popup");
+                    else {
+                        ReleaseMatrixViews();
+                        y.clear(); C = Matrix(); x_sol.clear();
+                        LaunchJob(op_selected);
                     }
                 }
 
+                if (job_error)
+                {
+                    job_error = false;
+                    ImGui::OpenPopup("error_popup");
+                }
+
                 if (ImGui::BeginPopupModal("error_popup", NULL, ImGuiWindowFlags_AlwaysAutoResize))
                 {
                     ImGui::TextWrapped("%s", "S'ha produt una excepcio durant l'execucio (revisa dimensions i dades).");
                     ImGui::Separator();
                     if (op_selected <= 1) ImGui::TextDisabled("Esperat: A %dx%d, B %dx%d (si MatMul), x %d", m_rows, a_cols, a_cols, n_cols, x_len);
+                    else if (op_selected == 4) ImGui::TextDisabled("Esperat: A %dx%d (m >= k), b %d", m_rows, a_cols, m_rows);
                     else ImGui::TextDisabled("Esperat: A %dx%d, b %d", n_solve, n_solve, n_solve);
                     if (ImGui::Button("Tanca")) ImGui::CloseCurrentPopup();
                     ImGui::EndPopup();
@@ -349,6 +476,9 @@ int main()
                 case SolveStatus::Singular:
                     ImGui::SameLine(); ImGui::TextColored(ImVec4(1, 0.7f, 0.2f, 1), "Matriu singular (diag <= tol)");
                     break;
+                case SolveStatus::Cancelled:
+                    ImGui::SameLine(); ImGui::TextColored(ImVec4(0.7f, 0.7f, 0.7f, 1), "Aturat al %.0f%%", cancelled_at * 100.0f);
+                    break;
                 default: break;
                 }
             }
@@ -363,6 +493,15 @@ int main()
                 ImGui::Text("Temps (ms): %.3f", last_time_ms);
                 if (std::isnan(last_rel_res)) ImGui::Text("Residu relatiu: N/A");
                 else ImGui::Text("Residu relatiu: %.3e", last_rel_res);
+                if (last_cond1 > 0.0) {
+                    // Error relatiu esperat ~ kappa * eps: per sobre de 1e-8 el resultat perd la meitat dels digits.
+                    const ImVec4 col = last_cond1 * DBL_EPSILON > 1e-8 ? ImVec4(1, 0.6f, 0.2f, 1) : ImVec4(0.7f, 0.9f, 0.7f, 1);
+                    ImGui::TextColored(col, "kappa_1 (estimat): %.3e", last_cond1);
+                    ImGui::Text("Creixement dels pivots: %.3g", last_growth);
+                    // El determinant desborda facilment: el mostrem com a signe * 10^exponent.
+                    if (last_det_sign != 0) ImGui::Text("det(A) = %s10^%.4f", last_det_sign < 0 ? "-" : "", last_log_det / std::log(10.0));
+                    else ImGui::Text("det(A) = 0");
+                }
                 ImGui::Separator();
                 ImGui::Text("Comptador d'operacions:");
                 ImGui::BulletText("mul = %llu", (unsigned long long)last_ops.mul);
@@ -381,6 +520,9 @@ int main()
             ImGui::End();
         }
 
+        // --- PANELL: RENDIMENT ---
+        if (show_dashboard) DrawDashboard(&show_dashboard);
+
         // --- RENDER ---
         ImGui::Render();
         int dw, dh;
@@ -392,6 +534,11 @@ int main()
         SDL_GL_SwapWindow(window);
     }
 
+    // Si encara hi ha un clcul en marxa, el cancellem i l'esperem abans de destruir res.
+    if (JobRunning()) { job_progress.Cancel(); job.wait(); }
+    ShutdownDashboard();
+    ShutdownMatrixViews();
+
     // Shutdown
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplSDL3_Shutdown();
@@ -0,0 +1,57 @@
+#include "BenchHarness.hpp"
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+static constexpr const char* G = "\x1b[32m", * R = "\x1b[31m", * Y = "\x1b[33m", * Z = "\x1b[0m";
+
+// Compara dues sortides JSON de `bench --perf` kernel a kernel.
+// Una regressió és un canvi de mediana per sobre del llindar que, a més, no s'explica pel soroll:
+// el millor temps nou ha de ser pitjor que el p95 de la referència.
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::cerr << "Us: bench_compare <base.json> <nou.json> [--threshold 0.05]\n";
+        return 2;
+    }
+    double threshold = 0.05;
+    for (int i = 3; i + 1 < argc; ++i) {
+        if (std::string(argv[i]) == "--threshold") threshold = std::atof(argv[++i]);
+    }
+
+    Bench::RunInfo base_info, new_info;
+    std::vector<Bench::BenchStats> base, cur;
+    if (!Bench::ReadJson(argv[1], base_info, base)) { std::cerr << "No s'ha pogut llegir " << argv[1] << "\n"; return 2; }
+    if (!Bench::ReadJson(argv[2], new_info, cur)) { std::cerr << "No s'ha pogut llegir " << argv[2] << "\n"; return 2; }
+
+    if (base_info.host != new_info.host) {
+        std::cout << Y << "Avis: hosts diferents (" << base_info.host << " vs " << new_info.host << ")" << Z << "\n";
+    }
+
+    std::map<std::pair<std::string, std::size_t>, Bench::BenchStats> ref;
+    for (const auto& s : base) ref[{ s.kernel, s.n }] = s;
+
+    int regressions = 0, improvements = 0, missing = 0;
+    for (const auto& s : cur) {
+        auto it = ref.find({ s.kernel, s.n });
+        if (it == ref.end()) { ++missing; continue; }
+        const Bench::BenchStats& b = it->second;
+        double delta = b.median_ms > 0.0 ? s.median_ms / b.median_ms - 1.0 : 0.0;
+
+        const char* tag = "same";
+        const char* col = Z;
+        if (delta > threshold && s.min_ms > b.p95_ms) { tag = "REGRESSION"; col = R; ++regressions; }
+        else if (delta < -threshold && s.p95_ms < b.min_ms) { tag = "faster"; col = G; ++improvements; }
+        else if (delta > threshold || delta < -threshold) { tag = "noisy"; col = Y; }
+
+        std::cout << "[" << s.kernel << "][n=" << s.n << "] " << col << tag << Z
+            << " base=" << b.median_ms << "ms new=" << s.median_ms << "ms delta=" << delta * 100.0 << "%"
+            << " GFLOP/s " << b.gflops << " -> " << s.gflops << "\n";
+    }
+
+    std::cout << "regressions=" << regressions << " improvements=" << improvements
+        << " unmatched=" << missing << " threshold=" << threshold * 100.0 << "%\n";
+    return regressions ? 1 : 0;
+}
@@ -1,89 +1,301 @@
-#include "Matrix.hpp"
 #include "DatasetIO.hpp"
-#include <random>
+#include "Matrix.hpp"
+#include "Parallel.hpp"
+#include "Philox.hpp"
+#include <algorithm>
+#include <chrono>
 #include <cmath>
-#include <string>
-#include <cassert>
-#include <iostream>
+#include <cstdint>
+#include <cstdlib>
 #include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
 
 using std::size_t;
 
-static Matrix rand_mat(int r, int c, std::mt19937& rng) {
-    std::uniform_real_distribution<double> U(-1.0, 1.0);
-    Matrix M(r, c, 0.0);
-    for (int i = 0; i < r; ++i) for (int j = 0; j < c; ++j) M.At(i, j) = U(rng);
-    return M;
+// Fluxos Philox independents: cada fitxer t el seu, i dins del flux l'element (i, j) s fix.
+enum Stream : std::uint32_t { kA = 1, kB, kX, kXBad, kBBad, kSpd, kBand };
+
+struct Options {
+    std::vector<int> sizes = { 500, 600, 700, 800 };
+    std::vector<std::string> kinds = { "well", "singular", "zeropiv" };
+    std::string out = "datasets";
+    std::uint64_t seed = 1234;
+    size_t threads = 0;         // 0 => tots
+    size_t block_rows = 256;    // files per bloc: fita la memria a ~3 * block_rows * n doubles
+    int band = 8;               // semiamplada de banda per a "banded"
+    bool matmul = true;         // l'oracle C = A*B s O(n^3): es pot desactivar per a n molt grans
+    bool compress = false;      // contenidor .lbz (DatasetIO) en lloc de .bin
+    int mantissa_bits = 52;     // amb --compress: 52 = sense prdua
+};
+
+static std::vector<std::string> split_list(const std::string& s) {
+    std::vector<std::string> out; std::stringstream ss(s); std::string tok;
+    while (std::getline(ss, tok, ',')) if (!tok.empty()) out.push_back(tok);
+    return out;
+}
+
+static void usage() {
+    std::cerr << "Us: generate_dataset [--sizes 500,600,700,800] [--kinds well,singular,zeropiv,spd,banded]\n"
+                 "                     [--out datasets] [--seed 1234] [--threads 0] [--block-rows 256]\n"
+                 "                     [--band 8] [--no-matmul] [--compress [--mantissa-bits 52]]\n";
+}
+
+static bool parse_args(int argc, char** argv, Options& o) {
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        auto next = [&](std::string& v) { if (i + 1 >= argc) return false; v = argv[++i]; return true; };
+        std::string v;
+        if (a == "--sizes" && next(v)) { o.sizes.clear(); for (auto& t : split_list(v)) o.sizes.push_back(std::atoi(t.c_str())); }
+        else if (a == "--kinds" && next(v)) o.kinds = split_list(v);
+        else if (a == "--out" && next(v)) o.out = v;
+        else if (a == "--seed" && next(v)) o.seed = std::strtoull(v.c_str(), nullptr, 10);
+        else if (a == "--threads" && next(v)) o.threads = size_t(std::atoll(v.c_str()));
+        else if (a == "--block-rows" && next(v)) o.block_rows = std::max<size_t>(2, size_t(std::atoll(v.c_str())));
+        else if (a == "--band" && next(v)) o.band = std::max(0, std::atoi(v.c_str()));
+        else if (a == "--no-matmul") o.matmul = false;
+        else if (a == "--compress") o.compress = true;
+        else if (a == "--mantissa-bits" && next(v)) o.mantissa_bits = std::min(52, std::max(1, std::atoi(v.c_str())));
+        else { std::cerr << "Argument desconegut: " << a << "\n"; usage(); return false; }
+    }
+    for (const auto& k : o.kinds) {
+        if (k != "well" && k != "singular" && k != "zeropiv" && k != "spd" && k != "banded") {
+            std::cerr << "Tipus desconegut: " << k << "\n"; usage(); return false;
+        }
+    }
+    for (int n : o.sizes) if (n < 2) { std::cerr << "Mida invalida: " << n << "\n"; return false; }
+    return true;
+}
+
+// Escriptura seqencial d'un fitxer .bin (doubles row-major, sense capalera) bloc a bloc, o
+// d'un .lbz comprimit si hi ha opcions de compressi ('cols' noms es fa servir en aquest cas).
+class BinSink {
+public:
+    bool Open(const std::string& path, size_t cols = 1, const CompressOptions* copt = nullptr) {
+        path_ = path;
+        compressed_ = copt != nullptr;
+        if (compressed_) return lbz_.Open(path, cols, *copt);
+        f_.open(path, std::ios::binary | std::ios::trunc | std::ios::out);
+        return bool(f_);
+    }
+    void Write(const double* p, size_t count) {
+        if (compressed_) { lbz_.Write(p, count); return; }
+        f_.write(reinterpret_cast<const char*>(p), std::streamsize(count * sizeof(double)));
+    }
+    bool Close() {
+        bool ok;
+        if (compressed_) ok = lbz_.Close();
+        else { f_.close(); ok = bool(f_); }
+        if (!ok) std::cerr << "Error escrivint " << path_ << "\n";
+        return ok;
+    }
+private:
+    std::ofstream f_;
+    CompressedWriter lbz_;
+    bool compressed_ = false;
+    std::string path_;
+};
+
+// Fila i de la matriu ben condicionada: valors a [-1, 1) i diagonal = suma |fora diagonal| + 1.
+static void well_row(std::uint64_t seed, size_t n, size_t i, double* row) {
+    LinAlg::PhiloxFillRow(seed, kA, i, 0, n, row);
+    row[i] = 0.0;
+    double rowsum = 0.0;
+    for (size_t j = 0; j < n; ++j) rowsum += std::fabs(row[j]);
+    row[i] = rowsum + 1.0;
+}
+
+// SPD: simtrica (l'element (i, j) surt de la fila min(i, j) del flux) i diagonalment dominant.
+static void spd_row(std::uint64_t seed, size_t n, size_t i, double* row) {
+    for (size_t j = 0; j < i; ++j) row[j] = LinAlg::PhiloxAt(seed, kSpd, j, i);
+    if (i + 1 < n) LinAlg::PhiloxFillRow(seed, kSpd, i, i + 1, n - i - 1, row + i + 1);
+    double rowsum = 0.0;
+    for (size_t j = 0; j < n; ++j) if (j != i) rowsum += std::fabs(row[j]);
+    row[i] = rowsum + 1.0;
+}
+
+static void banded_row(std::uint64_t seed, size_t n, size_t w, size_t i, double* row) {
+    std::fill(row, row + n, 0.0);
+    size_t lo = i > w ? i - w : 0, hi = std::min(n - 1, i + w);
+    LinAlg::PhiloxFillRow(seed, kBand, i, lo, hi - lo + 1, row + lo);
+    row[i] = 0.0;
+    double rowsum = 0.0;
+    for (size_t j = lo; j <= hi; ++j) rowsum += std::fabs(row[j]);
+    row[i] = rowsum + 1.0;
+}
+
+// Mateix ordre de suma que Matrix::Multiply, per reproduir l'oracle bit a bit.
+static double dot_row(const double* row, const Vec& x) {
+    double acc = row[0] * x[0];
+    for (size_t j = 1; j < x.size(); ++j) acc += row[j] * x[j];
+    return acc;
 }
 
-int main() {
-    std::filesystem::create_directories("datasets");
-
-    for (int n : {500, 600, 700, 800}) {
-        std::mt19937 rng(1234u + n);
-        std::uniform_real_distribution<double> U(-1.0, 1.0);
-
-        // ---------- CASOS "OK" ----------
-        Matrix A(n, n, 0.0), B(n, n, 0.0);
-        Vec x(n), rhs;
-        for (int i = 0; i < n; ++i) {
-            double rowsum = 0.0;
-            for (int j = 0; j < n; ++j) {
-                if (i != j) { double v = U(rng); A.At(i, j) = v; rowsum += std::fabs(v); }
-                B.At(i, j) = U(rng);
+static bool has(const Options& o, const char* k) {
+    return std::find(o.kinds.begin(), o.kinds.end(), k) != o.kinds.end();
+}
+
+static bool generate(const Options& o, int n_) {
+    const size_t n = size_t(n_);
+    const std::uint64_t seed = o.seed + std::uint64_t(n);
+    const size_t R = std::min(o.block_rows, n);
+    const std::string tag = "_" + std::to_string(n) + (o.compress ? ".lbz" : ".bin");
+    auto path = [&](const char* name) { return o.out + "/" + name + tag; };
+    CompressOptions copt_storage;
+    copt_storage.mantissa_bits = o.mantissa_bits;
+    copt_storage.threads = o.threads;
+    const CompressOptions* copt = o.compress ? &copt_storage : nullptr;
+    auto par = [&](size_t count, auto&& fn) { LinAlg::ParallelFor(count, fn, o.threads); };
+
+    const bool well = has(o, "well"), sing = has(o, "singular"), zp = has(o, "zeropiv");
+    const bool spd = has(o, "spd"), band = has(o, "banded");
+    const bool needA = well || sing || zp;
+
+    Vec x(n);
+    LinAlg::PhiloxFillRow(seed, kX, 0, 0, n, x.data());
+
+    std::vector<double> blk(R * n), tmp(n), rhs(R);
+    bool ok = true;
+
+    // ---------- A i derivades (OK, SINGULAR, ZERO PIVOT) + oracles MatVec/MatMul ----------
+    if (needA) {
+        BinSink fA, fX, fRhs, fY, fB, fC, fXBad, fBBad, fZ, fRhsZ, fS, fRhsS;
+        if (well) {
+            ok &= fA.Open(path("A"), n, copt) && fX.Open(path("x"), 1, copt) && fRhs.Open(path("rhs"), 1, copt)
+                && fY.Open(path("y"), 1, copt) && fB.Open(path("B"), n, copt) && fXBad.Open(path("x_bad"), 1, copt)
+                && fBBad.Open(path("B_bad"), n - 1, copt);
+            if (o.matmul) ok &= fC.Open(path("C"), n, copt);
+        }
+        if (zp) ok &= fZ.Open(path("A_zeropiv"), n, copt) && fRhsZ.Open(path("rhs_zeropiv"), 1, copt);
+        if (sing) ok &= fS.Open(path("A_sing"), n, copt) && fRhsS.Open(path("rhs_sing"), 1, copt);
+        if (!ok) { std::cerr << "No s'ha pogut obrir la sortida a " << o.out << "\n"; return false; }
+
+        std::vector<double> row0(n), Bk, Cblk;
+        well_row(seed, n, 0, row0.data());      // la fila 1 d'A_sing s la fila 0 d'A
+        if (well && o.matmul) { Bk.resize(R * n); Cblk.resize(R * n); }
+
+        for (size_t r0 = 0; r0 < n; r0 += R) {
+            const size_t rows = std::min(R, n - r0);
+            par(rows, [&](size_t i) {
+                well_row(seed, n, r0 + i, &blk[i * n]);
+                rhs[i] = dot_row(&blk[i * n], x);
+            });
+
+            if (well) {
+                fA.Write(blk.data(), rows * n);
+                fRhs.Write(rhs.data(), rows);
+                fY.Write(rhs.data(), rows);
             }
-            A.At(i, i) = rowsum + 1.0;     // A ben condicionada
-            x[(size_t)i] = U(rng);
+
+            // Variants: noms canvien les files 0 i 1, la resta s A tal qual.
+            if (zp) {
+                for (size_t i = 0; i < rows; ++i) {
+                    const size_t gi = r0 + i;
+                    if (gi > 1) { fZ.Write(&blk[i * n], n); fRhsZ.Write(&rhs[i], 1); continue; }
+                    std::copy(&blk[i * n], &blk[i * n] + n, tmp.begin());
+                    if (gi == 0) tmp[0] = 0.0;
+                    if (gi == 1 && std::fabs(tmp[0]) < 0.2) tmp[0] = (tmp[0] >= 0 ? +0.5 : -0.5);
+                    double r = dot_row(tmp.data(), x);
+                    fZ.Write(tmp.data(), n); fRhsZ.Write(&r, 1);
+                }
+            }
+            if (sing) {
+                for (size_t i = 0; i < rows; ++i) {
+                    const size_t gi = r0 + i;
+                    const double* src = (gi == 1) ? row0.data() : &blk[i * n];
+                    double r = (gi == 1) ? dot_row(row0.data(), x) : rhs[i];
+                    fS.Write(src, n); fRhsS.Write(&r, 1);
+                }
+            }
+
+            // C = A*B per blocs de files: B es regenera per blocs k (no cal tenir-la sencera).
+            // El primer bloc aprofita els blocs de B per escriure B_n.bin.
+            if (well && o.matmul) {
+                std::fill(Cblk.begin(), Cblk.begin() + rows * n, 0.0);
+                for (size_t k0 = 0; k0 < n; k0 += R) {
+                    const size_t kr = std::min(R, n - k0);
+                    par(kr, [&](size_t k) { LinAlg::PhiloxFillRow(seed, kB, k0 + k, 0, n, &Bk[k * n]); });
+                    if (r0 == 0) fB.Write(Bk.data(), kr * n);
+                    par(rows, [&](size_t i) {
+                        const double* a = &blk[i * n + k0];
+                        double* c = &Cblk[i * n];
+                        for (size_t k = 0; k < kr; ++k) {
+                            const double aik = a[k];
+                            const double* b = &Bk[k * n];
+                            for (size_t j = 0; j < n; ++j) c[j] += aik * b[j];
+                        }
+                    });
+                }
+                fC.Write(Cblk.data(), rows * n);
+            }
+        }
+
+        if (well) {
+            if (!o.matmul) {
+                for (size_t r0 = 0; r0 < n; r0 += R) {
+                    const size_t rows = std::min(R, n - r0);
+                    par(rows, [&](size_t i) { LinAlg::PhiloxFillRow(seed, kB, r0 + i, 0, n, &blk[i * n]); });
+                    fB.Write(blk.data(), rows * n);
+                }
+            }
+            fX.Write(x.data(), n);
+
+            // ---------- CASOS "DIM MISMATCH" ----------
+            // MatVec: x_bad de mida n-1; MatMul: B_bad de mida n x (n-1)
+            LinAlg::PhiloxFillRow(seed, kXBad, 0, 0, n - 1, tmp.data());
+            fXBad.Write(tmp.data(), n - 1);
+            for (size_t r0 = 0; r0 < n; r0 += R) {
+                const size_t rows = std::min(R, n - r0);
+                par(rows, [&](size_t i) { LinAlg::PhiloxFillRow(seed, kBBad, r0 + i, 0, n - 1, &blk[i * (n - 1)]); });
+                fBBad.Write(blk.data(), rows * (n - 1));
+            }
+
+            ok &= fA.Close() && fX.Close() && fRhs.Close() && fY.Close() && fB.Close() && fXBad.Close() && fBBad.Close();
+            if (o.matmul) ok &= fC.Close();
         }
-        Vec y = A.Multiply(x, nullptr);       // oracle MatVec
-        Matrix C = A.Multiply(B, nullptr);    // oracle MatMul
-        rhs = y;                               // rhs per Solve
-
-        SaveMatrixBin("datasets/A_" + std::to_string(n) + ".bin", A);
-        SaveMatrixBin("datasets/B_" + std::to_string(n) + ".bin", B);
-        SaveVectorBin("datasets/x_" + std::to_string(n) + ".bin", x);
-        SaveVectorBin("datasets/rhs_" + std::to_string(n) + ".bin", rhs);
-        SaveVectorBin("datasets/y_" + std::to_string(n) + ".bin", y);
-        SaveMatrixBin("datasets/C_" + std::to_string(n) + ".bin", C);
-
-        // ---------- CASOS "DIM MISMATCH" ----------
-        // MatVec: x_bad de mida n-1
-        Vec x_bad((size_t)std::max(1, n - 1));
-        for (int i = 0; i < (int)x_bad.size(); ++i) x_bad[(size_t)i] = U(rng);
-        SaveVectorBin("datasets/x_bad_" + std::to_string(n) + ".bin", x_bad);
-
-        // MatMul: B_bad de mida n x (n-1) (sense capalera -> fitxer amb (n*(n-1)) doubles)
-        Matrix B_bad = rand_mat(n, std::max(1, n - 1), rng);
-        SaveMatrixBin("datasets/B_bad_" + std::to_string(n) + ".bin", B_bad);
-
-        // ---------- CASOS "ZERO PIVOT (no singular) ----------
-        // A_zeropiv: pivot (0,0)=0 per fila 1 t element a (1,0) no nul -> parcial pivot ha de resoldre
-        Matrix A_zeropiv = A;
-        A_zeropiv.At(0, 0) = 0.0;
-        if (std::fabs(A_zeropiv.At(1, 0)) < 0.2) A_zeropiv.At(1, 0) = (A_zeropiv.At(1, 0) >= 0 ? +0.5 : -0.5);
-        Vec x_true = x; // qualsevol
-        Vec rhs_zeropiv = A_zeropiv.Multiply(x_true, nullptr);
-
-        SaveMatrixBin("datasets/A_zeropiv_" + std::to_string(n) + ".bin", A_zeropiv);
-        SaveVectorBin("datasets/rhs_zeropiv_" + std::to_string(n) + ".bin", rhs_zeropiv);
-
-        // ---------- CASOS "SINGULAR" ----------
-        // A_sing: dupliquem la fila 0 a la fila 1 (rang deficient)
-        Matrix A_sing = A;
-        for (int j = 0; j < n; ++j) A_sing.At(1, j) = A_sing.At(0, j);
-        Vec rhs_sing = A_sing.Multiply(x_true, nullptr); // coherent
-
-        SaveMatrixBin("datasets/A_sing_" + std::to_string(n) + ".bin", A_sing);
-        SaveVectorBin("datasets/rhs_sing_" + std::to_string(n) + ".bin", rhs_sing);
+        if (zp) ok &= fZ.Close() && fRhsZ.Close();
+        if (sing) ok &= fS.Close() && fRhsS.Close();
+    }
+
+    // ---------- SPD i BANDA ----------
+    auto simple = [&](const char* a_name, const char* rhs_name, auto&& make_row) {
+        BinSink fM, fR;
+        if (!fM.Open(path(a_name), n, copt) || !fR.Open(path(rhs_name), 1, copt)) { std::cerr << "No s'ha pogut obrir la sortida a " << o.out << "\n"; return false; }
+        for (size_t r0 = 0; r0 < n; r0 += R) {
+            const size_t rows = std::min(R, n - r0);
+            par(rows, [&](size_t i) {
+                make_row(r0 + i, &blk[i * n]);
+                rhs[i] = dot_row(&blk[i * n], x);
+            });
+            fM.Write(blk.data(), rows * n);
+            fR.Write(rhs.data(), rows);
+        }
+        return fM.Close() && fR.Close();
+    };
+    if (spd) ok &= simple("A_spd", "rhs_spd", [&](size_t i, double* row) { spd_row(seed, n, i, row); });
+    if (band) ok &= simple("A_band", "rhs_band", [&](size_t i, double* row) { banded_row(seed, n, size_t(o.band), i, row); });
+    return ok;
+}
+
+int main(int argc, char** argv) {
+    Options o;
+    if (!parse_args(argc, argv, o)) return 2;
+    std::filesystem::create_directories(o.out);
+
+    const size_t threads = o.threads ? o.threads : LinAlg::HardwareThreads();
+    for (int n : o.sizes) {
+        auto t0 = std::chrono::steady_clock::now();
+        if (!generate(o, n)) return 1;
+        double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
 
         // informes rpids
-        auto szB = std::filesystem::file_size("datasets/B_" + std::to_string(n) + ".bin");
-        auto szBb = std::filesystem::file_size("datasets/B_bad_" + std::to_string(n) + ".bin");
-        std::cout << "OK n=" << n
-            << "  A:" << A.a.size() << "  B:" << B.a.size()
-            << "  y:" << y.size() << "  C:" << C.a.size()
-            << "  x_bad:" << x_bad.size()
-            << "\nB_" << n << ".bin bytes=" << szB << "  B_bad_" << n << ".bin bytes=" << szBb << "\n";
+        const double mem_mb = 3.0 * double(std::min(o.block_rows, size_t(n))) * n * sizeof(double) / (1 << 20);
+        std::cout << "OK n=" << n << " s=" << s << " fils=" << threads << " memoria~" << mem_mb << "MB tipus=";
+        for (size_t i = 0; i < o.kinds.size(); ++i) std::cout << (i ? "," : "") << o.kinds[i];
+        std::cout << (o.matmul ? "" : " (sense C)") << "\n";
     }
     return 0;
 }
\ No newline at end of file
@@ -1,7 +1,9 @@
 #include <iostream>
 #include <vector>
 #include <string>
+#include <algorithm>
 #include <cmath>
+#include <cfloat>
 #include "Matrix.hpp"
 #include "LinAlg.hpp"
 #include "Solve.hpp"
@@ -9,6 +11,31 @@
 #include "BenchConfig.hpp"
 #include "Timer.hpp"
 #include "OpsCounter.hpp"
+#include "SolveService.hpp"
+#include "LUCache.hpp"
+#include "LowRankUpdate.hpp"
+#include "Blas.hpp"
+#include "BenchHarness.hpp"
+#include "Trace.hpp"
+#include "Progress.hpp"
+#include "Condition.hpp"
+#include "Pivoting.hpp"
+#include "QR.hpp"
+#include "Accumulate.hpp"
+#include "Determinant.hpp"
+#include "DatasetPrefetch.hpp"
+#include "Symmetric.hpp"
+#include "Distributed.hpp"
+#include <cstring>
+#include <sstream>
+#include <memory>
+#include <random>
+#include <thread>
+#include <mutex>
+#include <future>
+#include <chrono>
+#include <functional>
+#include <filesystem>
 
 static constexpr const char* G = "\x1b[32m", * R = "\x1b[31m", * Z = "\x1b[0m";
 
@@ -28,22 +55,366 @@ static double rel_err_mat(const Matrix& C, const Matrix& Cref) {
     return (den == 0.0) ? std::sqrt(num) : std::sqrt(num / std::max(den, 1e-300));
 }
 
-int main() {
+// Matriu diagonal dominant (ben condicionada) per a les crregues sinttiques.
+static Matrix rand_dd_mat(int n, std::mt19937& rng) {
+    std::uniform_real_distribution<double> U(-1.0, 1.0);
+    Matrix M(n, n, 0.0);
+    for (int i = 0; i < n; ++i) {
+        double rowsum = 0.0;
+        for (int j = 0; j < n; ++j) if (i != j) { double v = U(rng); M.At(i, j) = v; rowsum += std::fabs(v); }
+        M.At(i, i) = rowsum + 1.0;
+    }
+    return M;
+}
+
+static Matrix transpose(const Matrix& M) {
+    Matrix T(M.cols, M.rows);
+    for (size_t i = 0; i < M.rows; ++i) for (size_t j = 0; j < M.cols; ++j) T.a[j * M.rows + i] = M.a[i * M.cols + j];
+    return T;
+}
+
+// ===== Mode --perf: warmups + repeticions, estadstiques i sortida JSON/CSV =====
+struct PerfArgs {
+    Bench::HarnessConfig h;
+    std::vector<int> sizes;
+    std::vector<std::string> kernels;   // buit => tots
+    std::string json, csv, trace;
+    std::size_t prefetch_mb = 256;
+};
+
+static std::vector<std::string> split_list(const std::string& s) {
+    std::vector<std::string> out; std::stringstream ss(s); std::string tok;
+    while (std::getline(ss, tok, ',')) if (!tok.empty()) out.push_back(tok);
+    return out;
+}
+
+static bool parse_perf_args(int argc, char** argv, PerfArgs& pa) {
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        auto next = [&](std::string& v) { if (i + 1 >= argc) return false; v = argv[++i]; return true; };
+        std::string v;
+        if (a == "--perf") continue;
+        else if (a == "--reps" && next(v)) pa.h.reps = std::atoi(v.c_str());
+        else if (a == "--warmup" && next(v)) pa.h.warmups = std::atoi(v.c_str());
+        else if (a == "--pin" && next(v)) pa.h.pin_cpu = std::atoi(v.c_str());
+        else if (a == "--json" && next(v)) pa.json = v;
+        else if (a == "--csv" && next(v)) pa.csv = v;
+        else if (a == "--sizes" && next(v)) { pa.sizes.clear(); for (auto& t : split_list(v)) pa.sizes.push_back(std::atoi(t.c_str())); }
+        else if (a == "--kernels" && next(v)) pa.kernels = split_list(v);
+        else if (a == "--hw") pa.h.hw_counters = true;
+        else if (a == "--trace" && next(v)) pa.trace = v;
+        else if (a == "--prefetch-mb" && next(v)) pa.prefetch_mb = std::size_t(std::atoll(v.c_str()));
+        else { std::cerr << "Argument desconegut: " << a << "\n"; return false; }
+    }
+    return true;
+}
+
+static void print_hw(const char* label, const LinAlg::HwCounters& c) {
+    if (!c.valid) return;
+    std::cout << "    " << label << " cycles=" << c.cycles << " instr=" << c.instructions << " IPC=" << c.Ipc()
+        << " L1D-miss=" << c.l1d_misses << " LLC-miss=" << c.llc_misses << " dTLB-miss=" << c.dtlb_misses
+        << " br-miss=" << c.branch_misses << "\n";
+}
+
+static int run_perf(const BenchConfig& cfg, PerfArgs pa) {
+    if (pa.sizes.empty()) pa.sizes = { 500, 600, 700, 800 };
+    bool pinned = Bench::PinThisThread(pa.h.pin_cpu);
+    if (pa.h.pin_cpu >= 0 && !pinned) std::cerr << "Avis: no s'ha pogut fixar el fil a la CPU " << pa.h.pin_cpu << "\n";
+
+    if (pa.h.hw_counters) {
+        if (LinAlg::HwCountersAvailable()) LinAlg::SetHwCountersEnabled(true);
+        else { std::cerr << "Avis: comptadors hardware no disponibles (perf_event_open); es mesura noms el temps\n"; pa.h.hw_counters = false; }
+    }
+
+    if (!pa.trace.empty()) LinAlg::SetTracingEnabled(true);
+
+    auto wanted = [&](const char* k) {
+        return pa.kernels.empty() || std::find(pa.kernels.begin(), pa.kernels.end(), k) != pa.kernels.end();
+    };
+
+    std::vector<Bench::BenchStats> results;
+    auto report = [&](const Bench::BenchStats& s) {
+        std::cout << "[Perf][" << s.kernel << "][n=" << s.n << "] median=" << s.median_ms << "ms min=" << s.min_ms
+            << " p95=" << s.p95_ms << " sd=" << s.stddev_ms << " GFLOP/s=" << s.gflops << " GB/s=" << s.gbps << "\n";
+        print_hw("hw/rep", s.hw);
+        results.push_back(s);
+    };
+
+    // Els datasets de la mida segent es llegeixen en un fil d'E/S mentre es mesura l'actual.
+    std::vector<std::vector<std::string>> jobs;
+    for (int n : pa.sizes) {
+        const std::string sn = std::to_string(n);
+        jobs.push_back({ "datasets/A_" + sn + ".bin", "datasets/B_" + sn + ".bin", "datasets/x_" + sn + ".bin", "datasets/rhs_" + sn + ".bin" });
+    }
+    LinAlg::PrefetchConfig pcfg;
+    pcfg.max_bytes = pa.prefetch_mb << 20;
+    LinAlg::DatasetPrefetcher loader(std::move(jobs), pcfg);
+
+    for (int n : pa.sizes) {
+        LinAlg::PrefetchedJob job;
+        Matrix A, B;
+        Vec x, rhs;
+        bool loaded = loader.Next(job) && job.ok;
+        try {
+            if (loaded) {
+                A = job.TakeMatrix(0, n, n); B = job.TakeMatrix(1, n, n);
+                x = job.TakeVector(2); rhs = job.TakeVector(3);
+            }
+        }
+        catch (const std::invalid_argument&) { loaded = false; }
+        if (!loaded || x.size() != size_t(n) || rhs.size() != size_t(n)) {
+            std::cerr << "Falten datasets per a n=" << n << "\n";
+            return 1;
+        }
+        const double nn = double(n) * n, d = sizeof(double);
+
+        // Bytes: trfic mnim obligat (llegir entrades i escriure sortides un cop).
+        if (wanted("MatVec")) report(Bench::Measure("MatVec", n, (nn + 2.0 * n) * d, [&](OpsCounter* op) { (void)A.Multiply(x, op); }, pa.h));
+        // Mat-vec amb acumulaci compensada/estesa: mateix trnsit, el cost extra s aritmtic.
+        for (auto e : { std::make_pair("MatVecNeumaier", LinAlg::AccumMode::Neumaier),
+                        std::make_pair("MatVecPairwise", LinAlg::AccumMode::Pairwise),
+                        std::make_pair("MatVecDD", LinAlg::AccumMode::DoubleDouble) }) {
+            if (wanted(e.first)) report(Bench::Measure(e.first, n, (nn + 2.0 * n) * d, [&](OpsCounter* op) { (void)LinAlg::MatVec(A, x, e.second, op); }, pa.h));
+        }
+        if (wanted("Spmv")) {
+            // Triangle inferior d'A empaquetat: meitat de bytes que MatVec per a la mateixa matriu lgica.
+            LinAlg::SymPacked S = LinAlg::SymPacked::FromLower(A);
+            Vec ys(n);
+            report(Bench::Measure("Spmv", n, (nn / 2 + 2.0 * n) * d, [&](OpsCounter* op) { LinAlg::Spmv(1.0, S, x, 0.0, ys, op); }, pa.h));
+        }
+        if (wanted("MatMul")) report(Bench::Measure("MatMul", n, 3.0 * nn * d, [&](OpsCounter* op) { (void)A.Multiply(B, op); }, pa.h));
+        if (wanted("Gemm")) {
+            Matrix C(n, n);
+            report(Bench::Measure("Gemm", n, 3.0 * nn * d, [&](OpsCounter* op) { LinAlg::Gemm(LinAlg::Trans::No, LinAlg::Trans::No, 1.0, A, B, 0.0, C, op); }, pa.h));
+        }
+        if (wanted("Strassen")) report(Bench::Measure("Strassen", n, 3.0 * nn * d, [&](OpsCounter* op) { (void)A.MultiplyStrassen(B, cfg.strassen_cutoff, op); }, pa.h));
+        // Dels solvers mostrem tamb el desglossament per fases de l'ltima repetici.
+        LinAlg::SolveReport last;
+        auto phases = [&]() {
+            print_hw("eliminacio", last.hw.elimination);
+            print_hw("substitucio", last.hw.back_substitution);
+            print_hw("residu", last.hw.residual);
+            const LinAlg::PhaseTimes& ph = last.phases;
+            std::cout << "    fases(ms) copia=" << ph.copy_ms << " elim=" << ph.elimination_ms;
+            if (LinAlg::TracingEnabled()) std::cout << " [pivot=" << ph.pivot_ms << " swap=" << ph.swap_ms << " update=" << ph.update_ms << "]";
+            std::cout << " subst=" << ph.back_ms << " residu=" << ph.residual_ms << "\n";
+        };
+        if (wanted("NoPivot")) {
+            report(Bench::Measure("NoPivot", n, 2.0 * nn * d, [&](OpsCounter* op) {
+                last = LinAlg::SolveNoPivot(A, rhs, cfg.tol); if (op) op->Merge(last.ops); }, pa.h));
+            phases();
+        }
+        if (wanted("PartialPivot")) {
+            report(Bench::Measure("PartialPivot", n, 2.0 * nn * d, [&](OpsCounter* op) {
+                last = LinAlg::SolvePartialPivot(A, rhs, cfg.tol); if (op) op->Merge(last.ops); }, pa.h));
+            phases();
+        }
+        // La resta d'estratgies noms si es demanen explcitament (--kernels ScaledPivot,RookPivot,CompletePivot).
+        const std::pair<const char*, LinAlg::PivotStrategy> extra[] = { { "ScaledPivot", LinAlg::PivotStrategy::ScaledPartial },
+            { "RookPivot", LinAlg::PivotStrategy::Rook }, { "CompletePivot", LinAlg::PivotStrategy::Complete } };
+        for (const auto& e : extra) {
+            if (pa.kernels.empty() || !wanted(e.first)) continue;
+            report(Bench::Measure(e.first, n, 2.0 * nn * d, [&](OpsCounter* op) {
+                last = LinAlg::SolvePivoted(A, rhs, cfg.tol, e.second); if (op) op->Merge(last.ops); }, pa.h));
+            phases();
+        }
+        // Inversa explcita a partir d'una LU ja feta (noms amb --kernels Inverse).
+        if (!pa.kernels.empty() && wanted("Inverse")) {
+            LinAlg::LUFactors F = LinAlg::FactorizeLU(A, cfg.tol);
+            report(Bench::Measure("Inverse", n, 2.0 * nn * d, [&](OpsCounter* op) { (void)LinAlg::Inverse(F, 64, 0, op); }, pa.h));
+        }
+    }
+
+    Bench::RunInfo info = Bench::CollectRunInfo(pa.h);
+    if (!pa.json.empty() && !Bench::WriteJson(pa.json, info, results)) { std::cerr << "No s'ha pogut escriure " << pa.json << "\n"; return 1; }
+    if (!pa.csv.empty() && !Bench::WriteCsv(pa.csv, results)) { std::cerr << "No s'ha pogut escriure " << pa.csv << "\n"; return 1; }
+    if (!pa.trace.empty() && !LinAlg::WriteChromeTrace(pa.trace)) { std::cerr << "No s'ha pogut escriure " << pa.trace << "\n"; return 1; }
+    return 0;
+}
+
+// ===== Mode --sweep: n geomtrica amb matrius generades al vol i informe roofline =====
+struct SweepArgs {
+    Bench::HarnessConfig h;
+    int min_n = 16, max_n = 8192;
+    double step = 1.41421356, budget_s = 2.0;
+    std::size_t mem_mb = 2048;
+    std::vector<std::string> kernels;
+    std::string json, csv;
+};
+
+static bool parse_sweep_args(int argc, char** argv, SweepArgs& sa) {
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        auto next = [&](std::string& v) { if (i + 1 >= argc) return false; v = argv[++i]; return true; };
+        std::string v;
+        if (a == "--sweep") continue;
+        else if (a == "--min" && next(v)) sa.min_n = std::max(1, std::atoi(v.c_str()));
+        else if (a == "--max" && next(v)) sa.max_n = std::atoi(v.c_str());
+        else if (a == "--step" && next(v)) sa.step = std::atof(v.c_str());
+        else if (a == "--budget" && next(v)) sa.budget_s = std::atof(v.c_str());
+        else if (a == "--mem" && next(v)) sa.mem_mb = std::size_t(std::atoll(v.c_str()));
+        else if (a == "--reps" && next(v)) sa.h.reps = std::atoi(v.c_str());
+        else if (a == "--pin" && next(v)) sa.h.pin_cpu = std::atoi(v.c_str());
+        else if (a == "--kernels" && next(v)) sa.kernels = split_list(v);
+        else if (a == "--json" && next(v)) sa.json = v;
+        else if (a == "--csv" && next(v)) sa.csv = v;
+        else { std::cerr << "Argument desconegut: " << a << "\n"; return false; }
+    }
+    if (sa.step <= 1.0) { std::cerr << "--step ha de ser > 1\n"; return false; }
+    return true;
+}
+
+static int run_sweep(const BenchConfig& cfg, SweepArgs sa) {
+    bool pinned = Bench::PinThisThread(sa.h.pin_cpu);
+    if (sa.h.pin_cpu >= 0 && !pinned) std::cerr << "Avis: no s'ha pogut fixar el fil a la CPU " << sa.h.pin_cpu << "\n";
+
+    // Sostres de la mquina (un fil, com els kernels).
+    const double peak = Bench::MeasurePeakGflops();
+    const double bw = Bench::MeasureStreamGbps();
+    std::cout << "[Sweep][Roof] peak=" << peak << " GFLOP/s stream=" << bw << " GB/s ridge AI=" << peak / bw << " flop/byte\n";
+
+    std::vector<int> sizes;
+    for (double v = sa.min_n; v <= sa.max_n + 0.5; v *= sa.step) {
+        int n = int(std::lround(v));
+        if (sizes.empty() || n > sizes.back()) sizes.push_back(n);
+    }
+
+    // flops exactes dels kernels (mateix criteri que OpsCounter) i trnsit mnim en bytes.
+    struct Kernel { const char* name; double exponent; int matrices; bool active; };
+    std::vector<Kernel> ks = { { "MatVec", 2.0, 1, true }, { "MatMul", 3.0, 3, true },
+                               { "NoPivot", 3.0, 3, true }, { "PartialPivot", 3.0, 3, true } };
+    for (auto& k : ks) k.active = sa.kernels.empty() || std::find(sa.kernels.begin(), sa.kernels.end(), k.name) != sa.kernels.end();
+    auto flops_of = [](const std::string& k, double n) {
+        if (k == "MatVec") return n * (2.0 * n - 1.0);
+        if (k == "MatMul") return n * n * (2.0 * n - 1.0);
+        double s1 = (n - 1.0) * n / 2.0, s2 = (n - 1.0) * n * (2.0 * n - 1.0) / 6.0;
+        return 3.0 * s1 + 2.0 * s2 + n * n;    // eliminaci amb b + substituci enrere
+    };
+    auto bytes_of = [](const std::string& k, double n) {
+        const double d = sizeof(double);
+        if (k == "MatVec") return (n * n + 2.0 * n) * d;
+        if (k == "MatMul") return 3.0 * n * n * d;
+        return 2.0 * n * n * d;
+    };
+
+    std::vector<Bench::BenchStats> results;
+    std::mt19937 rng(2024);
+    const double budget_ms = sa.budget_s * 1e3;
+    for (std::size_t si = 0; si < sizes.size(); ++si) {
+        const int n = sizes[si];
+        const double nn = double(n) * n;
+        bool any = false;
+        for (auto& k : ks) {
+            if (k.active && nn * sizeof(double) * k.matrices > double(sa.mem_mb) * (1 << 20)) {
+                std::cout << "[Sweep][" << k.name << "] aturat a n=" << n << ": supera --mem " << sa.mem_mb << " MB\n";
+                k.active = false;
+            }
+            any |= k.active;
+        }
+        if (!any) break;
+
+        Matrix A = rand_dd_mat(n, rng);
+        Matrix B = ks[1].active ? rand_dd_mat(n, rng) : Matrix();
+        Vec x(n), rhs;
+        std::uniform_real_distribution<double> U(-1.0, 1.0);
+        for (double& v : x) v = U(rng);
+        rhs = A.Multiply(x, nullptr);
+
+        for (auto& k : ks) {
+            if (!k.active) continue;
+            const std::string name = k.name;
+            std::function<void(OpsCounter*)> body;
+            if (name == "MatVec") body = [&](OpsCounter* op) { (void)A.Multiply(x, op); };
+            else if (name == "MatMul") body = [&](OpsCounter* op) { (void)A.Multiply(B, op); };
+            else if (name == "NoPivot") body = [&](OpsCounter*) { (void)LinAlg::SolveNoPivot(A, rhs, cfg.tol); };
+            else body = [&](OpsCounter*) { (void)LinAlg::SolvePartialPivot(A, rhs, cfg.tol); };
+
+            // Una passada de prova fa d'escalfament i decideix quantes repeticions caben al pressupost.
+            Timer probe; probe.Tic();
+            body(nullptr);
+            double t1 = std::max(probe.TocMs(), 1e-6);
+            Bench::HarnessConfig h = sa.h;
+            h.warmups = 0;
+            h.reps = std::max(1, std::min(sa.h.reps, int(budget_ms / t1)));
+
+            const double fl = flops_of(name, n), by = bytes_of(name, n);
+            Bench::BenchStats st = Bench::Measure(name, std::size_t(n), by, body, h, fl);
+            const double ai = fl / by;
+            const double roof = std::min(peak, ai * bw);
+            std::cout << "[Sweep][" << name << "][n=" << n << "] ws=" << by / 1024.0 << "KB median=" << st.median_ms
+                << "ms GFLOP/s=" << st.gflops << " GB/s=" << st.gbps << " AI=" << ai
+                << " roof=" << roof << " eff=" << (roof > 0.0 ? 100.0 * st.gflops / roof : 0.0) << "%"
+                << " (" << (ai * bw < peak ? "memoria" : "calcul") << ")\n";
+            results.push_back(st);
+
+            // Si la mida segent ja no cap al pressupost, aquest kernel s'atura aqu.
+            if (si + 1 < sizes.size() && t1 * std::pow(double(sizes[si + 1]) / n, k.exponent) > budget_ms) {
+                std::cout << "[Sweep][" << name << "] aturat a n=" << n << ": n=" << sizes[si + 1] << " superaria el pressupost de " << sa.budget_s << " s\n";
+                k.active = false;
+            }
+        }
+    }
+
+    Bench::RunInfo info = Bench::CollectRunInfo(sa.h);
+    if (!sa.json.empty() && !Bench::WriteJson(sa.json, info, results)) { std::cerr << "No s'ha pogut escriure " << sa.json << "\n"; return 1; }
+    if (!sa.csv.empty() && !Bench::WriteCsv(sa.csv, results)) { std::cerr << "No s'ha pogut escriure " << sa.csv << "\n"; return 1; }
+    return 0;
+}
+
+int main(int argc, char** argv) {
     BenchConfig cfg;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--perf") == 0) {
+            PerfArgs pa;
+            pa.h.warmups = cfg.perf_warmups; pa.h.reps = cfg.perf_reps;
+            pa.prefetch_mb = cfg.prefetch_mb;
+            if (!parse_perf_args(argc, argv, pa)) return 2;
+            return run_perf(cfg, pa);
+        }
+        if (std::strcmp(argv[i], "--sweep") == 0) {
+            SweepArgs sa;
+            sa.h.reps = cfg.perf_reps;
+            sa.min_n = cfg.sweep_min_n; sa.max_n = cfg.sweep_max_n; sa.step = cfg.sweep_step;
+            sa.budget_s = cfg.sweep_budget_s; sa.mem_mb = cfg.sweep_mem_mb;
+            if (!parse_sweep_args(argc, argv, sa)) return 2;
+            return run_sweep(cfg, sa);
+        }
+    }
+
     std::vector<int> ns = { 500,600,700,800 };
     bool all_ok = true;
+    std::vector<double> relF_classic;   // error de Multiply contra C_n.bin, per comparar amb Strassen
 
     // ===== Ex1: MatVec/MatMul (OK) + casos DIM MISMATCH =====
+    // A, B, x, y i C de la n segent es carreguen en segon pla mentre es comprova l'actual.
+    std::vector<std::vector<std::string>> ex1_jobs;
     for (int n : ns) {
-        Matrix A(n, n); LoadMatrixBin("datasets/A_" + std::to_string(n) + ".bin", A); A.rows = n; A.cols = n;
-        Matrix B(n, n); LoadMatrixBin("datasets/B_" + std::to_string(n) + ".bin", B); B.rows = n; B.cols = n;
-        Vec x; LoadVectorBin("datasets/x_" + std::to_string(n) + ".bin", x);
+        const std::string sn = std::to_string(n);
+        ex1_jobs.push_back({ "datasets/A_" + sn + ".bin", "datasets/B_" + sn + ".bin", "datasets/x_" + sn + ".bin",
+            "datasets/y_" + sn + ".bin", "datasets/C_" + sn + ".bin" });
+    }
+    LinAlg::DatasetPrefetcher ex1_loader(std::move(ex1_jobs));
+    for (int n : ns) {
+        LinAlg::PrefetchedJob job;
+        ex1_loader.Next(job);
+        // Un fitxer que falta deixa la matriu a zeros (i el vector buit), com feien LoadMatrixBin i
+        // LoadVectorBin; la resta de fitxers del treball es llegeixen igualment.
+        auto mat = [&](std::size_t i) {
+            Matrix M(n, n);
+            if (job.loaded[i]) M.a = std::move(job.buffers[i]);
+            M.rows = n; M.cols = n;
+            return M;
+        };
+        Matrix A = mat(0);
+        Matrix B = mat(1);
+        Vec x = job.TakeVector(2);
 
         // MatVec ok
         OpsCounter op1; Timer t1; t1.Tic(); Vec y = A.Multiply(x, &op1); double tms1 = t1.TocMs();
         std::size_t mul1 = std::size_t(n) * n, add1 = std::size_t(n) * (n - 1);
         bool ok_ops1 = approx_eq(op1.mul, mul1, cfg.matvec_ops_tol) && approx_eq(op1.add, add1, cfg.matvec_ops_tol);
-        Vec yref; LoadVectorBin("datasets/y_" + std::to_string(n) + ".bin", yref);
+        Vec yref = job.TakeVector(3);
         double ry = rel_err_vec(y, yref);
         bool ok_val1 = (ry <= 1e-12);
         bool ok1 = ok_ops1 && ok_val1;
@@ -56,8 +427,9 @@ int main() {
         OpsCounter op2; Timer t2; t2.Tic(); Matrix C = A.Multiply(B, &op2); double tms2 = t2.TocMs();
         std::size_t mul2 = std::size_t(n) * n * n, add2 = std::size_t(n) * n * (n - 1);
         bool ok_ops2 = approx_eq(op2.mul, mul2, cfg.matmul_ops_tol) && approx_eq(op2.add, add2, cfg.matmul_ops_tol);
-        Matrix Cref(n, n); LoadMatrixBin("datasets/C_" + std::to_string(n) + ".bin", Cref); Cref.rows = n; Cref.cols = n;
+        Matrix Cref = mat(4);
         double rC = rel_err_mat(C, Cref);
+        relF_classic.push_back(rC);
         bool ok_val2 = (rC <= 1e-12);
         bool ok2 = ok_ops2 && ok_val2;
         std::cout << "[Ex1][MatMul][n=" << n << "] " << (ok2 ? G : R) << (ok2 ? "PASS" : "FAIL") << Z
@@ -135,5 +507,969 @@ int main() {
         all_ok &= pass_s;
     }
 
+    // ===== Svc: SolveService amb crrega sinttica (diversos clients, A repetides) =====
+    {
+        std::mt19937 rng(4321u);
+        std::vector<Matrix> pool;
+        for (int n : { 64, 128, 256 }) pool.push_back(rand_dd_mat(n, rng));
+
+        const int clients = 4, per_client = cfg.svc_requests_per_client;
+        LinAlg::ServiceConfig scfg; scfg.tol = cfg.tol;
+        LinAlg::SolveService svc(scfg);
+
+        std::vector<std::future<LinAlg::SolveReport>> futs((size_t)clients * per_client);
+        std::vector<Vec> rhs(futs.size());
+        Timer t; t.Tic();
+        std::vector<std::thread> producers;
+        for (int c = 0; c < clients; ++c) {
+            producers.emplace_back([&, c] {
+                std::mt19937 lrng(100u + c);
+                std::uniform_real_distribution<double> U(-1.0, 1.0);
+                for (int r = 0; r < per_client; ++r) {
+                    size_t id = (size_t)c * per_client + r;
+                    const Matrix& A = pool[(size_t)(lrng() % pool.size())];
+                    rhs[id].resize(A.rows);
+                    for (double& v : rhs[id]) v = U(lrng);
+                    futs[id] = svc.Submit(A, rhs[id]);
+                }
+            });
+        }
+        for (auto& p : producers) p.join();
+
+        double worst = 0.0; bool any_sing = false;
+        for (auto& f : futs) { auto r = f.get(); any_sing |= r.singular; worst = std::max(worst, r.rel_resid); }
+        double tms = t.TocMs();
+        LinAlg::ServiceMetrics m = svc.Metrics();
+
+        bool pass = !any_sing && worst <= 1e-8 && m.completed == futs.size() && m.failed == 0 && m.submitted == m.completed && m.queue_depth == 0;
+        std::cout << "[Svc][Load][req=" << futs.size() << "] " << (pass ? G : R) << (pass ? "PASS" : "FAIL") << Z
+            << " batches=" << m.batches << " coalesced=" << m.coalesced << " maxDepth=" << m.max_queue_depth
+            << " wait(avg/max)=" << m.MeanWaitMs() << "/" << m.max_wait_ms
+            << " solve(avg/max)=" << m.MeanSolveMs() << "/" << m.max_solve_ms
+            << " worstRel=" << worst << " ms=" << tms << "\n";
+        all_ok &= pass;
+    }
+
+    // ===== Cache: reproducci d'una traa de peticions amb A repetides =====
+    {
+        const int repeat = cfg.cache_trace_repeat;
+        std::vector<Matrix> As; std::vector<Vec> bs;
+        for (int n : ns) {
+            Matrix A(n, n); LoadMatrixBin("datasets/A_" + std::to_string(n) + ".bin", A); A.rows = n; A.cols = n;
+            Vec rhs; LoadVectorBin("datasets/rhs_" + std::to_string(n) + ".bin", rhs);
+            As.push_back(std::move(A)); bs.push_back(std::move(rhs));
+        }
+
+        LinAlg::LUCache cache(cfg.cache_bytes);
+        double miss_ms = 0, hit_ms = 0, worst = 0; bool any_sing = false;
+        // cond1 i pivot_growth es calculen en la fallada; els encerts han de retornar els mateixos.
+        std::vector<double> cond(As.size()), growth(As.size());
+        bool same_diag = true;
+        for (int r = 0; r < repeat; ++r) {
+            for (size_t i = 0; i < As.size(); ++i) {
+                auto rep = LinAlg::SolveCached(cache, As[i], bs[i], cfg.tol);
+                (r == 0 ? miss_ms : hit_ms) += rep.ms;
+                any_sing |= rep.singular; worst = std::max(worst, rep.rel_resid);
+                if (r == 0) { cond[i] = rep.cond1; growth[i] = rep.pivot_growth; same_diag &= rep.cond1 > 0.0 && rep.pivot_growth > 0.0; }
+                else same_diag &= rep.cond1 == cond[i] && rep.pivot_growth == growth[i];
+            }
+        }
+        LinAlg::CacheStats st = cache.Stats();
+        size_t exp_hits = As.size() * size_t(repeat - 1);
+        bool pass = !any_sing && worst <= 1e-8 && st.misses == As.size() && st.hits == exp_hits && st.evictions == 0 && same_diag;
+        std::cout << "[Cache][Trace][x" << repeat << "] " << (pass ? G : R) << (pass ? "PASS" : "FAIL") << Z
+            << " hits=" << st.hits << " misses=" << st.misses << " evict=" << st.evictions
+            << " MB=" << double(st.bytes) / (1 << 20)
+            << " missMs=" << miss_ms / double(As.size())
+            << " hitMs=" << (exp_hits ? hit_ms / double(exp_hits) : 0.0) << " worstRel=" << worst << "\n";
+        all_ok &= pass;
+
+        // Pressupost per a noms 2 entrades i traa cclica de 4 A: LRU ha d'expulsar a cada fallada.
+        std::mt19937 rng(777u);
+        std::vector<Matrix> small;
+        for (int i = 0; i < 4; ++i) small.push_back(rand_dd_mat(96, rng));
+        Vec bsmall(96, 1.0);
+        LinAlg::LUCache probe; LinAlg::SolveCached(probe, small[0], bsmall, cfg.tol);
+        size_t entry_bytes = probe.Stats().bytes;
+
+        LinAlg::LUCache tiny(2 * entry_bytes + entry_bytes / 2);
+        for (int r = 0; r < repeat; ++r)
+            for (const Matrix& A : small) LinAlg::SolveCached(tiny, A, bsmall, cfg.tol);
+        LinAlg::CacheStats ts = tiny.Stats();
+        size_t accesses = small.size() * size_t(repeat);
+        bool pass_ev = ts.hits == 0 && ts.misses == accesses && ts.evictions == accesses - 2 && ts.entries == 2;
+        std::cout << "[Cache][Evict][x" << repeat << "] " << (pass_ev ? G : R) << (pass_ev ? "PASS" : "FAIL") << Z
+            << " hits=" << ts.hits << " misses=" << ts.misses << " evict=" << ts.evictions << " entries=" << ts.entries << "\n";
+        all_ok &= pass_ev;
+
+        // Collisi forada: una entrada amb l'empremta de small[0] per factors i contingut de
+        // small[1]. La cache l'ha de rebutjar i tornar a factoritzar, no retornar-ne els factors.
+        LinAlg::LUCache forged;
+        const LinAlg::MatrixKey key0 = LinAlg::HashMatrix(small[0], cfg.tol);
+        forged.Insert(key0, std::make_shared<const Matrix>(small[1]), std::make_shared<const LinAlg::LUFactors>(LinAlg::FactorizeLU(small[1], cfg.tol)));
+        bool found = forged.Find(small[0], cfg.tol) != nullptr;
+        auto rc = LinAlg::SolveCached(forged, small[0], bsmall, cfg.tol);
+        LinAlg::CacheStats cs = forged.Stats();
+        bool pass_col = !found && rc.rel_resid <= 1e-12 && cs.collisions == 2 && cs.hits == 0;
+        std::cout << "[Cache][Colisio] " << (pass_col ? G : R) << (pass_col ? "PASS" : "FAIL") << Z
+            << " col=" << cs.collisions << " rel=" << rc.rel_resid << "\n";
+        all_ok &= pass_col;
+    }
+
+    // ===== LowRank: A + U V^T via Woodbury sobre la LU d'A vs SolvePartialPivot complet =====
+    for (int n : ns) {
+        Matrix A(n, n); LoadMatrixBin("datasets/A_" + std::to_string(n) + ".bin", A); A.rows = n; A.cols = n;
+        Vec rhs; LoadVectorBin("datasets/rhs_" + std::to_string(n) + ".bin", rhs);
+        auto F = std::make_shared<const LinAlg::LUFactors>(LinAlg::FactorizeLU(A, cfg.tol));
+
+        const int k = cfg.lowrank_k;
+        std::mt19937 rng(99u + n);
+        std::uniform_real_distribution<double> U01(-0.1, 0.1);
+        Matrix Uk(n, k), Vk(n, k);
+        for (double& v : Uk.a) v = U01(rng);
+        for (double& v : Vk.a) v = U01(rng);
+
+        bool refac = false;
+        auto r_up = LinAlg::SolveUpdated(F, A, Uk, Vk, rhs, 1e8, 1e-8, &refac);
+
+        Matrix Aup = A;
+        for (int i = 0; i < n; ++i)
+            for (int j = 0; j < n; ++j)
+                for (int p = 0; p < k; ++p) Aup.a[(size_t)i * n + j] += Uk.a[(size_t)i * k + p] * Vk.a[(size_t)j * k + p];
+        auto r_full = LinAlg::SolvePartialPivot(Aup, rhs, cfg.tol);
+
+        double dx = rel_err_vec(r_up.x, r_full.x);
+        bool pass = !r_up.singular && !refac && r_up.rel_resid <= 1e-8 && dx <= 1e-8;
+        std::cout << "[LowRank][k=" << k << "][n=" << n << "] " << (pass ? G : R) << (pass ? "PASS" : "FAIL") << Z
+            << " rel=" << r_up.rel_resid << " dx=" << dx << " ms=" << r_up.ms << " fullMs=" << r_full.ms
+            << " speedup=" << (r_up.ms > 0 ? r_full.ms / r_up.ms : 0.0) << "\n";
+        all_ok &= pass;
+    }
+    {
+        // Actualitzaci que anulla la columna 0: I + V^T A^-1 U = 0 => s'ha de detectar i refactoritzar.
+        int n = ns.front();
+        Matrix A(n, n); LoadMatrixBin("datasets/A_" + std::to_string(n) + ".bin", A); A.rows = n; A.cols = n;
+        Vec rhs; LoadVectorBin("datasets/rhs_" + std::to_string(n) + ".bin", rhs);
+        auto F = std::make_shared<const LinAlg::LUFactors>(LinAlg::FactorizeLU(A, cfg.tol));
+        Matrix u(n, 1), v(n, 1);
+        for (int i = 0; i < n; ++i) u.a[(size_t)i] = -A.At((size_t)i, 0);
+        v.a[0] = 1.0;
+        bool refac = false;
+        auto r = LinAlg::SolveUpdated(F, A, u, v, rhs, 1e8, 1e-8, &refac);
+        bool pass = refac && r.singular;
+        std::cout << "[LowRank][Unsafe][n=" << n << "] " << (pass ? G : R) << (pass ? "PASS" : "FAIL") << Z << "\n";
+        all_ok &= pass;
+    }
+
+    // ===== Strassen: menys productes que n^3 i creixement de l'error contra C_n.bin =====
+    for (size_t t = 0; t < ns.size(); ++t) {
+        int n = ns[t];
+        Matrix A(n, n); LoadMatrixBin("datasets/A_" + std::to_string(n) + ".bin", A); A.rows = n; A.cols = n;
+        Matrix B(n, n); LoadMatrixBin("datasets/B_" + std::to_string(n) + ".bin", B); B.rows = n; B.cols = n;
+        Matrix Cref(n, n); LoadMatrixBin("datasets/C_" + std::to_string(n) + ".bin", Cref); Cref.rows = n; Cref.cols = n;
+
+        OpsCounter op; Timer tm; tm.Tic();
+        Matrix C = A.MultiplyStrassen(B, cfg.strassen_cutoff, &op);
+        double ms = tm.TocMs();
+        double rS = rel_err_mat(C, Cref);
+        double n3 = double(n) * n * n;
+        bool pass = rS <= cfg.strassen_tol && double(op.mul) < n3;
+        std::cout << "[Strassen][cut=" << cfg.strassen_cutoff << "][n=" << n << "] " << (pass ? G : R) << (pass ? "PASS" : "FAIL") << Z
+            << " mul/n^3=" << double(op.mul) / n3 << " add+sub/n^3=" << double(op.add + op.sub) / n3
+            << " relF=" << rS << " relF/eps=" << rS / DBL_EPSILON << " classicRelF=" << relF_classic[t] << " ms=" << ms << "\n";
+        all_ok &= pass;
+    }
+
+    // ===== Gemm/Gemv: alpha*op(A)*op(B) + beta*C sobre sortida preassignada =====
+    for (int n : ns) {
+        Matrix A(n, n); LoadMatrixBin("datasets/A_" + std::to_string(n) + ".bin", A); A.rows = n; A.cols = n;
+        Matrix B(n, n); LoadMatrixBin("datasets/B_" + std::to_string(n) + ".bin", B); B.rows = n; B.cols = n;
+        Matrix Cref(n, n); LoadMatrixBin("datasets/C_" + std::to_string(n) + ".bin", Cref); Cref.rows = n; Cref.cols = n;
+        Vec x; LoadVectorBin("datasets/x_" + std::to_string(n) + ".bin", x);
+        Vec yref; LoadVectorBin("datasets/y_" + std::to_string(n) + ".bin", yref);
+
+        Matrix C(n, n); OpsCounter op; Timer tm; tm.Tic();
+        LinAlg::Gemm(LinAlg::Trans::No, LinAlg::Trans::No, 1.0, A, B, 0.0, C, &op);
+        double ms = tm.TocMs();
+        double rNN = rel_err_mat(C, Cref);
+        bool ok_ops = op.mul == std::size_t(n) * n * n && op.add == std::size_t(n) * n * (n - 1);
+
+        // Fusionat: 2*A*B - Cref ha de tornar Cref.
+        Matrix Cf = Cref;
+        LinAlg::Gemm(LinAlg::Trans::No, LinAlg::Trans::No, 2.0, A, B, -1.0, Cf, nullptr);
+        double rF = rel_err_mat(Cf, Cref);
+
+        Vec y(n);
+        LinAlg::Gemv(LinAlg::Trans::No, 1.0, A, x, 0.0, y, nullptr);
+        double rV = rel_err_vec(y, yref);
+
+        // Versi amb fils: cada fil fa un bloc de files, el resultat ha de ser idntic bit a bit.
+        Matrix Cp(n, n); OpsCounter opp;
+        LinAlg::GemmParallel(LinAlg::Trans::No, LinAlg::Trans::No, 1.0, A, B, 0.0, Cp, 4, &opp);
+        bool par_eq = Cp.a == C.a && opp.mul == op.mul && opp.add == op.add;
+
+        bool pass = ok_ops && rNN <= 1e-12 && rF <= 1e-12 && rV <= 1e-12 && par_eq;
+        std::cout << "[Gemm][NN][n=" << n << "] " << (pass ? G : R) << (pass ? "PASS" : "FAIL") << Z
+            << " relF=" << rNN << " fusedRelF=" << rF << " gemvRel=" << rV << " parallelEq=" << par_eq << " ms=" << ms
+            << (ok_ops ? "" : " [ops!]") << "\n";
+        all_ok &= pass;
+    }
+    {
+        // Variants transposades contra la transposada explcita + Multiply.
+        int n = ns.front();
+        Matrix A(n, n); LoadMatrixBin("datasets/A_" + std::to_string(n) + ".bin", A); A.rows = n; A.cols = n;
+        Matrix B(n, n); LoadMatrixBin("datasets/B_" + std::to_string(n) + ".bin", B); B.rows = n; B.cols = n;
+        Vec x; LoadVectorBin("datasets/x_" + std::to_string(n) + ".bin", x);
+        Matrix At = transpose(A), Bt = transpose(B);
+
+        struct Case { const char* name; LinAlg::Trans ta, tb; Matrix ref; };
+        Case cases[] = {
+            { "TN", LinAlg::Trans::Yes, LinAlg::Trans::No, At.Multiply(B, nullptr) },
+            { "NT", LinAlg::Trans::No, LinAlg::Trans::Yes, A.Multiply(Bt, nullptr) },
+            { "TT", LinAlg::Trans::Yes, LinAlg::Trans::Yes, At.Multiply(Bt, nullptr) },
+        };
+        for (Case& c : cases) {
+            Matrix C(n, n); Timer tm; tm.Tic();
+            LinAlg::Gemm(c.ta, c.tb, 1.0, A, B, 0.0, C, nullptr);
+            double ms = tm.TocMs();
+            double r = rel_err_mat(C, c.ref);
+            bool pass = r <= 1e-12;
+            std::cout << "[Gemm][" << c.name << "][n=" << n << "] " << (pass ? G : R) << (pass ? "PASS" : "FAIL") << Z
+                << " relF=" << r << " ms=" << ms << "\n";
+            all_ok &= pass;
+        }
+
+        Vec y(n);
+        LinAlg::Gemv(LinAlg::Trans::Yes, 1.0, A, x, 0.0, y, nullptr);
+        double r = rel_err_vec(y, At.Multiply(x, nullptr));
+        bool pass = r <= 1e-12;
+        std::cout << "[Gemv][T][n=" << n << "] " << (pass ? G : R) << (pass ? "PASS" : "FAIL") << Z << " rel=" << r << "\n";
+        all_ok &= pass;
+    }
+
+    // ===== Trace: desglossament per fases i trams imbricats entre fils =====
+    {
+        int n = ns.front();
+        Matrix A(n, n); LoadMatrixBin("datasets/A_" + std::to_string(n) + ".bin", A); A.rows = n; A.cols = n;
+        Vec rhs; LoadVectorBin("datasets/rhs_" + std::to_string(n) + ".bin", rhs);
+
+        LinAlg::ClearTrace();
+        LinAlg::SetTracingEnabled(true);
+        auto r = LinAlg::SolvePartialPivot(A, rhs, cfg.tol);
+        {
+            std::mt19937 rng(7);
+            std::vector<Matrix> pool;
+            for (int m : { 64, 96, 128 }) pool.push_back(rand_dd_mat(m, rng));
+            LinAlg::ServiceConfig scfg; scfg.tol = cfg.tol; scfg.workers = 2;
+            LinAlg::SolveService svc(scfg);
+            std::vector<std::future<LinAlg::SolveReport>> futs;
+            for (int i = 0; i < 12; ++i) futs.push_back(svc.Submit(pool[(size_t)i % pool.size()], Vec(pool[(size_t)i % pool.size()].rows, 1.0)));
+            for (auto& f : futs) f.get();
+        }
+        LinAlg::SetTracingEnabled(false);
+        std::vector<LinAlg::TraceEvent> ev = LinAlg::CollectTrace();
+
+        // Les fases d'eliminaci han de quadrar amb el total (amb marge pel cost del cronmetre).
+        const LinAlg::PhaseTimes& ph = r.phases;
+        double inner = ph.pivot_ms + ph.swap_ms + ph.update_ms;
+        bool phases_ok = !r.singular && inner > 0.0 && inner <= ph.elimination_ms * 1.05 + 0.05
+            && ph.TotalMs() >= r.ms && ph.copy_ms >= 0.0 && ph.residual_ms > 0.0;
+
+        // Cada fase de la resoluci s filla directa del tram SolvePartialPivot, dins del seu interval.
+        const LinAlg::TraceEvent* root = nullptr;
+        for (const auto& e : ev) if (std::strcmp(e.name, "SolvePartialPivot") == 0) { root = &e; break; }
+        int children = 0;
+        std::vector<std::uint32_t> batch_tids;
+        for (const auto& e : ev) {
+            if (root && e.tid == root->tid && e.depth == root->depth + 1 && e.start_us >= root->start_us
+                && e.start_us + e.dur_us <= root->start_us + root->dur_us + 1.0) ++children;
+            if (std::strcmp(e.name, "SolveService::RunBatch") == 0 && std::find(batch_tids.begin(), batch_tids.end(), e.tid) == batch_tids.end())
+                batch_tids.push_back(e.tid);
+        }
+        bool pass = phases_ok && root && children == 5 && !batch_tids.empty();
+        std::cout << "[Trace][Phases][n=" << n << "] " << (pass ? G : R) << (pass ? "PASS" : "FAIL") << Z
+            << " copia=" << ph.copy_ms << " pivot=" << ph.pivot_ms << " swap=" << ph.swap_ms << " update=" << ph.update_ms
+            << " elim=" << ph.elimination_ms << " subst=" << ph.back_ms << " residu=" << ph.residual_ms
+            << " spans=" << ev.size() << " fills=" << children << " filsServei=" << batch_tids.size() << "\n";
+        all_ok &= pass;
+        LinAlg::ClearTrace();
+    }
+
+    // ===== Progress: fracci publicada pel kernel i cancellaci cooperativa des d'un altre fil =====
+    {
+        int n = ns.back();
+        Matrix A(n, n); LoadMatrixBin("datasets/A_" + std::to_string(n) + ".bin", A); A.rows = n; A.cols = n;
+        Vec rhs; LoadVectorBin("datasets/rhs_" + std::to_string(n) + ".bin", rhs);
+
+        LinAlg::ProgressToken tok;
+        auto full = LinAlg::SolvePartialPivot(A, rhs, cfg.tol, &tok);
+        bool pass_full = !full.cancelled && !full.singular && tok.Fraction() == 1.0;
+
+        // Cancellem quan el kernel ha passat d'un 10%: ha de sortir abans d'acabar i sense marcar singular.
+        tok.Reset();
+        auto fut = std::async(std::launch::async, [&] { return LinAlg::SolvePartialPivot(A, rhs, cfg.tol, &tok); });
+        while (tok.Fraction() < 0.1 && fut.wait_for(std::chrono::milliseconds(0)) != std::future_status::ready) std::this_thread::yield();
+        tok.Cancel();
+        auto cut = fut.get();
+        double at = tok.Fraction();
+        bool pass_cut = cut.cancelled && !cut.singular && cut.x.empty() && at < 1.0;
+
+        tok.Reset(); tok.Cancel();
+        Matrix C = A.Multiply(A, nullptr, &tok);
+        bool pass_mm = tok.Fraction() == 0.0;
+
+        bool pass = pass_full && pass_cut && pass_mm;
+        std::cout << "[Progress][Cancel][n=" << n << "] " << (pass ? G : R) << (pass ? "PASS" : "FAIL") << Z
+            << " full=" << pass_full << " cancelAt=" << at << " cancelled=" << cut.cancelled << " matmul=" << pass_mm << "\n";
+        all_ok &= pass;
+    }
+
+    // ===== Cond: estimador de kappa_1 (Hager/Higham) contra la inversa explcita, i creixement dels pivots =====
+    {
+        // kappa_1 exacte: ||A||_1 * ||A^-1||_1 amb la inversa sencera (O(n^3), noms per comparar).
+        auto exact_cond1 = [](const Matrix& M) {
+            LinAlg::LUFactors F = LinAlg::FactorizeLU(M, 0.0);
+            Matrix X(M.rows, M.rows);
+            for (std::size_t i = 0; i < M.rows; ++i) X.At(i, i) = 1.0;
+            LinAlg::SolveFactorized(F, X);
+            return LinAlg::Norm1(M) * LinAlg::Norm1(X);
+        };
+
+        std::mt19937 rng(2024);
+        std::uniform_real_distribution<double> U(-1.0, 1.0);
+        std::vector<std::pair<std::string, Matrix>> cases;
+        cases.emplace_back("DiagDom", rand_dd_mat(120, rng));
+        {
+            Matrix M(150, 150);
+            for (double& v : M.a) v = U(rng);
+            cases.emplace_back("Random", M);
+        }
+        {
+            Matrix H(9, 9);
+            for (std::size_t i = 0; i < 9; ++i) for (std::size_t j = 0; j < 9; ++j) H.At(i, j) = 1.0 / double(i + j + 1);
+            cases.emplace_back("Hilbert", H);
+        }
+        {
+            // Files escalades en 8 ordres de magnitud: mal condicionada per sense creixement.
+            Matrix M = rand_dd_mat(100, rng);
+            for (std::size_t i = 0; i < M.rows; ++i) for (std::size_t j = 0; j < M.cols; ++j) M.At(i, j) *= std::pow(10.0, 8.0 * double(i) / double(M.rows - 1));
+            cases.emplace_back("Scaled", M);
+        }
+        for (const auto& c : cases) {
+            const Matrix& M = c.second;
+            auto r = LinAlg::SolvePartialPivot(M, Vec(M.rows, 1.0), 1e-300);
+            double exact = exact_cond1(M);
+            double ratio = r.cond1 / exact;
+            // L'estimador s una cota inferior; a la prctica queda dins d'un factor 3.
+            bool pass = !r.singular && ratio <= 1.0 + 1e-8 && ratio >= 1.0 / 3.0 && r.pivot_growth >= 1.0 - 1e-12;
+            std::cout << "[Cond][" << c.first << "][n=" << M.rows << "] " << (pass ? G : R) << (pass ? "PASS" : "FAIL") << Z
+                << " est=" << r.cond1 << " exacte=" << exact << " rati=" << ratio << " creixement=" << r.pivot_growth
+                << " ms=" << r.phases.condition_ms << "\n";
+            all_ok &= pass;
+        }
+
+        // Matriu de Wilkinson: el pivotatge parcial dobla l'ltima columna a cada pas (creixement 2^(n-1)).
+        {
+            const std::size_t n = 30;
+            Matrix W(n, n);
+            for (std::size_t i = 0; i < n; ++i) {
+                for (std::size_t j = 0; j < i; ++j) W.At(i, j) = -1.0;
+                W.At(i, i) = 1.0;
+                W.At(i, n - 1) = 1.0;
+            }
+            auto r = LinAlg::SolvePartialPivot(W, Vec(n, 1.0), cfg.tol);
+            double expected = std::ldexp(1.0, int(n) - 1);
+            bool pass = !r.singular && std::abs(r.pivot_growth - expected) <= 1e-12 * expected;
+            std::cout << "[Cond][Growth][n=" << n << "] " << (pass ? G : R) << (pass ? "PASS" : "FAIL") << Z
+                << " creixement=" << r.pivot_growth << " esperat=" << expected << " kappa1=" << r.cond1 << " rel=" << r.rel_resid << "\n";
+            all_ok &= pass;
+        }
+    }
+
+    // ===== Pivot: estratgies sobre el mateix nucli d'eliminaci, argmax i reducci en arbre =====
+    {
+        // ArgMaxAbs contra un recorregut directe (amb empats: ha de tornar el primer).
+        std::mt19937 rng(99);
+        std::uniform_int_distribution<int> D(-20, 20);
+        bool argmax_ok = true;
+        for (std::size_t len : { std::size_t(1), std::size_t(3), std::size_t(17), std::size_t(1000) }) {
+            for (std::size_t stride : { std::size_t(1), std::size_t(5) }) {
+                Vec v(len * stride);
+                for (double& e : v) e = double(D(rng));
+                std::size_t ref = 0;
+                for (std::size_t i = 1; i < len; ++i) if (std::abs(v[i * stride]) > std::abs(v[ref * stride])) ref = i;
+                argmax_ok &= LinAlg::ArgMaxAbs(v.data(), len, stride) == ref;
+            }
+        }
+
+        int n = ns.front();
+        Matrix Az; LoadMatrixBin("datasets/A_zeropiv_" + std::to_string(n) + ".bin", Az); Az.rows = n; Az.cols = n;
+        Vec rhs_z; LoadVectorBin("datasets/rhs_zeropiv_" + std::to_string(n) + ".bin", rhs_z);
+
+        // Matriu de Wilkinson: el pivotatge parcial hi creix 2^(n-1); rook i complet no.
+        const std::size_t nw = 40;
+        Matrix W(nw, nw);
+        for (std::size_t i = 0; i < nw; ++i) {
+            for (std::size_t j = 0; j < i; ++j) W.At(i, j) = -1.0;
+            W.At(i, i) = 1.0;
+            W.At(i, nw - 1) = 1.0;
+        }
+
+        using PS = LinAlg::PivotStrategy;
+        for (PS s : { PS::None, PS::Partial, PS::ScaledPartial, PS::Rook, PS::Complete }) {
+            auto r = LinAlg::SolvePivoted(Az, rhs_z, cfg.tol, s);
+            auto w = LinAlg::SolvePivoted(W, Vec(nw, 1.0), cfg.tol, s);
+            bool pass_z = s == PS::None ? r.pivot_zero : (!r.singular && r.rel_resid <= 1e-8);
+            bool pass_w = s == PS::None || s == PS::Partial || s == PS::ScaledPartial ? true : w.pivot_growth <= 2.0;
+            bool pass = pass_z && pass_w && argmax_ok;
+            std::cout << "[Pivot][" << LinAlg::PivotStrategyName(s) << "][n=" << n << "] " << (pass ? G : R) << (pass ? "PASS" : "FAIL") << Z
+                << " rel=" << r.rel_resid << " ms=" << r.ms << " cmp=" << r.ops.cmp << " swp=" << r.ops.swp
+                << " creixementWilkinson=" << w.pivot_growth << " relWilkinson=" << w.rel_resid << "\n";
+            all_ok &= pass;
+        }
+
+        // En parallel (cerca completa amb reducci en arbre i actualitzaci per files) els pivots
+        // i la soluci han de ser idntics bit a bit als de la versi srie.
+        for (PS s : { PS::Partial, PS::Complete }) {
+            Timer t1; t1.Tic();
+            auto r1 = LinAlg::SolvePivoted(Az, rhs_z, cfg.tol, s, 1);
+            double ms1 = t1.TocMs();
+            Timer t4; t4.Tic();
+            auto r4 = LinAlg::SolvePivoted(Az, rhs_z, cfg.tol, s, 4);
+            double ms4 = t4.TocMs();
+            bool pass = !r1.singular && r1.x == r4.x;
+            std::cout << "[Pivot][" << LinAlg::PivotStrategyName(s) << "-par][n=" << n << "] " << (pass ? G : R) << (pass ? "PASS" : "FAIL") << Z
+                << " serie=" << ms1 << "ms fils4=" << ms4 << "ms identic=" << (r1.x == r4.x) << "\n";
+            all_ok &= pass;
+        }
+    }
+
+    // ===== QR: mnims quadrats amb Householder per blocs (WY compacte) i TSQR per blocs de files =====
+    {
+        std::mt19937 rng(4242);
+        std::normal_distribution<double> N(0.0, 1.0);
+        const std::size_t m = 4000, n = 60;
+        Matrix A(m, n);
+        for (double& v : A.a) v = N(rng);
+        Vec x_true(n);
+        for (double& v : x_true) v = N(rng);
+        Vec b = A.Multiply(x_true, nullptr);
+        Vec noisy = b;
+        for (double& v : noisy) v += 0.1 * N(rng);
+
+        // Blocs i sense blocs han de donar la mateixa factoritzaci (fins a arrodoniment).
+        LinAlg::QRFactors F1 = LinAlg::FactorizeQR(A, 1), F32 = LinAlg::FactorizeQR(A, 32);
+        double max_d = 0.0, max_r = 0.0;
+        for (std::size_t i = 0; i < F1.QR.a.size(); ++i) {
+            max_d = std::max(max_d, std::abs(F1.QR.a[i] - F32.QR.a[i]));
+            max_r = std::max(max_r, std::abs(F1.QR.a[i]));
+        }
+        bool pass_wy = max_d <= 1e-12 * max_r;
+        std::cout << "[QR][WY][" << m << "x" << n << "] " << (pass_wy ? G : R) << (pass_wy ? "PASS" : "FAIL") << Z
+            << " difBlocs=" << max_d / max_r << "\n";
+        all_ok &= pass_wy;
+
+        for (LinAlg::QRMethod method : { LinAlg::QRMethod::Householder, LinAlg::QRMethod::TSQR }) {
+            const char* name = method == LinAlg::QRMethod::TSQR ? "TSQR" : "Householder";
+            // Sistema compatible: x exacta i residu ~0.
+            auto rc = LinAlg::SolveLeastSquares(A, b, method, 4);
+            double err = rc.x.empty() ? INFINITY : rel_err_vec(rc.x, x_true);
+            // Amb soroll: el residu que dona Q^T b ha de coincidir amb ||Ax - b|| recalculat.
+            auto rn = LinAlg::SolveLeastSquares(A, noisy, method, 4);
+            double explicit_r = INFINITY;
+            if (!rn.x.empty()) {
+                Vec r = A.Multiply(rn.x, nullptr);
+                for (std::size_t i = 0; i < m; ++i) r[i] -= noisy[i];
+                explicit_r = LinAlg::L2Norm(r);
+            }
+            bool pass = !rc.rank_deficient && err <= 1e-12 && !rn.rank_deficient
+                && std::abs(rn.resid_norm - explicit_r) <= 1e-10 * explicit_r && rn.optimality <= 1e-12;
+            std::cout << "[QR][" << name << "][" << m << "x" << n << "] " << (pass ? G : R) << (pass ? "PASS" : "FAIL") << Z
+                << " errX=" << err << " resid=" << rn.resid_norm << " residExplicit=" << explicit_r
+                << " optimalitat=" << rn.optimality << " ms=" << rn.ms << "\n";
+            all_ok &= pass;
+        }
+
+        // Columnes dependents: s'ha de detectar el rang deficient.
+        Matrix D = A;
+        for (std::size_t i = 0; i < m; ++i) D.At(i, n - 1) = 2.0 * D.At(i, 0) - D.At(i, 1);
+        auto rd = LinAlg::SolveLeastSquares(D, b, LinAlg::QRMethod::TSQR, 4);
+        bool pass_rd = rd.rank_deficient && rd.x.empty();
+        std::cout << "[QR][RankDeficient][" << m << "x" << n << "] " << (pass_rd ? G : R) << (pass_rd ? "PASS" : "FAIL") << Z << "\n";
+        all_ok &= pass_rd;
+
+        // Progrs: sense cancellar arriba a 1 amb la mateixa x; cancellat, surt sense soluci.
+        LinAlg::ProgressToken tok;
+        auto rp = LinAlg::SolveLeastSquares(A, b, LinAlg::QRMethod::TSQR, 4, 1e-12, &tok);
+        const double frac = tok.Fraction();
+        tok.Cancel();
+        auto rx = LinAlg::SolveLeastSquares(A, b, LinAlg::QRMethod::TSQR, 4, 1e-12, &tok);
+        bool pass_tok = !rp.cancelled && frac == 1.0 && !rp.x.empty() && rel_err_vec(rp.x, x_true) <= 1e-12 && rx.cancelled && rx.x.empty();
+        std::cout << "[QR][Progress][" << m << "x" << n << "] " << (pass_tok ? G : R) << (pass_tok ? "PASS" : "FAIL") << Z << " fraccio=" << frac << "\n";
+        all_ok &= pass_tok;
+    }
+
+    // ===== Accum: productes escalars compensats i en doble-double davant d'una suma exacta coneguda =====
+    {
+        // Termes x[i] * y[i] exactes (enters de 26 bits escalats per potncies de 2) que es cancellen per
+        // parelles; la suma exacta es calcula en enters de 128 bits. Condicionament ~1e16: el pla perd
+        // totes les xifres i els modes compensats encara hi sn dins de la cota eps + (n eps)^2 cond.
+        std::mt19937_64 rng(4343);
+        std::uniform_int_distribution<long long> I(1, (1LL << 26) - 1);
+        std::uniform_int_distribution<int> E(0, 10);
+        const std::size_t half = 5000;
+        std::vector<std::pair<double, double>> terms;
+        __int128 exact = 0;
+        for (std::size_t i = 0; i < half; ++i) {
+            const long long a = I(rng), b = I(rng);
+            const int ea = E(rng), eb = E(rng);
+            terms.push_back({ std::ldexp(double(a), ea), std::ldexp(double(b), eb) });
+            terms.push_back({ -std::ldexp(double(a), ea), std::ldexp(double(b), eb) });
+        }
+        for (int i = 0; i < 16; ++i) {
+            const long long a = I(rng);
+            terms.push_back({ double(a), 1.0 });
+            exact += a;
+        }
+        std::shuffle(terms.begin(), terms.end(), rng);
+        Vec xs(terms.size()), ys(terms.size());
+        for (std::size_t i = 0; i < terms.size(); ++i) { xs[i] = terms[i].first; ys[i] = terms[i].second; }
+        const double ref = double(exact);
+
+        double err[4];
+        for (LinAlg::AccumMode mode : { LinAlg::AccumMode::Plain, LinAlg::AccumMode::Neumaier, LinAlg::AccumMode::Pairwise, LinAlg::AccumMode::DoubleDouble }) {
+            err[int(mode)] = std::abs(LinAlg::Dot(xs.data(), ys.data(), xs.size(), mode) - ref) / std::abs(ref);
+        }
+        // Neumaier i Dot2 recuperen el resultat (productes exactes); l'aritmtica plana no.
+        bool pass_dot = err[int(LinAlg::AccumMode::DoubleDouble)] <= 2 * DBL_EPSILON
+            && err[int(LinAlg::AccumMode::Neumaier)] <= 1e-10 && err[int(LinAlg::AccumMode::Plain)] > 1e-6;
+        std::cout << "[Accum][Dot][" << xs.size() << "] " << (pass_dot ? G : R) << (pass_dot ? "PASS" : "FAIL") << Z
+            << " errPlain=" << err[0] << " errNeumaier=" << err[1] << " errPairwise=" << err[2] << " errDD=" << err[3] << "\n";
+        all_ok &= pass_dot;
+
+        // Mat-vec ben condicionat: tots els modes coincideixen amb Matrix::Multiply fins a ~n eps i
+        // comptabilitzen les mateixes operacions nominals.
+        std::mt19937 rng2(4344);
+        std::normal_distribution<double> N(0.0, 1.0);
+        const int n = 800;
+        Matrix A = rand_dd_mat(n, rng2);
+        Vec xv(n);
+        for (double& v : xv) v = N(rng2);
+        Vec yp = A.Multiply(xv, nullptr);
+        double max_dev = 0.0;
+        for (LinAlg::AccumMode mode : { LinAlg::AccumMode::Neumaier, LinAlg::AccumMode::Pairwise, LinAlg::AccumMode::DoubleDouble }) {
+            OpsCounter op, op_plain;
+            Vec ym = LinAlg::MatVec(A, xv, mode, &op);
+            (void)A.Multiply(xv, &op_plain);
+            max_dev = std::max(max_dev, rel_err_vec(ym, yp));
+            if (op.mul != op_plain.mul || op.add != op_plain.add) max_dev = INFINITY;
+        }
+        // Residu d'una soluci de Gauss: el residu estable ha de ser del mateix ordre (o menor) que el pla.
+        auto rep = LinAlg::SolvePartialPivot(A, yp, 1e-12);
+        double res_plain = LinAlg::RelativeResidual(A, rep.x, yp, nullptr);
+        double res_dd = LinAlg::RelativeResidual(A, rep.x, yp, nullptr, LinAlg::AccumMode::DoubleDouble);
+        bool pass_mv = max_dev <= 1e-13 && std::isfinite(res_dd) && res_dd <= 10 * res_plain + 1e-15;
+        std::cout << "[Accum][MatVec][" << n << "] " << (pass_mv ? G : R) << (pass_mv ? "PASS" : "FAIL") << Z
+            << " desviacio=" << max_dev << " residuPla=" << res_plain << " residuDD=" << res_dd << "\n";
+        all_ok &= pass_mv;
+
+        // Cost de cada mode davant del producte escalar pla (mediana de 5 repeticions).
+        const std::size_t len = 1 << 20;
+        Vec u(len), w(len);
+        for (std::size_t i = 0; i < len; ++i) { u[i] = N(rng2); w[i] = N(rng2); }
+        double ms[4];
+        volatile double sink = 0.0;
+        for (LinAlg::AccumMode mode : { LinAlg::AccumMode::Plain, LinAlg::AccumMode::Neumaier, LinAlg::AccumMode::Pairwise, LinAlg::AccumMode::DoubleDouble }) {
+            std::vector<double> reps;
+            for (int r = 0; r < 5; ++r) {
+                Timer t; t.Tic();
+                sink = sink + LinAlg::Dot(u.data(), w.data(), len, mode);
+                reps.push_back(t.TocMs());
+            }
+            std::sort(reps.begin(), reps.end());
+            ms[int(mode)] = reps[2];
+        }
+        std::cout << "[Accum][Cost][" << len << "] plain=" << ms[0] << "ms";
+        for (int m = 1; m < 4; ++m) {
+            std::cout << " " << LinAlg::AccumModeName(LinAlg::AccumMode(m)) << "=" << ms[m] << "ms(x" << ms[m] / std::max(ms[0], 1e-9) << ")";
+        }
+        std::cout << "\n";
+    }
+
+    // ===== Det: determinant, log|det| i inversa a partir dels factors LU =====
+    {
+        // Cas petit amb intercanvi: det([[0, 2], [3, 1]]) = -6.
+        Matrix S(2, 2);
+        S.a = { 0.0, 2.0, 3.0, 1.0 };
+        LinAlg::LUFactors Fs = LinAlg::FactorizeLU(S, cfg.tol);
+        double det_s = LinAlg::Determinant(Fs);
+        bool pass_small = std::abs(det_s + 6.0) <= 1e-14;
+        std::cout << "[Det][2x2] " << (pass_small ? G : R) << (pass_small ? "PASS" : "FAIL") << Z << " det=" << det_s << "\n";
+        all_ok &= pass_small;
+
+        for (int n : ns) {
+            // Les matrius A_sing han de donar det = 0 (signe 0, log = -inf) tant des de la LU
+            // com des de l'informe del solver.
+            Matrix As; LoadMatrixBin("datasets/A_sing_" + std::to_string(n) + ".bin", As); As.rows = n; As.cols = n;
+            Vec rhs_s; LoadVectorBin("datasets/rhs_sing_" + std::to_string(n) + ".bin", rhs_s);
+            LinAlg::LUFactors Fz = LinAlg::FactorizeLU(As, cfg.tol);
+            LinAlg::LogDet dz = LinAlg::LogDeterminant(Fz);
+            auto rz = LinAlg::SolvePartialPivot(As, rhs_s, cfg.tol);
+            bool threw = false;
+            try { (void)LinAlg::Inverse(Fz); } catch (const std::invalid_argument&) { threw = true; }
+            bool pass_sing = dz.sign == 0 && std::isinf(dz.log_abs) && LinAlg::Determinant(Fz) == 0.0 && rz.det_sign == 0 && threw;
+            std::cout << "[Det][Singular][n=" << n << "] " << (pass_sing ? G : R) << (pass_sing ? "PASS" : "FAIL") << Z << "\n";
+            all_ok &= pass_sing;
+
+            // Matriu regular: log|det| coincideix entre LU parcial, pivotatge complet (una altra
+            // factoritzaci) i l'informe del solver; det(-A) = (-1)^n det(A).
+            Matrix A; LoadMatrixBin("datasets/A_" + std::to_string(n) + ".bin", A); A.rows = n; A.cols = n;
+            Vec rhs; LoadVectorBin("datasets/rhs_" + std::to_string(n) + ".bin", rhs);
+            LinAlg::LUFactors F = LinAlg::FactorizeLU(A, cfg.tol);
+            LinAlg::LogDet d = LinAlg::LogDeterminant(F);
+            auto rp = LinAlg::SolvePartialPivot(A, rhs, cfg.tol);
+            auto rc = LinAlg::SolvePivoted(A, rhs, cfg.tol, LinAlg::PivotStrategy::Complete);
+            Matrix An = A;
+            for (double& v : An.a) v = -v;
+            LinAlg::LogDet dn = LinAlg::LogDeterminant(LinAlg::FactorizeLU(An, cfg.tol));
+            const double tol_log = 1e-10 * std::max(1.0, std::abs(d.log_abs));
+            bool pass_det = d.sign != 0 && rp.det_sign == d.sign && rp.log_abs_det == d.log_abs
+                && rc.det_sign == d.sign && std::abs(rc.log_abs_det - d.log_abs) <= tol_log
+                && dn.sign == ((n % 2) ? -d.sign : d.sign) && std::abs(dn.log_abs - d.log_abs) <= tol_log;
+
+            // Inversa: ||A X - I||_max petit i mateix resultat amb 1 fil que amb 4.
+            Timer t1; t1.Tic();
+            Matrix X1 = LinAlg::Inverse(F, 64, 1);
+            double ms1 = t1.TocMs();
+            Timer t4; t4.Tic();
+            Matrix X4 = LinAlg::Inverse(F, 64, 4);
+            double ms4 = t4.TocMs();
+            Matrix AX = A.Multiply(X1, nullptr);
+            double max_e = 0.0;
+            for (int i = 0; i < n; ++i)
+                for (int j = 0; j < n; ++j) max_e = std::max(max_e, std::abs(AX.At(i, j) - (i == j ? 1.0 : 0.0)));
+            bool pass_inv = max_e <= 1e-10 && X1.a == X4.a;
+            bool pass = pass_det && pass_inv;
+            std::cout << "[Det][LogDet+Inverse][n=" << n << "] " << (pass ? G : R) << (pass ? "PASS" : "FAIL") << Z
+                << " sign=" << d.sign << " log|det|=" << d.log_abs << " difComplet=" << std::abs(rc.log_abs_det - d.log_abs)
+                << " maxErrAX=" << max_e << " ms(1 fil)=" << ms1 << " ms(4 fils)=" << ms4 << "\n";
+            all_ok &= pass;
+        }
+    }
+
+    // ===== Prefetch: crrega en canonada amb pressupost de memria =====
+    {
+        // Un treball per n amb A, B i C (3 n^2 doubles); pressupost per a dos treballs de n=800.
+        std::vector<std::vector<std::string>> jobs;
+        std::size_t largest = 0;
+        for (int n : ns) {
+            const std::string sn = std::to_string(n);
+            jobs.push_back({ "datasets/A_" + sn + ".bin", "datasets/B_" + sn + ".bin", "datasets/C_" + sn + ".bin" });
+            largest = std::max(largest, 3 * std::size_t(n) * n * sizeof(double));
+        }
+        jobs.push_back({ "datasets/A_" + std::to_string(ns[0]) + ".bin", "datasets/no_existeix.bin" });
+        LinAlg::PrefetchConfig pcfg;
+        pcfg.max_bytes = 2 * largest;
+        LinAlg::DatasetPrefetcher loader(jobs, pcfg);
+
+        bool same = true;
+        double compute_ms = 0.0;
+        LinAlg::PrefetchedJob job;
+        for (int n : ns) {
+            same &= loader.Next(job) && job.ok;
+            if (!job.ok) break;
+            for (std::size_t f = 0; f < 3; ++f) {
+                Matrix M; LoadMatrixBin(jobs[job.index][f], M);
+                same &= M.a == job.buffers[f];
+            }
+            // Clcul que se solapa amb la lectura del treball segent.
+            Matrix A = job.TakeMatrix(0, n, n), B = job.TakeMatrix(1, n, n);
+            Timer t; t.Tic();
+            Matrix C = A.Multiply(B, nullptr);
+            compute_ms += t.TocMs();
+        }
+        // L'ltim treball demana un fitxer inexistent: s'ha de marcar com a fallat sense aturar res
+        // i sense perdre els altres fitxers del treball.
+        bool missing_ok = loader.Next(job) && !job.ok && job.missing == std::vector<std::string>{ "datasets/no_existeix.bin" }
+            && job.loaded == std::vector<bool>{ true, false } && job.buffers[0].size() == std::size_t(ns[0]) * ns[0];
+        bool ended = !loader.Next(job);
+        LinAlg::PrefetchStats st = loader.Stats();
+        bool pass = same && missing_ok && ended && st.peak_bytes <= pcfg.max_bytes && st.jobs == jobs.size();
+        std::cout << "[Prefetch][Pipeline] " << (pass ? G : R) << (pass ? "PASS" : "FAIL") << Z
+            << " treballs=" << st.jobs << " MB=" << st.bytes / 1e6 << " picMB=" << st.peak_bytes / 1e6
+            << " pressupostMB=" << pcfg.max_bytes / 1e6 << " directes=" << st.direct_reads << " buffer=" << st.buffered_reads
+            << " lectura(ms)=" << st.load_ms << " espera(ms)=" << st.wait_ms << " calcul(ms)=" << compute_ms << "\n";
+        all_ok &= pass;
+    }
+
+    // ===== Compress: contenidor .lbz (byte-shuffle + codificaci per plans) sobre els datasets =====
+    {
+        const std::string tmp_dir = (std::filesystem::temp_directory_path() / "linalg_lbz").string();
+        const int n = ns.back();
+        const std::string sn = std::to_string(n);
+        struct Item { std::string name; std::size_t cols; };
+        const Item items[] = { { "A", std::size_t(n) }, { "B", std::size_t(n) }, { "C", std::size_t(n) }, { "A_sing", std::size_t(n) },
+            { "A_zeropiv", std::size_t(n) }, { "x", 1 }, { "rhs", 1 } };
+
+        auto row = [&](const std::string& name, const Matrix& M, const CompressOptions& opt, double max_rel_ok) {
+            const std::string path = tmp_dir + "/" + name + ".lbz";
+            CompressStats enc, dec;
+            Matrix back;
+            bool saved = SaveMatrixCompressed(path, M, opt, &enc);
+            bool loaded = saved && LoadMatrixCompressed(path, back, 0, &dec);
+            // Lectura crua de la mateixa quantitat de dades, com a referncia.
+            SaveMatrixBin(tmp_dir + "/raw.bin", M);
+            Timer tr; tr.Tic();
+            Matrix raw; LoadMatrixBin(tmp_dir + "/raw.bin", raw);
+            const double raw_ms = tr.TocMs();
+            double max_rel = 0.0;
+            bool exact = loaded && back.rows == M.rows && back.cols == M.cols && back.a.size() == M.a.size();
+            if (exact && max_rel_ok == 0.0) exact = std::memcmp(back.a.data(), M.a.data(), M.a.size() * sizeof(double)) == 0;
+            else if (exact) {
+                for (std::size_t i = 0; i < M.a.size(); ++i)
+                    if (M.a[i] != 0.0) max_rel = std::max(max_rel, std::abs(back.a[i] - M.a[i]) / std::abs(M.a[i]));
+                exact = max_rel <= max_rel_ok;
+            }
+            const double mb = enc.raw_bytes / 1e6;
+            std::cout << "[Compress][" << name << "][" << M.rows << "x" << M.cols << "] " << (exact ? G : R) << (exact ? "PASS" : "FAIL") << Z
+                << " ratio=" << enc.Ratio() << " codif(MB/s)=" << mb / std::max(enc.ms, 1e-6) * 1e3
+                << " descodif(MB/s)=" << mb / std::max(dec.ms, 1e-6) * 1e3 << " cru(MB/s)=" << mb / std::max(raw_ms, 1e-6) * 1e3;
+            if (max_rel_ok > 0.0) std::cout << " errRelMax=" << max_rel;
+            std::cout << "\n";
+            all_ok &= exact;
+        };
+
+        for (const Item& it : items) {
+            Matrix M; LoadMatrixBin("datasets/" + it.name + "_" + sn + ".bin", M);
+            M.cols = it.cols; M.rows = M.a.size() / it.cols;
+            row(it.name, M, CompressOptions{}, 0.0);
+        }
+
+        // Matriu de banda (semiamplada 8), gaireb tota zeros: hi dominen els plans esparsos.
+        std::mt19937 rng(4545);
+        std::uniform_real_distribution<double> U(-1.0, 1.0);
+        Matrix Bd(2000, 2000);
+        for (std::size_t i = 0; i < Bd.rows; ++i)
+            for (std::size_t j = (i > 8 ? i - 8 : 0); j <= std::min(Bd.cols - 1, i + 8); ++j) Bd.At(i, j) = U(rng);
+        row("Banda", Bd, CompressOptions{}, 0.0);
+
+        // Mode amb prdua: 24 bits de mantissa (precisi de float amb rang de double).
+        Matrix A; LoadMatrixBin("datasets/A_" + sn + ".bin", A); A.rows = n; A.cols = n;
+        CompressOptions lossy; lossy.mantissa_bits = 24;
+        row("A-24bits", A, lossy, std::ldexp(1.0, -24));
+
+        // Un fitxer trencat s'ha de rebutjar sense llegir fora del buffer.
+        const std::string bad = tmp_dir + "/A.lbz";
+        std::filesystem::resize_file(bad, std::filesystem::file_size(bad) - 100);
+        Matrix broken;
+        bool pass_bad = IsCompressedDataset(bad) && !LoadMatrixCompressed(bad, broken) && !IsCompressedDataset("datasets/A_" + sn + ".bin");
+        std::cout << "[Compress][Truncat] " << (pass_bad ? G : R) << (pass_bad ? "PASS" : "FAIL") << Z << "\n";
+        all_ok &= pass_bad;
+
+        // Un nombre de doubles que no omple l'ltima fila s'ha de rebutjar en tancar.
+        const std::string ragged = tmp_dir + "/ragged.lbz";
+        CompressedWriter w;
+        bool pass_rag = w.Open(ragged, 7);
+        w.Write(A.a.data(), 7 * 3 + 2);
+        pass_rag = pass_rag && !w.Close() && !std::filesystem::exists(ragged);
+        std::cout << "[Compress][FilaIncompleta] " << (pass_rag ? G : R) << (pass_rag ? "PASS" : "FAIL") << Z << "\n";
+        all_ok &= pass_rag;
+        std::error_code ec;
+        std::filesystem::remove_all(tmp_dir, ec);
+    }
+
+    // ===== Sym: emmagatzematge simtric empaquetat, SPMV, SYRK i Cholesky =====
+    {
+        std::mt19937 rng(4646);
+        std::normal_distribution<double> N(0.0, 1.0);
+        const std::size_t m = 1200, n = 600;
+        Matrix Bm(m, n);
+        for (double& v : Bm.a) v = N(rng);
+
+        // SYRK (A^T A i A A^T) contra Gemm amb la matriu sencera; 4 fils == 1 fil.
+        LinAlg::SymPacked G1(n), G4(n), H(m);
+        Timer ts; ts.Tic();
+        LinAlg::Syrk(LinAlg::Trans::Yes, 1.0, Bm, 0.0, G1, 1);
+        double syrk_ms = ts.TocMs();
+        LinAlg::Syrk(LinAlg::Trans::Yes, 1.0, Bm, 0.0, G4, 4);
+        LinAlg::Syrk(LinAlg::Trans::No, 1.0, Bm, 0.0, H, 4);
+        Matrix Gd(n, n), Hd(m, m);
+        Timer tg; tg.Tic();
+        LinAlg::Gemm(LinAlg::Trans::Yes, LinAlg::Trans::No, 1.0, Bm, Bm, 0.0, Gd);
+        double gemm_ms = tg.TocMs();
+        LinAlg::Gemm(LinAlg::Trans::No, LinAlg::Trans::Yes, 1.0, Bm, Bm, 0.0, Hd);
+        double eG = rel_err_mat(G1.ToDense(), Gd), eH = rel_err_mat(H.ToDense(), Hd);
+        bool pass_syrk = eG <= 1e-13 && eH <= 1e-13 && G1.ap == G4.ap;
+        std::cout << "[Sym][Syrk][" << m << "x" << n << "] " << (pass_syrk ? G : R) << (pass_syrk ? "PASS" : "FAIL") << Z
+            << " errAtA=" << eG << " errAAt=" << eH << " ms=" << syrk_ms << " msGemm=" << gemm_ms << "\n";
+        all_ok &= pass_syrk;
+
+        // SPMV contra el mat-vec dens; el triangle ocupa n(n+1)/2 doubles.
+        for (std::size_t i = 0; i < n; ++i) G1.At(i, i) += double(n);     // definida positiva i ben condicionada
+        Matrix Sd = G1.ToDense();
+        Vec xs(n);
+        for (double& v : xs) v = N(rng);
+        Vec ys(n, 1.0), yd = Sd.Multiply(xs, nullptr);
+        OpsCounter ops_sym, ops_dense;
+        Timer tv; tv.Tic();
+        LinAlg::Spmv(1.0, G1, xs, 0.0, ys, &ops_sym);
+        double spmv_ms = tv.TocMs();
+        (void)Sd.Multiply(xs, &ops_dense);
+        double ev = rel_err_vec(ys, yd);
+        bool pass_spmv = ev <= 1e-14 && ops_sym.mul == ops_dense.mul && ops_sym.add == ops_dense.add
+            && LinAlg::SymPacked::FromLower(Sd).ap == G1.ap && 2 * G1.ap.size() == n * (n + 1);
+        std::cout << "[Sym][Spmv][n=" << n << "] " << (pass_spmv ? G : R) << (pass_spmv ? "PASS" : "FAIL") << Z
+            << " err=" << ev << " KB=" << G1.ap.size() * sizeof(double) / 1024 << " KBdens=" << Sd.a.size() * sizeof(double) / 1024
+            << " ms=" << spmv_ms << "\n";
+        all_ok &= pass_spmv;
+
+        // Cholesky: mateixa soluci, determinant i condici (dues estimacions) que LU; sense creixement
+        // (max|L_jj L_ij| <= max a_ii); una matriu indefinida ha de fallar.
+        Vec rhs_s = yd;
+        auto rs = LinAlg::SolveSymmetric(G1, rhs_s, cfg.tol);
+        auto rl = LinAlg::SolvePartialPivot(Sd, rhs_s, cfg.tol);
+        double ex = rs.x.empty() ? INFINITY : rel_err_vec(rs.x, xs);
+        LinAlg::SymPacked Ind = G1;
+        Ind.At(n / 2, n / 2) = -1.0;
+        auto ri = LinAlg::SolveSymmetric(Ind, rhs_s, cfg.tol);
+        bool pass_chol = !rs.pivot_zero && rs.rel_resid <= 1e-13 && ex <= 1e-12 && rs.det_sign == 1
+            && std::abs(rs.log_abs_det - rl.log_abs_det) <= 1e-10 * std::abs(rl.log_abs_det) && ri.pivot_zero
+            && rs.cond1 >= rl.cond1 / 3.0 && rs.cond1 <= rl.cond1 * 3.0 && rs.pivot_growth > 0.0 && rs.pivot_growth <= 1.0 + 1e-12;
+        std::cout << "[Sym][Cholesky][n=" << n << "] " << (pass_chol ? G : R) << (pass_chol ? "PASS" : "FAIL") << Z
+            << " rel=" << rs.rel_resid << " errX=" << ex << " cond1=" << rs.cond1 << " (LU " << rl.cond1 << ") creixement=" << rs.pivot_growth
+            << " ms=" << rs.ms << " msLU=" << rl.ms << "\n";
+        all_ok &= pass_chol;
+    }
+
+    // ===== Dist: LU distribuda 2D bloc-cclica sobre un transport punt a punt =====
+    {
+        // Validaci contra SolvePartialPivot amb graelles 1x1, 1x2 i 2x2 (un fil per rang).
+        const std::size_t nb = 64;
+        for (std::size_t n : ns) {
+            const std::string sn = std::to_string(n);
+            Matrix A(n, n); LoadMatrixBin("datasets/A_" + sn + ".bin", A); A.rows = n; A.cols = n;
+            Vec rhs; LoadVectorBin("datasets/rhs_" + sn + ".bin", rhs);
+            auto ref = LinAlg::SolvePartialPivot(A, rhs, cfg.tol);
+            for (int P : { 1, 2, 4 }) {
+                LinAlg::DistSolveReport rep;
+                LinAlg::RunThreadRanks(P, [&](LinAlg::Transport& t) {
+                    auto D = LinAlg::DistMatrix::FromGlobal(A, nb, LinAlg::ProcessGrid::Square(t));
+                    auto r = LinAlg::DistSolvePartialPivot(std::move(D), rhs, cfg.tol, t);
+                    if (t.Rank() == 0) rep = std::move(r);
+                });
+                double ex = rep.x.empty() ? INFINITY : rel_err_vec(rep.x, ref.x);
+                bool pass = !rep.singular && ex <= 1e-10 && rep.rel_resid <= std::max(10.0 * ref.rel_resid, 1e-13);
+                std::cout << "[Dist][n=" << n << "][P=" << P << "] " << (pass ? G : R) << (pass ? "PASS" : "FAIL") << Z
+                    << " errX=" << ex << " rel=" << rep.rel_resid << " relRef=" << ref.rel_resid
+                    << " ms=" << rep.ms << " msRef=" << ref.ms << " KBenviats(rang0)=" << rep.bytes_sent / 1024 << "\n";
+                all_ok &= pass;
+            }
+        }
+
+        // Matriu singular: tots els rangs ho han de detectar (cap es pot quedar esperant).
+        {
+            const std::size_t n = ns.front();
+            Matrix As; LoadMatrixBin("datasets/A_sing_" + std::to_string(n) + ".bin", As); As.rows = n; As.cols = n;
+            Vec rhs_s; LoadVectorBin("datasets/rhs_sing_" + std::to_string(n) + ".bin", rhs_s);
+            int flagged = 0;
+            std::mutex mf;
+            LinAlg::RunThreadRanks(4, [&](LinAlg::Transport& t) {
+                auto D = LinAlg::DistMatrix::FromGlobal(As, nb, LinAlg::ProcessGrid::Square(t));
+                auto r = LinAlg::DistSolvePartialPivot(std::move(D), rhs_s, cfg.tol, t);
+                std::lock_guard<std::mutex> lock(mf);
+                flagged += r.singular ? 1 : 0;
+            });
+            bool pass = flagged == 4 && LinAlg::SolvePartialPivot(As, rhs_s, cfg.tol).singular;
+            std::cout << "[Dist][Singular][n=" << n << "] " << (pass ? G : R) << (pass ? "PASS" : "FAIL") << Z << "\n";
+            all_ok &= pass;
+        }
+
+        // 4 processos amb sockets a localhost: cada rang llegeix del .bin noms els seus blocs.
+        {
+            const std::size_t n = ns.back();
+            const std::string path = "datasets/A_" + std::to_string(n) + ".bin";
+            Matrix A(n, n); LoadMatrixBin(path, A); A.rows = n; A.cols = n;
+            Vec rhs; LoadVectorBin("datasets/rhs_" + std::to_string(n) + ".bin", rhs);
+            auto ref = LinAlg::SolvePartialPivot(A, rhs, cfg.tol);
+            const int port = 20000 + int(std::random_device{}() % 20000u);
+            double ms = 0.0;
+            int rc = LinAlg::SpawnRanks(4, [&](int rank) {
+                auto t = LinAlg::ConnectLocalSockets(rank, 4, port);
+                if (!t) return 2;
+                auto D = LinAlg::DistMatrix::Create(n, nb, LinAlg::ProcessGrid::Square(*t));
+                if (!LinAlg::LoadDistMatrixBin(path, D)) return 3;
+                auto r = LinAlg::DistSolvePartialPivot(std::move(D), rhs, cfg.tol, *t);
+                ms = r.ms;
+                return !r.singular && rel_err_vec(r.x, ref.x) <= 1e-10 ? 0 : 1;
+            });
+            if (rc == -1) {
+                std::cout << "[Dist][Processos] oms: SpawnRanks no disponible en aquesta plataforma\n";
+            }
+            else {
+                bool pass = rc == 0;
+                std::cout << "[Dist][Processos][sockets][n=" << n << "][P=4] " << (pass ? G : R) << (pass ? "PASS" : "FAIL") << Z
+                    << " ms(rang0)=" << ms << " msRef=" << ref.ms << "\n";
+                all_ok &= pass;
+            }
+        }
+
+        // Escalat fort (n fix) i feble (n^2 / P fix, n = 400 sqrt(P)) amb rangs en fils. Amb menys
+        // nuclis que rangs l'eficincia mesura sobretot el cost de la comunicaci.
+        auto dist_ms = [&](std::size_t n, int P, std::size_t& bytes) {
+            std::mt19937 rng(4848);
+            std::uniform_real_distribution<double> U(-1.0, 1.0);
+            Matrix A(n, n);
+            for (double& v : A.a) v = U(rng);
+            Vec rhs(n, 1.0);
+            double ms = 0.0;
+            bytes = 0;
+            std::mutex mb;
+            LinAlg::RunThreadRanks(P, [&](LinAlg::Transport& t) {
+                auto D = LinAlg::DistMatrix::FromGlobal(A, nb, LinAlg::ProcessGrid::Square(t));
+                auto r = LinAlg::DistSolvePartialPivot(std::move(D), rhs, cfg.tol, t);
+                std::lock_guard<std::mutex> lock(mb);
+                ms = std::max(ms, r.ms);
+                bytes += r.bytes_sent;
+            });
+            return ms;
+        };
+        std::cout << "[Dist][Escalat] fils maquina=" << std::thread::hardware_concurrency() << "\n";
+        double base_strong = 0.0, base_weak = 0.0;
+        for (int P : { 1, 2, 4 }) {
+            std::size_t bytes_s = 0, bytes_w = 0;
+            const std::size_t nw = std::size_t(std::lround(400.0 * std::sqrt(double(P))));
+            const double ms_s = dist_ms(800, P, bytes_s), ms_w = dist_ms(nw, P, bytes_w);
+            if (P == 1) { base_strong = ms_s; base_weak = ms_w; }
+            std::cout << "  P=" << P << " fort[n=800] ms=" << ms_s << " acceleracio=" << base_strong / ms_s
+                << " eficiencia=" << base_strong / (ms_s * P) << " MB=" << bytes_s / 1e6
+                << " | feble[n=" << nw << "] ms=" << ms_w << " eficiencia=" << base_weak * std::pow(double(nw) / 400.0, 3.0) / (ms_w * P)
+                << " MB=" << bytes_w / 1e6 << "\n";
+        }
+    }
+
+    // ===== PerfGate: veredicte de la porta de regressi amb mesures sinttiques =====
+    {
+        Bench::BenchStats base;
+        base.kernel = "Gemm"; base.n = 256; base.reps = 7;
+        base.min_ms = 10.0; base.median_ms = 11.0; base.p95_ms = 14.0; base.stddev_ms = 2.0;
+        Bench::GateConfig gc;
+        gc.threshold = cfg.gate_threshold; gc.noise_k = cfg.gate_noise_k; gc.max_factor = cfg.gate_max_factor;
+
+        // Mateixa mesura: passa. El doble de lent (tamb el p95) ha de fallar encara que la base
+        // i la mesura nova siguin molt sorolloses.
+        Bench::BenchStats slow = base;
+        slow.min_ms *= 2.0; slow.median_ms *= 2.0; slow.p95_ms *= 2.0; slow.stddev_ms *= 2.0;
+        Bench::BenchStats noisy_base = base;
+        noisy_base.stddev_ms = 8.0;     // soroll relatiu ~73%: sense sostre el llindar seria ~230%
+        Bench::GateVerdict same = Bench::CheckAgainstBaseline(base, base, gc);
+        Bench::GateVerdict twice = Bench::CheckAgainstBaseline(base, slow, gc);
+        Bench::GateVerdict twice_noisy = Bench::CheckAgainstBaseline(noisy_base, slow, gc);
+        bool pass = !same.regression && !same.faster && twice.regression && twice_noisy.regression
+            && twice_noisy.limit <= gc.max_factor * gc.threshold + 1e-12;
+        std::cout << "[PerfGate][Veredicte] " << (pass ? G : R) << (pass ? "PASS" : "FAIL") << Z
+            << " limit=" << twice.limit * 100.0 << "% limitSorollos=" << twice_noisy.limit * 100.0 << "%\n";
+        all_ok &= pass;
+    }
+
     return all_ok ? 0 : 1;
 }
\ No newline at end of file
@@ -0,0 +1,179 @@
+#include "BenchConfig.hpp"
+#include "BenchHarness.hpp"
+#include "Blas.hpp"
+#include "LinAlg.hpp"
+#include "Matrix.hpp"
+#include "Solve.hpp"
+#include "Symmetric.hpp"
+#include "Timer.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+static constexpr const char* G = "\x1b[32m", * R = "\x1b[31m", * Y = "\x1b[33m", * Z = "\x1b[0m";
+
+// Porta de regressió de rendiment: mesura un joc fix de kernels sobre matrius sintètiques
+// deterministes (no cal cap dataset) i el compara amb la línia base d'aquesta màquina,
+// perf_baselines/<host>.json. Si encara no n'hi ha, o amb --update, la mesura actual passa a ser
+// la línia base. Un kernel que sembla regressar es torna a mesurar amb el triple de repeticions
+// abans de fallar, perquè una interrupció puntual no trenqui el build. Retorna 1 si hi ha alguna regressió confirmada.
+struct GateArgs {
+    Bench::HarnessConfig h;
+    Bench::GateConfig g;
+    std::vector<int> sizes = { 256, 512 };
+    std::vector<std::string> kernels;   // buit => tots
+    std::string dir = "perf_baselines";
+    bool update = false;
+};
+
+static std::vector<std::string> split_list(const std::string& s) {
+    std::vector<std::string> out; std::stringstream ss(s); std::string tok;
+    while (std::getline(ss, tok, ',')) if (!tok.empty()) out.push_back(tok);
+    return out;
+}
+
+static bool parse_gate_args(int argc, char** argv, GateArgs& ga) {
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        auto next = [&](std::string& v) { if (i + 1 >= argc) return false; v = argv[++i]; return true; };
+        std::string v;
+        if (a == "--update") ga.update = true;
+        else if (a == "--baseline-dir" && next(v)) ga.dir = v;
+        else if (a == "--threshold" && next(v)) ga.g.threshold = std::atof(v.c_str());
+        else if (a == "--noise-k" && next(v)) ga.g.noise_k = std::atof(v.c_str());
+        else if (a == "--max-factor" && next(v)) ga.g.max_factor = std::atof(v.c_str());
+        else if (a == "--reps" && next(v)) ga.h.reps = std::atoi(v.c_str());
+        else if (a == "--warmup" && next(v)) ga.h.warmups = std::atoi(v.c_str());
+        else if (a == "--pin" && next(v)) ga.h.pin_cpu = std::atoi(v.c_str());
+        else if (a == "--sizes" && next(v)) { ga.sizes.clear(); for (auto& t : split_list(v)) ga.sizes.push_back(std::atoi(t.c_str())); }
+        else if (a == "--kernels" && next(v)) ga.kernels = split_list(v);
+        else { std::cerr << "Argument desconegut: " << a << "\n"; return false; }
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    BenchConfig cfg;
+    GateArgs ga;
+    ga.h.warmups = cfg.perf_warmups; ga.h.reps = cfg.gate_reps;
+    ga.g.threshold = cfg.gate_threshold; ga.g.noise_k = cfg.gate_noise_k; ga.g.max_factor = cfg.gate_max_factor;
+    if (!parse_gate_args(argc, argv, ga)) {
+        std::cerr << "Us: perf_gate [--update] [--baseline-dir perf_baselines] [--threshold 0.10] [--noise-k 3] [--max-factor 2]\n"
+            << "                 [--reps 7] [--warmup 1] [--pin cpu] [--sizes 256,512] [--kernels MatVec,...]\n";
+        return 2;
+    }
+    bool pinned = Bench::PinThisThread(ga.h.pin_cpu);
+    if (ga.h.pin_cpu >= 0 && !pinned) std::cerr << "Avis: no s'ha pogut fixar el fil a la CPU " << ga.h.pin_cpu << "\n";
+
+    Bench::RunInfo info = Bench::CollectRunInfo(ga.h);
+    const std::string path = Bench::BaselinePath(ga.dir, info.host);
+    std::map<std::pair<std::string, std::size_t>, Bench::BenchStats> ref;
+    bool have_base = false;
+    if (!ga.update && std::filesystem::exists(path)) {
+        Bench::RunInfo base_info;
+        std::vector<Bench::BenchStats> base;
+        if (!Bench::ReadJson(path, base_info, base)) { std::cerr << "No s'ha pogut llegir " << path << "\n"; return 2; }
+        if (base_info.compiler != info.compiler) {
+            std::cout << Y << "Avis: la linia base es d'un altre compilador (" << base_info.compiler << "); regenera-la amb --update" << Z << "\n";
+        }
+        for (const auto& s : base) ref[{ s.kernel, s.n }] = s;
+        have_base = true;
+    }
+
+    auto wanted = [&](const char* k) {
+        return ga.kernels.empty() || std::find(ga.kernels.begin(), ga.kernels.end(), k) != ga.kernels.end();
+    };
+
+    std::vector<Bench::BenchStats> results;
+    int regressions = 0, faster = 0, unmatched = 0;
+    for (int n : ga.sizes) {
+        const std::size_t un = std::size_t(n);
+        const double nn = double(n) * n, d = sizeof(double);
+
+        // Diagonal dominant: LU i Cholesky no depenen del pivotatge ni fallen per condicionament.
+        std::mt19937 rng(4949u + unsigned(n));
+        std::uniform_real_distribution<double> U(-1.0, 1.0);
+        Matrix A(un, un), B(un, un), C(un, un);
+        for (double& v : A.a) v = U(rng);
+        for (double& v : B.a) v = U(rng);
+        for (std::size_t i = 0; i < un; ++i) A.At(i, i) += double(n);
+        Vec x(un), rhs(un), y(un);
+        for (double& v : x) v = U(rng);
+        for (double& v : rhs) v = U(rng);
+        const LinAlg::SymPacked S = LinAlg::SymPacked::FromLower(A);
+
+        auto measure = [&](const char* name, double bytes, const std::function<void(OpsCounter*)>& body) {
+            if (!wanted(name)) return;
+            // Els kernels de microsegons es repeteixen dins de cada mostra fins a uns 2 ms: una
+            // sola crida queda per sota de la resolució útil del rellotge i del soroll del sistema.
+            Timer probe; probe.Tic();
+            body(nullptr);
+            const int inner = std::max(1, std::min(1000, int(2.0 / std::max(probe.TocMs(), 1e-4))));
+            auto batched = [&](OpsCounter* op) {
+                if (op) { body(op); return; }
+                for (int r = 0; r < inner; ++r) body(nullptr);
+            };
+            auto run = [&](const Bench::HarnessConfig& h, double fl) {
+                Bench::BenchStats st = Bench::Measure(name, un, bytes, batched, h, fl);
+                st.min_ms /= inner; st.median_ms /= inner; st.p95_ms /= inner; st.mean_ms /= inner; st.stddev_ms /= inner;
+                st.gflops *= inner; st.gbps *= inner;
+                return st;
+            };
+            Bench::BenchStats s = run(ga.h, -1.0);     // flops del comptador de la primera crida
+            auto it = ref.find({ name, un });
+            if (have_base && it != ref.end()) {
+                Bench::GateVerdict v = Bench::CheckAgainstBaseline(it->second, s, ga.g);
+                if (v.regression) {
+                    Bench::HarnessConfig longer = ga.h;
+                    longer.reps = 3 * std::max(1, ga.h.reps);
+                    Bench::BenchStats again = run(longer, s.flops);
+                    if (again.min_ms < s.min_ms) s = again;
+                    v = Bench::CheckAgainstBaseline(it->second, s, ga.g);
+                }
+                const char* tag = v.regression ? "FAIL" : "PASS";
+                const char* col = v.regression ? R : G;
+                std::cout << "[PerfGate][" << name << "][n=" << n << "] " << col << tag << Z
+                    << " GFLOP/s " << it->second.gflops << " -> " << s.gflops
+                    << " alentiment=" << v.slowdown * 100.0 << "% limit=" << v.limit * 100.0 << "%"
+                    << (v.faster ? " (mes rapid: regenera la linia base)" : "") << "\n";
+                regressions += v.regression ? 1 : 0;
+                faster += v.faster ? 1 : 0;
+            }
+            else {
+                std::cout << "[PerfGate][" << name << "][n=" << n << "] " << Y << "sense linia base" << Z
+                    << " GFLOP/s=" << s.gflops << " median=" << s.median_ms << "ms sd=" << s.stddev_ms << "\n";
+                ++unmatched;
+            }
+            results.push_back(s);
+        };
+
+        measure("MatVec", (nn + 2.0 * n) * d, [&](OpsCounter* op) { (void)A.Multiply(x, op); });
+        measure("Spmv", (nn / 2 + 2.0 * n) * d, [&](OpsCounter* op) { LinAlg::Spmv(1.0, S, x, 0.0, y, op); });
+        measure("Gemm", 3.0 * nn * d, [&](OpsCounter* op) { LinAlg::Gemm(LinAlg::Trans::No, LinAlg::Trans::No, 1.0, A, B, 0.0, C, op); });
+        measure("PartialPivot", 2.0 * nn * d, [&](OpsCounter* op) {
+            LinAlg::SolveReport r = LinAlg::SolvePartialPivot(A, rhs, cfg.tol); if (op) op->Merge(r.ops); });
+        measure("Cholesky", (nn / 2 + 2.0 * n) * d, [&](OpsCounter* op) {
+            LinAlg::SolveReport r = LinAlg::SolveSymmetric(S, rhs, cfg.tol); if (op) op->Merge(r.ops); });
+    }
+
+    // Primera execució a la màquina (o --update): desem la línia base i no hi ha res a comparar.
+    if (!have_base) {
+        std::error_code ec;
+        std::filesystem::create_directories(ga.dir, ec);
+        if (!Bench::WriteJson(path, info, results)) { std::cerr << "No s'ha pogut escriure " << path << "\n"; return 2; }
+        std::cout << "[PerfGate] linia base desada a " << path << " (" << results.size() << " mesures)\n";
+        return 0;
+    }
+    std::cout << "[PerfGate] regressions=" << regressions << " millores=" << faster << " sense_base=" << unmatched
+        << " llindar=" << ga.g.threshold * 100.0 << "% + " << ga.g.noise_k << " sd (max " << ga.g.max_factor * ga.g.threshold * 100.0
+        << "%)  base=" << path << "\n";
+    return regressions ? 1 : 0;
+}
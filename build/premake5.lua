@@ -13,6 +13,38 @@ newoption
     default = "auto"
 }
 
+newoption
+{
+    trigger = "headless",
+    description = "Generate only the linalg core library and the bench/dataset tools (no SDL3, ImGui or GLEW)"
+}
+
+newoption
+{
+    trigger = "march",
+    value = "ARCH",
+    description = "Target CPU for the linalg core and tools in Release (gcc/clang -march=ARCH, e.g. native, x86-64-v3)",
+    default = "native"
+}
+
+newoption
+{
+    trigger = "no_perf_gate",
+    description = "Build perf_gate without running it after each Release build"
+}
+
+newoption
+{
+    trigger = "linalg_kind",
+    value = "KIND",
+    description = "Build the linalg core as a static or shared library (shared only on Linux)",
+    allowed = {
+        { "static", "Static library" },
+        { "shared", "Shared library" }
+    },
+    default = "static"
+}
+
 function download_progress(total, current)
     local ratio = current / total
     ratio = math.min(math.max(ratio, 0), 1)
@@ -188,6 +220,21 @@ function platform_defines()
     filter{}
 end
 
+-- Per-target optimization for the compute code (linalg core and headless tools).
+function compute_optimization()
+    filter {"configurations:Release"}
+        optimize "Speed"
+        flags { "LinkTimeOptimization" }
+
+    filter {"configurations:Release", "toolset:gcc or toolset:clang"}
+        buildoptions {"-march=" .. _OPTIONS["march"]}
+
+    filter {"configurations:Release", "action:vs*"}
+        vectorextensions "AVX2"
+
+    filter{}
+end
+
 -- Configuration
 -- All external dependencies will be auto-downloaded if not present
 downloadSDL3 = true
@@ -231,13 +278,182 @@ workspace (workspaceName)
 
     targetdir "bin/%{cfg.buildcfg}/"
 
-if (downloadSDL3) then
+    if (_OPTIONS["headless"]) then
+        startproject "bench"
+    else
+        startproject(workspaceName)
+    end
+
+if (downloadSDL3 and not _OPTIONS["headless"]) then
     build_externals()
 end
 
-    startproject(workspaceName)
+    -- Core library: src/ + include/, no GUI dependencies
+    project "linalg"
+        kind "StaticLib"
+        location "build_files/"
+        targetdir "../bin/%{cfg.buildcfg}"
+
+        vpaths
+        {
+            ["Header Files/*"] = { "../include/**.h", "../include/**.hpp", "../src/**.h", "../src/**.hpp"},
+            ["Source Files/*"] = {"../src/**.c", "../src/**.cpp"},
+        }
+
+        files {
+            "../src/**.c",
+            "../src/**.cpp",
+            "../src/**.h",
+            "../src/**.hpp",
+            "../include/**.h",
+            "../include/**.hpp"
+        }
+
+        includedirs { "../src" }
+        includedirs { "../include" }
+
+        cdialect "C17"
+        cppdialect "C++17"
+        platform_defines()
+        compute_optimization()
+
+        filter { "system:linux", "options:linalg_kind=shared" }
+            kind "SharedLib"
+            pic "On"
+
+        filter "action:vs*"
+            defines{"_CRT_SECURE_NO_WARNINGS"}
+
+        filter "system:linux"
+            links {"pthread"}
+
+        filter{}
+
+    -- Headless correctness/performance bench (runs from the repository root: reads datasets/)
+    project "bench"
+        kind "ConsoleApp"
+        location "build_files/"
+        targetdir "../bin/%{cfg.buildcfg}"
+
+        filter "action:vs*"
+            debugdir "$(SolutionDir)"
+
+        filter{}
+
+        vpaths { ["Bench Files/*"] = {"../bench/main_bench.cpp"} }
+        files { "../bench/main_bench.cpp" }
+        includedirs { "../include" }
+        links { "linalg" }
+
+        cdialect "C17"
+        cppdialect "C++17"
+        platform_defines()
+        compute_optimization()
+
+        filter "action:vs*"
+            defines{"_CRT_SECURE_NO_WARNINGS"}
+
+        filter "system:linux"
+            links {"pthread", "m"}
+
+        filter{}
+
+    -- Dataset generator (writes datasets/)
+    project "generate_dataset"
+        kind "ConsoleApp"
+        location "build_files/"
+        targetdir "../bin/%{cfg.buildcfg}"
+
+        filter "action:vs*"
+            debugdir "$(SolutionDir)"
+
+        filter{}
+
+        vpaths { ["Bench Files/*"] = {"../bench/generate_dataset.cpp"} }
+        files { "../bench/generate_dataset.cpp" }
+        includedirs { "../include" }
+        links { "linalg" }
+
+        cdialect "C17"
+        cppdialect "C++17"
+        platform_defines()
+        compute_optimization()
+
+        filter "action:vs*"
+            defines{"_CRT_SECURE_NO_WARNINGS"}
+
+        filter "system:linux"
+            links {"pthread", "m"}
+
+        filter{}
+
+    -- Compares two `bench --perf --json` runs and flags regressions
+    project "bench_compare"
+        kind "ConsoleApp"
+        location "build_files/"
+        targetdir "../bin/%{cfg.buildcfg}"
+
+        filter "action:vs*"
+            debugdir "$(SolutionDir)"
+
+        filter{}
+
+        vpaths { ["Bench Files/*"] = {"../bench/bench_compare.cpp"} }
+        files { "../bench/bench_compare.cpp" }
+        includedirs { "../include" }
+        links { "linalg" }
+
+        cdialect "C17"
+        cppdialect "C++17"
+        platform_defines()
+        compute_optimization()
+
+        filter "action:vs*"
+            defines{"_CRT_SECURE_NO_WARNINGS"}
+
+        filter "system:linux"
+            links {"pthread", "m"}
+
+        filter{}
+
+    -- Performance regression gate: compares a fixed kernel set against perf_baselines/<host>.json
+    project "perf_gate"
+        kind "ConsoleApp"
+        location "build_files/"
+        targetdir "../bin/%{cfg.buildcfg}"
+
+        filter "action:vs*"
+            debugdir "$(SolutionDir)"
+
+        filter{}
+
+        vpaths { ["Bench Files/*"] = {"../bench/perf_gate.cpp"} }
+        files { "../bench/perf_gate.cpp" }
+        includedirs { "../include" }
+        links { "linalg" }
 
-    -- Main project (combined app + bench + core library)
+        cdialect "C17"
+        cppdialect "C++17"
+        platform_defines()
+        compute_optimization()
+
+        -- Runs after every Release link: the first run stores the baseline for this machine,
+        -- later runs fail the build on a confirmed regression.
+        if (not _OPTIONS["no_perf_gate"]) then
+            filter "configurations:Release"
+                postbuildcommands { "\"%{cfg.buildtarget.abspath}\" --baseline-dir ../../perf_baselines" }
+        end
+
+        filter "action:vs*"
+            defines{"_CRT_SECURE_NO_WARNINGS"}
+
+        filter "system:linux"
+            links {"pthread", "m"}
+
+        filter{}
+
+if (not _OPTIONS["headless"]) then
+    -- GUI application (SDL3 + ImGui + GLEW) on top of the linalg core
     project (workspaceName)
         kind "ConsoleApp"
         location "build_files/"
@@ -250,10 +466,7 @@ end
 
         vpaths 
         {
-            ["Header Files/*"] = { "../include/**.h", "../include/**.hpp", "../src/**.h", "../src/**.hpp"},
-            ["Source Files/*"] = {"../src/**.c", "../src/**.cpp"},
-            ["App Files/*"] = {"../app/**.cpp"},
-            ["Bench Files/*"] = {"../bench/**.cpp"},
+            ["App Files/*"] = {"../app/**.cpp", "../app/**.hpp"},
             ["ImGui Files/*"] = {
                 imgui_dir .. "/imgui*.cpp", 
                 imgui_dir .. "/imgui*.h",
@@ -263,14 +476,8 @@ end
         }
         
         files {
-            "../src/**.c", 
-            "../src/**.cpp", 
-            "../src/**.h", 
-            "../src/**.hpp", 
-            "../include/**.h", 
-            "../include/**.hpp",
             "../app/**.cpp",
-            "../bench/**.cpp",
+            "../app/**.hpp",
             -- ImGui core files
             imgui_dir .. "/imgui.cpp",
             imgui_dir .. "/imgui_demo.cpp",
@@ -287,13 +494,14 @@ end
             imgui_dir .. "/backends/imgui_impl_opengl3_loader.h"
         }
 
-        includedirs { "../src" }
         includedirs { "../include" }
         includedirs { sdl3_dir .. "/include" }
         includedirs { imgui_dir }
         includedirs { imgui_dir .. "/backends" }
         includedirs { glew_dir .. "/include" }
 
+        links { "linalg" }
+
         cdialect "C17"
         cppdialect "C++17"
         platform_defines()
@@ -330,4 +538,5 @@ end
         filter "system:linux"
             links {"pthread", "m", "dl", "rt", "X11"}
 
-        filter{}
\ No newline at end of file
+        filter{}
+end
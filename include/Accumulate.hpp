@@ -0,0 +1,29 @@
+#pragma once
+#include "Matrix.hpp"
+#include "OpsCounter.hpp"
+#include <cstddef>
+#include <string>
+
+namespace LinAlg
+{
+
+	// Com s'acumulen els productes escalars i les normes:
+	//  Plain			suma seqüencial en double (el comportament de sempre; error ~ n eps)
+	//  Neumaier		suma compensada (Kahan-Babuska-Neumaier) de cada producte; error ~ eps + n eps^2
+	//  Pairwise		sumes per blocs combinades en arbre; error ~ log2(n) eps, quasi al cost de Plain
+	//  DoubleDouble	Dot2 d'Ogita-Rump-Oishi: TwoProd (fma) + TwoSum, com si es calculés amb el doble de
+	//					precisió i s'arrodonís al final
+	// Els modes no Plain fan servir quatre carrils independents perquè el compilador els vectoritzi.
+	enum class AccumMode { Plain, Neumaier, Pairwise, DoubleDouble };
+
+	const char* AccumModeName(AccumMode m);
+	bool ParseAccumMode(const std::string& name, AccumMode& out);	// "plain", "neumaier", "pairwise", "dd"
+
+	// init + sum_i x[i] * y[i]. Amb init = -b[i] el residu b - A x es calcula sense perdre la cancel·lació
+	// entre (A x)[i] i b[i]. En mode Plain dona exactament el mateix que el bucle de Matrix::Multiply.
+	double Dot(const double* x, const double* y, std::size_t n, AccumMode mode, double init = 0.0);
+
+	// y = A x acumulant cada fila amb 'mode' (Plain delega a Matrix::Multiply). El comptador
+	// registra les operacions nominals del producte, no les extra de la compensació.
+	Vec MatVec(const Matrix& A, const Vec& x, AccumMode mode, OpsCounter* op = nullptr);
+}
\ No newline at end of file
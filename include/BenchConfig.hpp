@@ -15,4 +15,40 @@ struct BenchConfig
 
 	// numeric tolerance
 	double tol = 1e-12;
+
+	// synthetic load for SolveService
+	int svc_requests_per_client = 32;
+
+	// LU cache trace replay
+	int cache_trace_repeat = 4;
+	std::size_t cache_bytes = std::size_t(64) << 20;
+
+	// rank of the A + U V^T update
+	int lowrank_k = 4;
+
+	// Strassen-Winograd
+	std::size_t strassen_cutoff = 64;
+	double strassen_tol = 1e-10;
+
+	// --perf mode
+	int perf_warmups = 1;
+	int perf_reps = 5;
+
+	// --sweep mode (n grows geometrically; sizes whose runs would exceed the budget are skipped)
+	int sweep_min_n = 16;
+	int sweep_max_n = 8192;
+	double sweep_step = 1.41421356;
+	double sweep_budget_s = 2.0;
+	std::size_t sweep_mem_mb = 2048;
+
+	// perf_gate: per-machine baselines (perf_baselines/<host>.json); a kernel fails when its best
+	// time slows down by more than gate_threshold plus gate_noise_k relative standard deviations of
+	// the baseline (capped at gate_max_factor * gate_threshold) and its median exceeds the baseline p95
+	double gate_threshold = 0.10;
+	double gate_noise_k = 3.0;
+	double gate_max_factor = 2.0;
+	int gate_reps = 7;
+
+	// pipelined dataset loading (--perf reads the next size while the current one is measured)
+	std::size_t prefetch_mb = 256;
 };
\ No newline at end of file
@@ -0,0 +1,83 @@
+#pragma once
+#include "OpsCounter.hpp"
+#include "PerfCounters.hpp"
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace Bench
+{
+
+	struct HarnessConfig
+	{
+		int warmups = 2;
+		int reps = 10;
+		int pin_cpu = -1;		// < 0: no fixem el fil
+		bool hw_counters = false;	// mesura també cicles, instruccions i fallades de cache/TLB
+	};
+
+	// Resultat d'un kernel a una mida: estadístiques de les repeticions (ms) i rendiment
+	// derivat del comptador d'operacions (GFLOP/s) i dels bytes mínims que ha de moure (GB/s).
+	struct BenchStats
+	{
+		std::string kernel;
+		std::size_t n = 0;
+		int reps = 0;
+		double min_ms = 0.0, median_ms = 0.0, p95_ms = 0.0, mean_ms = 0.0, stddev_ms = 0.0;
+		double flops = 0.0, bytes = 0.0;
+		double gflops = 0.0, gbps = 0.0;
+		LinAlg::HwCounters hw;		// mitjana per repetició (hw.valid = false si no s'han mesurat)
+	};
+
+	struct RunInfo
+	{
+		std::string host;
+		std::string compiler;
+		std::string timestamp;
+		int warmups = 0, reps = 0, pin_cpu = -1;
+	};
+
+	bool PinThisThread(int cpu);
+	RunInfo CollectRunInfo(const HarnessConfig& cfg);
+
+	// body(op) s'executa una vegada amb comptador (fora del cronòmetre) per obtenir els flops,
+	// després 'warmups' vegades sense mesurar i 'reps' vegades cronometrades amb op = nullptr.
+	// Amb cfg.hw_counters, els comptadors hardware s'obren fora del cronòmetre de cada repetició.
+	// Si flops >= 0 es fa servir aquest valor i se salta la passada de comptatge (mides grans).
+	BenchStats Measure(const std::string& kernel, std::size_t n, double bytes,
+		const std::function<void(OpsCounter*)>& body, const HarnessConfig& cfg, double flops = -1.0);
+
+	// Sostres de la màquina per al roofline, mesurats en un sol fil (com els kernels):
+	// FMA independents en registres i el triad de STREAM (a = b + s*c) sobre vectors que no caben a la cache.
+	double MeasurePeakGflops(int reps = 5);
+	double MeasureStreamGbps(std::size_t doubles_per_array = std::size_t(1) << 23, int reps = 5);
+
+	// Porta de regressió contra una línia base desada per màquina. Un kernel regressa si el seu
+	// millor temps supera el de referència més del llindar, eixamplat segons el soroll relatiu
+	// de la línia base fins a max_factor * threshold, i a més la mediana nova és pitjor que el
+	// p95 de referència.
+	struct GateConfig
+	{
+		double threshold = 0.10;	// alentiment relatiu tolerat amb una línia base sense soroll
+		double noise_k = 3.0;		// desviacions típiques relatives de la base que s'hi sumen
+		double max_factor = 2.0;	// sostre del llindar eixamplat, en múltiples de threshold
+	};
+
+	struct GateVerdict
+	{
+		double slowdown = 0.0;		// millor temps nou / millor temps base - 1
+		double limit = 0.0;		// alentiment màxim acceptat per a aquesta parella de mesures
+		bool regression = false;
+		bool faster = false;		// millora clara: convé regenerar la línia base
+	};
+
+	GateVerdict CheckAgainstBaseline(const BenchStats& base, const BenchStats& cur, const GateConfig& cfg);
+
+	// <dir>/<host>.json, amb el nom de la màquina reduït a [A-Za-z0-9._-].
+	std::string BaselinePath(const std::string& dir, const std::string& host);
+
+	bool WriteJson(const std::string& path, const RunInfo& info, const std::vector<BenchStats>& results);
+	bool WriteCsv(const std::string& path, const std::vector<BenchStats>& results);
+	bool ReadJson(const std::string& path, RunInfo& info, std::vector<BenchStats>& results);
+}
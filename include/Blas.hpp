@@ -0,0 +1,23 @@
+#pragma once
+#include "Matrix.hpp"
+#include "OpsCounter.hpp"
+
+namespace LinAlg
+{
+
+	enum class Trans { No, Yes };
+
+	// C = alpha * op(A) * op(B) + beta * C, amb op(X) = X o X^T. C ha de tenir ja la mida
+	// correcta: no es reserva memòria ni es materialitza cap transposada.
+	// Si beta == 0, C s'ignora a l'entrada (no es propaguen NaN).
+	void Gemm(Trans ta, Trans tb, double alpha, const Matrix& A, const Matrix& B, double beta, Matrix& C, OpsCounter* op = nullptr);
+
+	// Gemm amb les files de C repartides entre 'threads' fils (0 => tots). Cada fil escriu un bloc
+	// disjunt de C, així que el resultat és idèntic al de Gemm. Amb ta == Trans::Yes les files de
+	// op(A) no són contigües i es delega a Gemm.
+	void GemmParallel(Trans ta, Trans tb, double alpha, const Matrix& A, const Matrix& B, double beta, Matrix& C,
+		std::size_t threads = 0, OpsCounter* op = nullptr);
+
+	// y = alpha * op(A) * x + beta * y.
+	void Gemv(Trans ta, double alpha, const Matrix& A, const Vec& x, double beta, Vec& y, OpsCounter* op = nullptr);
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include "Matrix.hpp"
+#include "OpsCounter.hpp"
+#include "Solve.hpp"
+#include <functional>
+
+namespace LinAlg
+{
+
+	// ||A||_1: màxima suma per columnes de |a_ij|.
+	double Norm1(const Matrix& A, OpsCounter* op = nullptr);
+
+	// Estimació de ||A^-1||_1 amb l'algorisme de Hager/Higham (el de LAPACK xLACN2) sobre els
+	// factors en format compacte de l'eliminació: L unitària sota la diagonal i U a sobre.
+	// Cada iteració és un parell de solucions triangulars amb A i amb A^T (O(n^2)); en calen
+	// 2-3 habitualment i 5 com a màxim. Els intercanvis de files només permuten les columnes
+	// de A^-1, que no canvien la norma 1, així que no cal el vector de pivots.
+	double EstimateInverseNorm1(const Matrix& LU, OpsCounter* op = nullptr);
+
+	// El mateix estimador sobre qualsevol factorització: 'solve' fa x <- A^-1 x i 'solve_t' x <- A^-T x.
+	double EstimateInverseNorm1(std::size_t n, const std::function<void(Vec&)>& solve, const std::function<void(Vec&)>& solve_t);
+
+	// kappa_1(A) ~ ||A||_1 * est(||A^-1||_1). Infinit si F és singular.
+	double EstimateCond1(const Matrix& A, const LUFactors& F, OpsCounter* op = nullptr);
+
+	// Factor de creixement dels pivots max|u_ij| / max|a_ij|. Amb pivotatge parcial sol quedar
+	// per sota de ~10; valors grans (el límit teòric és 2^(n-1)) indiquen pèrdua de precisió.
+	double PivotGrowth(const Matrix& A, const Matrix& LU);
+}
\ No newline at end of file
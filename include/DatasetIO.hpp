@@ -1,8 +1,60 @@
 #pragma once
 #include "Matrix.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
 #include <string>
+#include <vector>
 
 bool LoadMatrixBin(const std::string& path, Matrix& A);   // row-major doubles
 bool LoadVectorBin(const std::string& path, Vec& v);
 bool SaveMatrixBin(const std::string& path, const Matrix& A);
-bool SaveVectorBin(const std::string& path, const Vec& v);
\ No newline at end of file
+bool SaveVectorBin(const std::string& path, const Vec& v);
+
+// ---- Contenidor comprimit (.lbz) ----
+// Els doubles es parteixen en blocs de 'chunk_doubles'; dins de cada bloc els 8 bytes de cada
+// valor es reorganitzen en 8 plans (byte-shuffle) i cada pla es codifica amb el mètode més curt
+// d'entre: constant, esparsa (valor dominant + excepcions), diccionari empaquetat a k < 8 bits
+// per byte o cru. Exponents i signes queden en plans amb pocs valors diferents, que és d'on surt
+// el guany. Els blocs són independents: es descodifiquen en paral·lel directament sobre Matrix::a.
+struct CompressOptions
+{
+	int mantissa_bits = 52;		// 52 = sense pèrdua; menys arrodoneix la mantissa
+	std::size_t chunk_doubles = std::size_t(1) << 16;
+	std::size_t threads = 0;		// 0 => tots
+};
+
+struct CompressStats
+{
+	std::size_t raw_bytes = 0, stored_bytes = 0;
+	double ms = 0.0;
+	double Ratio() const { return stored_bytes ? double(raw_bytes) / double(stored_bytes) : 0.0; }
+};
+
+// Escriptura en streaming (p.ex. des de generate_dataset, bloc de files a bloc de files):
+// els blocs complets es codifiquen i s'escriuen a mesura que arriben; l'índex va al final.
+class CompressedWriter
+{
+public:
+	bool Open(const std::string& path, std::size_t cols, const CompressOptions& opt = {});
+	void Write(const double* p, std::size_t count);
+	bool Close(CompressStats* stats = nullptr);		// rows = doubles escrits / cols; false (i sense fitxer) si no és exacte
+
+private:
+	void Flush(bool final_chunk);
+
+	std::ofstream f_;
+	std::string path_;
+	CompressOptions opt_;
+	std::size_t cols_ = 1, count_ = 0, offset_ = 0;
+	std::vector<double> pending_;		// fins a 'lanes' blocs per codificar alhora
+	std::vector<std::uint64_t> index_;		// (offset, mida) de cada bloc
+	double ms_ = 0.0;
+	bool ok_ = false;
+};
+
+bool SaveMatrixCompressed(const std::string& path, const Matrix& A, const CompressOptions& opt = {}, CompressStats* stats = nullptr);
+bool SaveVectorCompressed(const std::string& path, const Vec& v, const CompressOptions& opt = {}, CompressStats* stats = nullptr);
+bool LoadMatrixCompressed(const std::string& path, Matrix& A, std::size_t threads = 0, CompressStats* stats = nullptr);
+bool LoadVectorCompressed(const std::string& path, Vec& v, std::size_t threads = 0, CompressStats* stats = nullptr);
+bool IsCompressedDataset(const std::string& path);
\ No newline at end of file
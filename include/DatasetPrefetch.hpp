@@ -0,0 +1,82 @@
+#pragma once
+#include "Matrix.hpp"
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace LinAlg
+{
+
+	struct PrefetchConfig
+	{
+		std::size_t max_bytes = std::size_t(256) << 20;	// buffers en cua + el treball lliurat al consumidor
+		std::size_t depth = 1;							// treballs llegits per endavant (1 = doble buffer)
+		bool direct_io = true;							// O_DIRECT si el sistema de fitxers ho admet
+	};
+
+	// Un treball carregat: un buffer per fitxer, en l'ordre en què s'han demanat. Un fitxer que
+	// no es pot llegir deixa el seu buffer buit però no impedeix llegir la resta del treball.
+	struct PrefetchedJob
+	{
+		std::size_t index = 0;
+		bool ok = false;			// tots els fitxers llegits
+		std::vector<bool> loaded;		// un per fitxer
+		std::vector<std::string> missing;	// camins que no s'han pogut llegir, en ordre
+		std::vector<Vec> buffers;
+		std::size_t bytes = 0;
+		double load_ms = 0.0;		// temps de lectura al fil d'E/S
+
+		// Mou el buffer i cap a una matriu rows x cols; llança std::invalid_argument si la mida no quadra.
+		Matrix TakeMatrix(std::size_t i, std::size_t rows, std::size_t cols);
+		Vec TakeVector(std::size_t i);
+	};
+
+	struct PrefetchStats
+	{
+		std::size_t jobs = 0, bytes = 0;
+		std::size_t direct_reads = 0, buffered_reads = 0;
+		std::size_t peak_bytes = 0;		// màxim de bytes retinguts alhora (cua + treball lliurat)
+		double load_ms = 0.0;			// lectura al fil d'E/S
+		double wait_ms = 0.0;			// temps que el consumidor ha estat bloquejat a Next()
+	};
+
+	// Carregador en canonada: un fil d'E/S llegeix els fitxers del treball següent mentre el
+	// consumidor calcula amb l'actual. La memòria retinguda (treballs en cua més el darrer lliurat,
+	// que es considera alliberat a la crida següent de Next) no supera max_bytes; un treball que
+	// sol ja hi excedeix es llegeix igualment, però només quan no n'hi ha cap altre retingut.
+	// Amb O_DIRECT la lectura passa per un buffer alineat i no omple la cache de pàgines; si el
+	// sistema de fitxers no ho admet (tmpfs, Windows) es fa una lectura seqüencial normal.
+	class DatasetPrefetcher
+	{
+	public:
+		explicit DatasetPrefetcher(std::vector<std::vector<std::string>> jobs, PrefetchConfig cfg = {});
+		~DatasetPrefetcher();
+
+		DatasetPrefetcher(const DatasetPrefetcher&) = delete;
+		DatasetPrefetcher& operator=(const DatasetPrefetcher&) = delete;
+
+		// Bloqueja fins que el treball següent és a punt; false quan ja s'han lliurat tots.
+		bool Next(PrefetchedJob& out);
+		PrefetchStats Stats() const;
+
+	private:
+		void Run();
+
+		std::vector<std::vector<std::string>> jobs_;
+		PrefetchConfig cfg_;
+
+		mutable std::mutex mtx_;
+		std::condition_variable cv_;
+		std::deque<PrefetchedJob> ready_;
+		std::size_t next_out_ = 0;
+		std::size_t held_bytes_ = 0;	// cua + treball lliurat
+		std::size_t lent_bytes_ = 0;
+		bool stop_ = false;
+		PrefetchStats stats_;
+		std::thread io_;
+	};
+}
\ No newline at end of file
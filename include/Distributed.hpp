@@ -0,0 +1,137 @@
+#pragma once
+#include "Matrix.hpp"
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace LinAlg
+{
+
+	// Canal punt a punt entre Size() rangs, a l'estil de MPI però només amb el que necessita
+	// el solver. Els missatges d'un mateix origen i etiqueta arriben en ordre, i Send no espera
+	// el receptor (el backend guarda el missatge), així que dos rangs es poden enviar alhora.
+	// Recv bloqueja fins que arriba el missatge i llança std::runtime_error si la mida no
+	// coincideix o si l'origen s'ha desconnectat.
+	class Transport
+	{
+	public:
+		virtual ~Transport() = default;
+		virtual int Rank() const = 0;
+		virtual int Size() const = 0;
+		virtual void Send(int dest, int tag, const void* data, std::size_t bytes) = 0;
+		virtual void Recv(int src, int tag, void* data, std::size_t bytes) = 0;
+
+		std::size_t BytesSent() const { return bytes_sent_; }
+		std::size_t MessagesSent() const { return messages_sent_; }
+
+	protected:
+		std::size_t bytes_sent_ = 0;
+		std::size_t messages_sent_ = 0;
+	};
+
+	// Backend de memòria compartida: tots els rangs viuen al mateix procés (un fil per rang) i
+	// els missatges es copien directament a la bústia del destinatari.
+	class LocalFabric
+	{
+	public:
+		explicit LocalFabric(int size);
+		~LocalFabric();
+		LocalFabric(const LocalFabric&) = delete;
+		LocalFabric& operator=(const LocalFabric&) = delete;
+
+		std::unique_ptr<Transport> Endpoint(int rank);
+
+		// Marca el rang com a desconnectat: qui n'esperi un missatge rebrà una excepció.
+		void Close(int rank);
+
+		struct State;
+
+	private:
+		std::shared_ptr<State> state_;
+	};
+
+	// Executa fn en 'size' fils, cadascun amb el seu extrem d'un LocalFabric. Si algun rang
+	// llança una excepció, els altres se n'assabenten en comptes de quedar bloquejats i la
+	// primera excepció es rellança aquí.
+	void RunThreadRanks(int size, const std::function<void(Transport&)>& fn);
+
+	// Backend de sockets TCP a 127.0.0.1: una connexió per parell de rangs, el rang r escolta a
+	// base_port + r. Cada connexió té un fil lector que buida el socket a la bústia, de manera
+	// que Send no es bloqueja encara que l'altre extrem també estigui enviant.
+	// nullptr si la malla no s'ha pogut establir dins de timeout_s, que fita tant els connect()
+	// als rangs més baixos com l'espera dels més alts (o si no hi ha sockets POSIX).
+	std::unique_ptr<Transport> ConnectLocalSockets(int rank, int size, int base_port, double timeout_s = 10.0);
+
+	// Executa fn(rang) en 'size' processos: el rang 0 és el procés que crida i la resta són
+	// fork() seus. Retorna 0 si tots els rangs acaben amb 0. Només POSIX; a la resta retorna -1
+	// sense executar res.
+	int SpawnRanks(int size, const std::function<int(int)>& fn);
+
+	// Graella de processos rows x cols; el rang r és la posició (r / cols, r % cols).
+	struct ProcessGrid
+	{
+		int rows = 1, cols = 1;
+		int myrow = 0, mycol = 0;
+
+		static ProcessGrid For(const Transport& t, int rows, int cols);
+		// La graella més quadrada possible amb rows <= cols.
+		static ProcessGrid Square(const Transport& t);
+		int RankOf(int r, int c) const { return r * cols + c; }
+	};
+
+	// Matriu n x n repartida en blocs nb x nb 2D cíclics: el bloc (I, J) és del procés
+	// (I mod rows, J mod cols). Cada rang guarda les seves files i columnes en ordre global en
+	// una Matrix local densa; grow / gcol en donen l'índex global.
+	struct DistMatrix
+	{
+		std::size_t n = 0, nb = 64;
+		ProcessGrid grid;
+		Matrix local;
+		std::vector<std::size_t> grow, gcol;
+
+		static DistMatrix Create(std::size_t n, std::size_t nb, const ProcessGrid& g);
+		// Cada rang en copia la seva part d'A (A ha d'estar sencera a tots els rangs).
+		static DistMatrix FromGlobal(const Matrix& A, std::size_t nb, const ProcessGrid& g);
+
+		// Els índexs globals de les files (o columnes) que té la posició p de P de la graella.
+		static std::vector<std::size_t> LocalIndices(std::size_t n, std::size_t nb, int p, int P);
+
+		// Recull la matriu sencera al rang 'root' (a la resta retorna una matriu buida).
+		Matrix Gather(Transport& t, int root = 0) const;
+	};
+
+	// Cada rang llegeix del .bin (n x n, row-major) només els trams dels seus blocs.
+	bool LoadDistMatrixBin(const std::string& path, DistMatrix& A);
+
+	// LU amb pivotatge parcial per blocs (panell, intercanvis, difusió de L i U, actualització
+	// del complement de Schur). El pivot de cada columna és el mateix que triaria
+	// EliminatePivoted (màxim en valor absolut, el de fila més baixa si n'hi ha d'iguals).
+	// piv queda replicat a tots els rangs. Retorna false (a tots els rangs) si algun pivot
+	// |a_kk| <= tol.
+	bool DistFactorizeLU(DistMatrix& A, std::vector<std::size_t>& piv, double tol, Transport& t);
+
+	// Resol LU x = P b amb b replicat a tots els rangs; en acabar, b conté x a tots els rangs.
+	void DistSolveFactorized(const DistMatrix& LU, const std::vector<std::size_t>& piv, Vec& b, Transport& t);
+
+	// ||A x - b||_2 / ||b||_2 amb A distribuïda i x, b replicats.
+	double DistRelativeResidual(const DistMatrix& A, const Vec& x, const Vec& b, Transport& t);
+
+	struct DistSolveReport
+	{
+		std::size_t n = 0;
+		bool singular = false;
+		Vec x;				// replicat a tots els rangs
+		double rel_resid = 0.0;
+		double ms = 0.0;		// factorització + substitucions
+		double factor_ms = 0.0;
+		double solve_ms = 0.0;
+		std::size_t bytes_sent = 0;	// d'aquest rang
+		std::size_t messages = 0;
+	};
+
+	// Equivalent distribuït de SolvePartialPivot: tots els rangs hi han d'entrar amb la seva
+	// part d'A i el mateix b.
+	DistSolveReport DistSolvePartialPivot(DistMatrix A, Vec b, double tol, Transport& t);
+}
\ No newline at end of file
@@ -0,0 +1,90 @@
+#pragma once
+#include "Matrix.hpp"
+#include "Solve.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace LinAlg
+{
+
+	// Empremta de 128 bits del contingut d'A (dues llavors independents en una sola passada).
+	struct MatrixKey
+	{
+		std::uint64_t h0 = 0, h1 = 0;
+		std::size_t rows = 0, cols = 0;
+		double tol = 0.0;
+
+		bool operator==(const MatrixKey& o) const
+		{
+			return h0 == o.h0 && h1 == o.h1 && rows == o.rows && cols == o.cols && tol == o.tol;
+		}
+	};
+
+	MatrixKey HashMatrix(const Matrix& A, double tol);
+
+	struct CacheStats
+	{
+		std::size_t hits = 0, misses = 0, evictions = 0;
+		std::size_t collisions = 0;	// empremta igual però contingut diferent (compten també com a fallada)
+		std::size_t entries = 0, bytes = 0;
+	};
+
+	// Diagnòstics que només depenen d'A i dels seus factors: es calculen un cop, quan es factoritza,
+	// i es guarden amb l'entrada perquè un encert els pugui retornar sense refer-los.
+	struct FactorInfo
+	{
+		double cond1 = 0.0;			// EstimateCond1 (0 si A és singular)
+		double pivot_growth = 0.0;	// PivotGrowth
+	};
+
+	// Cache LRU de factoritzacions PA = LU fitada per memòria. Cada entrada guarda també una còpia
+	// d'A: l'empremta només tria el candidat i l'encert es confirma comparant el contingut, de
+	// manera que una col·lisió de hash no pot retornar mai la factorització d'una altra matriu.
+	// La còpia compta dins del pressupost de bytes.
+	class LUCache
+	{
+	public:
+		explicit LUCache(std::size_t max_bytes = std::size_t(256) << 20);
+
+		std::shared_ptr<const LUFactors> Find(const Matrix& A, double tol, FactorInfo* info = nullptr);
+		std::shared_ptr<const LUFactors> GetOrFactorize(const Matrix& A, double tol, OpsCounter* op = nullptr, bool* hit = nullptr,
+			FactorInfo* info = nullptr);
+		void Insert(const MatrixKey& key, std::shared_ptr<const Matrix> A, std::shared_ptr<const LUFactors> F, const FactorInfo& info = {});
+
+		CacheStats Stats() const;
+		void Clear();
+		std::size_t MaxBytes() const { return max_bytes_; }
+
+	private:
+		struct KeyHash
+		{
+			std::size_t operator()(const MatrixKey& k) const { return std::size_t(k.h0 ^ (k.h1 * 0x9E3779B97F4A7C15ull)); }
+		};
+		struct Entry
+		{
+			MatrixKey key;
+			std::shared_ptr<const Matrix> A;
+			std::shared_ptr<const LUFactors> F;
+			FactorInfo info;
+			std::size_t bytes = 0;
+		};
+
+		// Cerca per empremta i confirma el contingut fora del mutex (la comparació és O(n^2)).
+		std::shared_ptr<const LUFactors> Lookup(const MatrixKey& key, const Matrix& A, FactorInfo* info);
+		void EvictToFit();												// crida amb mtx_ bloquejat
+
+		std::size_t max_bytes_;
+		mutable std::mutex mtx_;
+		std::list<Entry> lru_;	// davant: el més recent
+		std::unordered_map<MatrixKey, std::list<Entry>::iterator, KeyHash> index_;
+		CacheStats stats_;
+	};
+
+	// Com SolvePartialPivot però reutilitzant la factorització si A ja és a la cache: O(n^2) en un encert,
+	// amb cond1 i pivot_growth guardats a l'entrada.
+	SolveReport SolveCached(LUCache& cache, const Matrix& A, Vec b, double tol);
+}
@@ -1,9 +1,13 @@
 #pragma once
+#include "Accumulate.hpp"
 #include "Matrix.hpp"
 #include "OpsCounter.hpp"
 
 namespace LinAlg 
 {
-	double L2Norm(const Vec& v, OpsCounter* op = nullptr);  // TODO (Ex2)
-	double RelativeResidual(const Matrix& A, const Vec& x, const Vec& b, OpsCounter* op = nullptr); // TODO (Ex2)
+	// 'mode' tria com s'acumulen les sumes (vegeu Accumulate.hpp); Plain manté el càlcul clàssic.
+	// En els altres modes el residu b - Ax es forma fila a fila dins del mateix acumulador.
+	double L2Norm(const Vec& v, OpsCounter* op = nullptr, AccumMode mode = AccumMode::Plain);  // TODO (Ex2)
+	double RelativeResidual(const Matrix& A, const Vec& x, const Vec& b, OpsCounter* op = nullptr,
+		AccumMode mode = AccumMode::Plain); // TODO (Ex2)
 }
\ No newline at end of file
@@ -0,0 +1,34 @@
+#pragma once
+#include "Matrix.hpp"
+#include "OpsCounter.hpp"
+#include "Solve.hpp"
+#include <memory>
+
+namespace LinAlg
+{
+
+	// Actualització de rang k (A + U V^T) sobre una factorització PA = LU existent,
+	// via Sherman-Morrison-Woodbury:
+	//   (A + U V^T)^-1 b = y - Z (I + V^T Z)^-1 V^T y,   amb y = A^-1 b i Z = A^-1 U.
+	struct RankUpdate
+	{
+		std::shared_ptr<const LUFactors> base;	// factorització d'A
+		Matrix U, V;							// n x k
+		Matrix Z;								// A^-1 U (n x k)
+		LUFactors cap;							// I + V^T Z (k x k)
+		double cap_cond = 0.0;					// cond_1 de la matriu de capacitat
+
+		// Si l'actualització no és numèricament segura es refactoritza A + U V^T des de zero.
+		std::shared_ptr<const LUFactors> full;
+		bool refactored = false;
+	};
+
+	RankUpdate UpdateLowRank(std::shared_ptr<const LUFactors> F, const Matrix& A, const Matrix& U, const Matrix& V,
+		double max_cond = 1e8, OpsCounter* op = nullptr);
+	void SolveLowRank(const RankUpdate& W, Vec& b, OpsCounter* op = nullptr);
+
+	// Resolució d'un sol terme independent amb informe; el residu es calcula contra A + U V^T i,
+	// si supera max_resid, es descarta Woodbury i es torna a factoritzar.
+	SolveReport SolveUpdated(std::shared_ptr<const LUFactors> F, const Matrix& A, const Matrix& U, const Matrix& V,
+		Vec b, double max_cond = 1e8, double max_resid = 1e-8, bool* refactored = nullptr);
+}
@@ -5,6 +5,8 @@
 
 using Vec = std::vector<double>;
 
+namespace LinAlg { class ProgressToken; }
+
 struct Matrix 
 {
     std::size_t rows = 0, cols = 0;
@@ -20,7 +22,12 @@ struct Matrix
     double  At(std::size_t i, std::size_t j) const;      // TODO (Ex1)
 
     Vec    Multiply(const Vec& x, OpsCounter* op = nullptr) const;       // TODO (Ex1)
-    Matrix Multiply(const Matrix& B, OpsCounter* op = nullptr) const;    // TODO (Ex1)
+    Matrix Multiply(const Matrix& B, OpsCounter* op = nullptr,
+                    LinAlg::ProgressToken* progress = nullptr) const;   // TODO (Ex1); progrés/cancel·lació per files
+
+    // Strassen-Winograd (7 productes per nivell) per a matrius quadrades grans; per sota de
+    // 'cutoff' s'usa un nucli per blocs. Els 7 subproductes del primer nivell van en paral·lel.
+    Matrix MultiplyStrassen(const Matrix& B, std::size_t cutoff = 128, OpsCounter* op = nullptr) const;
 
     Vec operator*(const Vec& x) const 
     { 
@@ -39,4 +39,11 @@ struct OpsCounter
 	{ 
 		swp += k; 
 	}
+
+	// Acumula un comptador parcial (p.ex. el d'un fil de treball).
+	void Merge(const OpsCounter& o)
+	{
+		add += o.add; sub += o.sub; mul += o.mul;
+		div_ += o.div_; cmp += o.cmp; swp += o.swp;
+	}
 };
\ No newline at end of file
@@ -0,0 +1,119 @@
+#pragma once
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace LinAlg
+{
+
+	inline std::size_t HardwareThreads()
+	{
+		return std::max<std::size_t>(1, std::thread::hardware_concurrency());
+	}
+
+	// Reparteix [0, count) en blocs contigus entre 'threads' fils (0 => tots els disponibles).
+	// fn(i) s'executa exactament un cop per índex; el fil que crida també treballa.
+	template <class Fn>
+	void ParallelFor(std::size_t count, Fn&& fn, std::size_t threads = 0)
+	{
+		if (count == 0) return;
+		std::size_t t = std::min(count, threads ? threads : HardwareThreads());
+		if (t <= 1) {
+			for (std::size_t i = 0; i < count; ++i) fn(i);
+			return;
+		}
+
+		auto run = [&](std::size_t w) {
+			std::size_t begin = count * w / t, end = count * (w + 1) / t;
+			for (std::size_t i = begin; i < end; ++i) fn(i);
+		};
+
+		std::vector<std::thread> pool;
+		pool.reserve(t - 1);
+		for (std::size_t w = 1; w < t; ++w) pool.emplace_back(run, w);
+		run(0);
+		for (std::thread& th : pool) th.join();
+	}
+
+	// Fils persistents per a bucles paral·lels curts que es repeteixen molts cops (p. ex. un per
+	// pas d'eliminació): es creen un cop i cada Run reparteix [0, count) en els mateixos blocs
+	// contigus que ParallelFor, sense crear i unir fils a cada crida. El fil que crida també treballa.
+	class WorkerPool
+	{
+	public:
+		explicit WorkerPool(std::size_t threads = 0) : size_(threads ? threads : HardwareThreads())
+		{
+			for (std::size_t w = 1; w < size_; ++w) workers_.emplace_back([this, w] { Loop(w); });
+		}
+
+		~WorkerPool()
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_);
+				stop_ = true;
+				++gen_;
+			}
+			wake_.notify_all();
+			for (std::thread& th : workers_) th.join();
+		}
+
+		WorkerPool(const WorkerPool&) = delete;
+		WorkerPool& operator=(const WorkerPool&) = delete;
+
+		std::size_t Size() const { return size_; }
+
+		// fn(w, begin, end) per a cada bloc w; torna quan tots els blocs han acabat.
+		void Run(std::size_t count, const std::function<void(std::size_t, std::size_t, std::size_t)>& fn)
+		{
+			if (count == 0) return;
+			const std::size_t t = std::min(count, size_);
+			if (t <= 1) {
+				fn(0, 0, count);
+				return;
+			}
+			{
+				std::lock_guard<std::mutex> lock(m_);
+				job_ = &fn;
+				count_ = count;
+				parts_ = t;
+				pending_ = t - 1;
+				++gen_;
+			}
+			wake_.notify_all();
+			fn(0, 0, count / t);
+			std::unique_lock<std::mutex> lock(m_);
+			done_.wait(lock, [&] { return pending_ == 0; });
+		}
+
+	private:
+		void Loop(std::size_t w)
+		{
+			std::size_t seen = 0;
+			std::unique_lock<std::mutex> lock(m_);
+			for (;;) {
+				wake_.wait(lock, [&] { return gen_ != seen; });
+				seen = gen_;
+				if (stop_) return;
+				if (w >= parts_) continue;	// aquesta ronda té menys blocs que fils
+				const auto* job = job_;
+				const std::size_t c = count_, p = parts_;
+				lock.unlock();
+				(*job)(w, c * w / p, c * (w + 1) / p);
+				lock.lock();
+				if (--pending_ == 0) done_.notify_one();
+			}
+		}
+
+		std::size_t size_;
+		std::vector<std::thread> workers_;
+		std::mutex m_;
+		std::condition_variable wake_, done_;
+		const std::function<void(std::size_t, std::size_t, std::size_t)>* job_ = nullptr;
+		std::size_t count_ = 0, parts_ = 0, pending_ = 0, gen_ = 0;
+		bool stop_ = false;
+	};
+}
\ No newline at end of file
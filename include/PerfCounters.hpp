@@ -0,0 +1,70 @@
+#pragma once
+#include <cstdint>
+#include <optional>
+
+namespace LinAlg
+{
+
+	// Comptadors hardware d'un tram de codi (perf_event_open a Linux).
+	// 'valid' és fals si el sistema no els ofereix (altres SO, VM sense PMU, perf_event_paranoid...).
+	struct HwCounters
+	{
+		bool valid = false;
+		std::uint64_t cycles = 0, instructions = 0;
+		std::uint64_t l1d_misses = 0, llc_misses = 0, dtlb_misses = 0, branch_misses = 0;
+
+		void Merge(const HwCounters& o)
+		{
+			if (!o.valid) return;
+			valid = true;
+			cycles += o.cycles; instructions += o.instructions;
+			l1d_misses += o.l1d_misses; llc_misses += o.llc_misses;
+			dtlb_misses += o.dtlb_misses; branch_misses += o.branch_misses;
+		}
+		double Ipc() const
+		{
+			return cycles ? double(instructions) / double(cycles) : 0.0;
+		}
+	};
+
+	// Interruptor global: desactivat per defecte perquè obrir els comptadors costa syscalls.
+	void SetHwCountersEnabled(bool on);
+	bool HwCountersEnabled();
+	bool HwCountersAvailable();		// prova un cop si el sistema els suporta
+
+	// Mesura el fil actual (i els fils que creï mentre dura) i ho acumula a *dest en destruir-se.
+	// Si els comptadors estan desactivats o no disponibles no fa res.
+	class HwScope
+	{
+	public:
+		explicit HwScope(HwCounters* dest);
+		~HwScope();
+
+		HwScope(const HwScope&) = delete;
+		HwScope& operator=(const HwScope&) = delete;
+
+	private:
+		HwCounters* dest_;
+		int fds_[6];
+		bool active_ = false;
+	};
+
+	// Comptadors de l'última crida a Matrix::Multiply feta per aquest fil (si estaven activats).
+	HwCounters LastMultiplyCounters();
+	void SetLastMultiplyCounters(const HwCounters& c);
+
+	// Mesura una crida a Multiply i en deixa el resultat a LastMultiplyCounters() en acabar.
+	class MultiplyHwRecord
+	{
+	public:
+		MultiplyHwRecord();
+		~MultiplyHwRecord();
+
+		MultiplyHwRecord(const MultiplyHwRecord&) = delete;
+		MultiplyHwRecord& operator=(const MultiplyHwRecord&) = delete;
+
+	private:
+		HwCounters c_;
+		std::optional<HwScope> scope_;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,72 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace LinAlg
+{
+
+	// Philox4x32-10 (Salmon et al., "Parallel random numbers: as easy as 1, 2, 3").
+	// Generador basat en comptador: el valor depèn només de (clau, comptador), de manera que
+	// qualsevol fil pot generar qualsevol element sense estat compartit i el resultat no depèn
+	// de com es reparteix la feina.
+	struct Philox4x32
+	{
+		std::uint32_t v[4];
+
+		static Philox4x32 Block(std::uint32_t c0, std::uint32_t c1, std::uint32_t c2, std::uint32_t c3,
+			std::uint32_t k0, std::uint32_t k1)
+		{
+			Philox4x32 r{ { c0, c1, c2, c3 } };
+			for (int round = 0; round < 10; ++round) {
+				if (round > 0) { k0 += 0x9E3779B9u; k1 += 0xBB67AE85u; }
+				const std::uint64_t p0 = std::uint64_t(0xD2511F53u) * r.v[0];
+				const std::uint64_t p1 = std::uint64_t(0xCD9E8D57u) * r.v[2];
+				const std::uint32_t hi0 = std::uint32_t(p0 >> 32), lo0 = std::uint32_t(p0);
+				const std::uint32_t hi1 = std::uint32_t(p1 >> 32), lo1 = std::uint32_t(p1);
+				r.v[0] = hi1 ^ r.v[1] ^ k0;
+				r.v[1] = lo1;
+				r.v[2] = hi0 ^ r.v[3] ^ k1;
+				r.v[3] = lo0;
+			}
+			return r;
+		}
+	};
+
+	// 53 bits aleatoris -> [-1, 1).
+	inline double PhiloxToSigned(std::uint32_t hi, std::uint32_t lo)
+	{
+		const std::uint64_t bits = ((std::uint64_t(hi) << 32) | lo) >> 11;
+		return 2.0 * (double(bits) * (1.0 / 9007199254740992.0)) - 1.0;
+	}
+
+	// Omple out[0..count) amb els valors de les columnes [col0, col0 + count) de la fila 'row'
+	// del flux 'stream'. Cada bloc Philox dona dues columnes consecutives (parella j/2).
+	inline void PhiloxFillRow(std::uint64_t seed, std::uint32_t stream, std::uint64_t row,
+		std::size_t col0, std::size_t count, double* out)
+	{
+		const std::uint32_t k0 = std::uint32_t(seed), k1 = std::uint32_t(seed >> 32);
+		std::size_t j = col0;
+		const std::size_t end = col0 + count;
+		while (j < end) {
+			const std::uint64_t pair = j >> 1;
+			Philox4x32 b = Philox4x32::Block(std::uint32_t(pair), std::uint32_t(pair >> 32),
+				std::uint32_t(row), stream ^ (std::uint32_t(row >> 32) << 16), k0, k1);
+			if ((j & 1) == 0) {
+				out[j - col0] = PhiloxToSigned(b.v[0], b.v[1]);
+				++j;
+			}
+			if (j < end) {
+				out[j - col0] = PhiloxToSigned(b.v[2], b.v[3]);
+				++j;
+			}
+		}
+	}
+
+	// Un sol element (i, j); coincideix amb el que escriuria PhiloxFillRow.
+	inline double PhiloxAt(std::uint64_t seed, std::uint32_t stream, std::uint64_t row, std::size_t col)
+	{
+		double v;
+		PhiloxFillRow(seed, stream, row, col, 1, &v);
+		return v;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,62 @@
+#pragma once
+#include "Matrix.hpp"
+#include "OpsCounter.hpp"
+#include "Progress.hpp"
+#include "Solve.hpp"
+#include "Trace.hpp"
+#include <string>
+#include <vector>
+
+namespace LinAlg
+{
+
+	// Estratègia de pivotatge de l'eliminació gaussiana, de més ràpida a més estable:
+	//  None			pivot a la diagonal (falla amb pivots ~0)
+	//  Partial			màxim |a_ik| de la columna (intercanvi de files)
+	//  ScaledPartial	màxim |a_ik| / s_i, amb s_i el màxim de la fila original (files mal escalades)
+	//  Rook			element màxim alhora a la seva fila i a la seva columna (files i columnes)
+	//  Complete		màxim de tot el submatriu restant, O(n^2) per pas (files i columnes)
+	enum class PivotStrategy { None, Partial, ScaledPartial, Rook, Complete };
+
+	const char* PivotStrategyName(PivotStrategy s);
+	bool ParsePivotStrategy(const std::string& name, PivotStrategy& out);	// "none", "partial", "scaled", "rook", "complete"
+
+	struct PivotChoice
+	{
+		std::size_t row = 0, col = 0;
+		double value = 0.0;		// |a[row, col]|
+	};
+
+	// Primer índex del màxim de |x[i * stride]|, i < n. Dues passades: màxim amb acumuladors
+	// independents (vectoritzable) i cerca del primer element igual, que sol acabar aviat.
+	std::size_t ArgMaxAbs(const double* x, std::size_t n, std::size_t stride = 1);
+
+	// Pivot del pas k sobre A[k:, k:]. 'scale' només s'usa amb ScaledPartial. Amb threads != 1 la
+	// cerca completa es reparteix per blocs de files i es combina amb una reducció en arbre que
+	// desempata com la versió sèrie (primer en ordre de files), així que el pivot és el mateix.
+	PivotChoice SelectPivot(PivotStrategy s, const Matrix& A, std::size_t k, const Vec* scale = nullptr,
+		std::size_t threads = 1, OpsCounter* op = nullptr);
+
+	// Intercanvis fets a cada pas: P A Q = L U amb P i Q composicions de transposicions (estil LAPACK).
+	struct PivotHistory
+	{
+		std::vector<std::size_t> row_piv;	// row_piv[k] = fila intercanviada amb la k al pas k
+		std::vector<std::size_t> col_piv;	// col_piv[k] = columna intercanviada amb la k al pas k
+		std::size_t row_swaps = 0, col_swaps = 0;
+	};
+
+	// Nucli comú de l'eliminació: factoritza A in place (L unitària sota la diagonal, U a sobre)
+	// amb l'estratègia triada i, si b != nullptr, hi aplica els intercanvis de files i l'eliminació.
+	// Retorna false si un pivot queda per sota de tol, si les dimensions no quadren o si es cancel·la.
+	// threads != 1 reparteix també l'actualització del submatriu per files (resultat idèntic).
+	bool EliminatePivoted(Matrix& A, Vec* b, PivotStrategy s, double tol, PivotHistory& hist,
+		OpsCounter* op = nullptr, PhaseTimes* phases = nullptr, ProgressToken* progress = nullptr, std::size_t threads = 1);
+
+	// x <- Q x: desfà les permutacions de columnes (la solució de (AQ) y = Pb és x = Q y).
+	void ApplyColumnPivots(const PivotHistory& hist, Vec& x);
+
+	// Resolució completa amb qualsevol estratègia: mateix informe que SolvePartialPivot (fases, residu,
+	// kappa_1, creixement). Amb None un pivot ~0 es reporta com pivot_zero; amb la resta, com singular.
+	SolveReport SolvePivoted(Matrix A, Vec b, double tol, PivotStrategy s, std::size_t threads = 1,
+		ProgressToken* progress = nullptr);
+}
\ No newline at end of file
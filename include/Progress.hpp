@@ -0,0 +1,29 @@
+#pragma once
+#include <atomic>
+
+namespace LinAlg
+{
+
+	// Canal entre un càlcul llarg (fil de treball) i qui l'observa (p. ex. la GUI):
+	// el kernel publica la fracció feta i consulta si li han demanat parar.
+	// La cancel·lació és cooperativa: el kernel surt al següent punt de control.
+	class ProgressToken
+	{
+	public:
+		void Reset()
+		{
+			fraction_.store(0.0, std::memory_order_relaxed);
+			cancel_.store(false, std::memory_order_relaxed);
+		}
+
+		void Set(double f) { fraction_.store(f, std::memory_order_relaxed); }
+		double Fraction() const { return fraction_.load(std::memory_order_relaxed); }
+
+		void Cancel() { cancel_.store(true, std::memory_order_relaxed); }
+		bool Cancelled() const { return cancel_.load(std::memory_order_relaxed); }
+
+	private:
+		std::atomic<double> fraction_{ 0.0 };
+		std::atomic<bool> cancel_{ false };
+	};
+}
\ No newline at end of file
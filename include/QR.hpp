@@ -0,0 +1,61 @@
+#pragma once
+#include "Matrix.hpp"
+#include "OpsCounter.hpp"
+#include "Progress.hpp"
+#include <vector>
+
+namespace LinAlg
+{
+
+	// A = Q R (m >= n) amb reflectors de Householder H_j = I - tau_j v_j v_j^T, Q = H_0 H_1 ... H_{n-1}.
+	// Format compacte com LAPACK (xGEQRF): R a la part superior de QR i v_j sota la diagonal
+	// (v_j[j] = 1 implícit). Es factoritza per panells de 'block' columnes: cada panell s'aplica a
+	// la resta de la matriu d'un sol cop en forma WY compacta, I - V T V^T, amb T triangular superior.
+	struct QRFactors
+	{
+		Matrix QR;
+		Vec tau;
+	};
+
+	QRFactors FactorizeQR(Matrix A, std::size_t block = 32, OpsCounter* op = nullptr);
+
+	// b <- Q^T b (b de mida m).
+	void ApplyQt(const QRFactors& F, Vec& b, OpsCounter* op = nullptr);
+
+	// TSQR (QR "communication-avoiding" per a matrius altes i primes): A es parteix en blocs de
+	// files, cada bloc es factoritza pel seu compte (en paral·lel) i els R n x n resultants es
+	// combinen per parelles en un arbre binari. Cada nivell només mou matrius n x n.
+	struct TSQRFactors
+	{
+		std::size_t m = 0, n = 0;
+		std::vector<std::size_t> row_begin;				// inici de cada bloc (blocs + 1 entrades)
+		std::vector<QRFactors> leaves;					// QR de cada bloc de files
+		std::vector<std::vector<QRFactors>> levels;		// levels[l][p]: QR de [R_2p; R_2p+1]; QR buit si el node passa sol
+		Matrix R;										// n x n final
+		bool cancelled = false;							// ProgressToken::Cancel(): factors incomplets
+	};
+
+	// blocks = 0: un bloc per fil. Cada bloc té com a mínim n files. 'progress' es consulta a cada panell
+	// de les fulles i a cada nivell de l'arbre.
+	TSQRFactors FactorizeTSQR(const Matrix& A, std::size_t blocks = 0, std::size_t threads = 0, OpsCounter* op = nullptr,
+		ProgressToken* progress = nullptr);
+
+	// Com SolveReport, però per a min ||A x - b||_2 amb A m x n (m >= n).
+	struct LeastSquaresReport
+	{
+		Vec x;
+		bool rank_deficient = false;	// algun |r_jj| <= tol * max |r_ii|: x queda buit
+		bool cancelled = false;			// s'ha aturat per ProgressToken::Cancel(); x queda buit
+		std::size_t m = 0, n = 0;
+		OpsCounter ops{};
+		double ms = 0.0;				// factorització + Q^T b + substitució
+		double resid_norm = 0.0;		// ||A x - b||_2, de la part de Q^T b que R no cobreix (sense recalcular A x)
+		double rel_resid = 0.0;			// resid_norm / ||b||_2
+		double optimality = 0.0;		// ||A^T r||_2 / (||A||_F ||r||_2): ~eps si x és el mínim
+	};
+
+	enum class QRMethod { Householder, TSQR };
+
+	LeastSquaresReport SolveLeastSquares(const Matrix& A, const Vec& b, QRMethod method = QRMethod::Householder,
+		std::size_t threads = 0, double tol = 1e-12, ProgressToken* progress = nullptr);
+}
\ No newline at end of file
@@ -1,26 +1,64 @@
 #pragma once
 #include "Matrix.hpp"
 #include "OpsCounter.hpp"
+#include "PerfCounters.hpp"
+#include "Progress.hpp"
 #include "Timer.hpp"
+#include "Trace.hpp"
+#include <cmath>
+#include <vector>
 
 namespace LinAlg 
 {
 
+	// Comptadors hardware per fase (només vàlids si SetHwCountersEnabled(true) i el sistema els suporta).
+	struct SolvePhaseCounters
+	{
+		HwCounters elimination;
+		HwCounters back_substitution;
+		HwCounters residual;
+	};
+
 	struct SolveReport 
 	{
 		Vec x;
 		bool pivot_zero = false;
 		bool singular = false;
+		bool cancelled = false;		// s'ha aturat per ProgressToken::Cancel(); x queda buit
 		std::size_t n = 0;
 		OpsCounter ops{};
 		double ms = 0.0;
 		double rel_resid = 0.0;
+		double cond1 = 0.0;			// estimació de kappa_1(A) amb els factors LU, O(n^2) (0: no s'ha arribat a factoritzar)
+		double pivot_growth = 0.0;	// max|u_ij| / max|a_ij|
+		double log_abs_det = -INFINITY;	// log|det(A)| a partir de la diagonal de U (vegeu Determinant.hpp)
+		int det_sign = 0;				// signe de det(A); 0 si és singular o no s'ha arribat a factoritzar
+		SolvePhaseCounters hw{};
+		PhaseTimes phases{};		// report.ms = elimination_ms + back_ms; phases.TotalMs() inclou còpia i residu
 	};
 
-	bool GaussianElimination(Matrix& A, Vec& b, double tol, OpsCounter* op = nullptr);		// TODO (Ex2)
+	// 'progress' (opcional) rep la fracció de passos k fets; si es cancel·la, l'eliminació retorna false.
+	bool GaussianElimination(Matrix& A, Vec& b, double tol, OpsCounter* op = nullptr,
+		ProgressToken* progress = nullptr);												// TODO (Ex2)
 	void BackSubstitution(const Matrix& U, Vec& c, OpsCounter* op = nullptr);				// TODO (Ex2)
-	SolveReport SolveNoPivot(Matrix A, Vec b, double tol);									// TODO (Ex2)
+	SolveReport SolveNoPivot(Matrix A, Vec b, double tol, ProgressToken* progress = nullptr);	// TODO (Ex2)
+
+	bool GaussianEliminationPivot(Matrix& A, Vec& b, double tol, OpsCounter* op = nullptr,
+		PhaseTimes* phases = nullptr, ProgressToken* progress = nullptr);					// TODO (Ex3)
+	SolveReport SolvePartialPivot(Matrix A, Vec b, double tol, ProgressToken* progress = nullptr);	// TODO (Ex3)
+
+	// Factorització PA = LU reutilitzable per a diversos termes independents.
+	struct LUFactors
+	{
+		Matrix LU;						// L unitària sota la diagonal, U a la diagonal i per sobre
+		std::vector<std::size_t> piv;	// piv[k] = fila intercanviada amb la k al pas k
+		std::size_t swaps = 0;
+		bool singular = false;
+		double tol = 0.0;
+	};
 
-	bool GaussianEliminationPivot(Matrix& A, Vec& b, double tol, OpsCounter* op = nullptr); // TODO (Ex3)
-	SolveReport SolvePartialPivot(Matrix A, Vec b, double tol);								// TODO (Ex3)
+	bool FactorizePartialPivot(Matrix& A, std::vector<std::size_t>& piv, double tol, OpsCounter* op = nullptr);
+	LUFactors FactorizeLU(Matrix A, double tol, OpsCounter* op = nullptr);
+	void SolveFactorized(const LUFactors& F, Vec& b, OpsCounter* op = nullptr);
+	void SolveFactorized(const LUFactors& F, Matrix& B, OpsCounter* op = nullptr);		// B: n x m, una columna per terme independent
 }
\ No newline at end of file
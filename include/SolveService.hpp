@@ -0,0 +1,77 @@
+#pragma once
+#include "Matrix.hpp"
+#include "Solve.hpp"
+#include "LUCache.hpp"
+#include <condition_variable>
+#include <cstddef>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace LinAlg
+{
+
+	struct ServiceConfig
+	{
+		std::size_t workers = 0;		// 0 => std::thread::hardware_concurrency()
+		double tol = 1e-12;
+		double max_wait_ms = 250.0;		// passat aquest temps, un lot passa davant dels petits (anti-starvation)
+		LUCache* cache = nullptr;		// opcional: reutilitza factoritzacions entre lots
+	};
+
+	struct ServiceMetrics
+	{
+		std::size_t queue_depth = 0;		// peticions pendents ara mateix
+		std::size_t max_queue_depth = 0;
+		std::size_t submitted = 0, completed = 0;
+		std::size_t failed = 0;				// peticions d'un lot que ha llançat una excepció (el future la rep)
+		std::size_t batches = 0;			// lots processats (una factorització o un encert de cache per lot)
+		std::size_t coalesced = 0;			// peticions que han reutilitzat la factorització d'una altra
+		double total_wait_ms = 0.0, max_wait_ms = 0.0;
+		double total_solve_ms = 0.0, max_solve_ms = 0.0;
+
+		double MeanWaitMs() const
+		{
+			return completed + failed ? total_wait_ms / double(completed + failed) : 0.0;
+		}
+		double MeanSolveMs() const
+		{
+			return batches ? total_solve_ms / double(batches) : 0.0;
+		}
+	};
+
+	// Front-end asíncron sobre FactorizeLU/SolveFactorized. Les peticions amb la mateixa A
+	// que encara són a la cua s'agrupen en una sola factorització + resolució multi-RHS,
+	// i els lots es planifiquen per mida (n petita primer).
+	class SolveService
+	{
+	public:
+		explicit SolveService(const ServiceConfig& cfg = ServiceConfig{});
+		~SolveService();
+
+		SolveService(const SolveService&) = delete;
+		SolveService& operator=(const SolveService&) = delete;
+
+		std::future<SolveReport> Submit(Matrix A, Vec b);
+		ServiceMetrics Metrics() const;
+		void Shutdown();	// acaba la feina pendent i atura els workers
+
+	private:
+		struct Job;
+		struct Batch;
+
+		void WorkerLoop();
+		std::unique_ptr<Batch> PopBatch();	// crida amb mtx_ bloquejat
+		void RunBatch(Batch& batch);
+
+		ServiceConfig cfg_;
+		mutable std::mutex mtx_;
+		std::condition_variable cv_;
+		std::vector<std::unique_ptr<Batch>> pending_;
+		std::vector<std::thread> workers_;
+		ServiceMetrics metrics_;
+		bool stop_ = false;
+	};
+}
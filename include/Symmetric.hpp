@@ -0,0 +1,48 @@
+#pragma once
+#include "Blas.hpp"
+#include "Matrix.hpp"
+#include "OpsCounter.hpp"
+#include "Solve.hpp"
+#include <cstddef>
+
+namespace LinAlg
+{
+
+	// Matriu simètrica n x n guardada com a triangle inferior empaquetat per files:
+	// l'element (i, j) amb j <= i és a ap[i * (i + 1) / 2 + j]. Ocupa n(n+1)/2 doubles i cada
+	// fila del triangle és contigua, així que els kernels recorren la memòria seqüencialment.
+	struct SymPacked
+	{
+		std::size_t n = 0;
+		Vec ap;
+
+		SymPacked() = default;
+		explicit SymPacked(std::size_t n_, double val = 0.0) : n(n_), ap(n_ * (n_ + 1) / 2, val) {}
+
+		static std::size_t Index(std::size_t i, std::size_t j) { return i >= j ? i * (i + 1) / 2 + j : j * (j + 1) / 2 + i; }
+		double& At(std::size_t i, std::size_t j) { return ap[Index(i, j)]; }
+		double At(std::size_t i, std::size_t j) const { return ap[Index(i, j)]; }
+
+		// Es llegeix només el triangle inferior d'A (no es comprova que sigui simètrica).
+		static SymPacked FromLower(const Matrix& A);
+		Matrix ToDense() const;
+	};
+
+	// y = alpha * S * x + beta * y. Cada element guardat es llegeix un sol cop i s'aplica a
+	// les dues posicions simètriques. Comptador amb el mateix criteri que Gemv.
+	void Spmv(double alpha, const SymPacked& S, const Vec& x, double beta, Vec& y, OpsCounter* op = nullptr);
+
+	// C = alpha * op(A) * op(A)^T + beta * C amb op(A) = A (ta = No, C = A A^T) o A^T (ta = Yes,
+	// C = A^T A). Només es calcula el triangle inferior; les files de C es reparteixen entre
+	// 'threads' fils (0 => tots) en franges d'àrea similar i el resultat no depèn del nombre de fils.
+	void Syrk(Trans ta, double alpha, const Matrix& A, double beta, SymPacked& C, std::size_t threads = 1, OpsCounter* op = nullptr);
+
+	// Cholesky in place S = L L^T (L queda al mateix triangle). Retorna false si algun pivot
+	// L_jj^2 <= tol: la matriu no és definida positiva (o ho és massa poc per a la tolerància).
+	bool FactorizeCholesky(SymPacked& S, double tol, OpsCounter* op = nullptr);
+	void SolveCholesky(const SymPacked& L, Vec& b, OpsCounter* op = nullptr);
+
+	// Resol S x = b per Cholesky. Si S no és definida positiva, report.pivot_zero = true.
+	// El residu es calcula amb Spmv i el determinant amb 2 * sum(log L_jj) (sempre positiu).
+	SolveReport SolveSymmetric(SymPacked S, Vec b, double tol);
+}
\ No newline at end of file
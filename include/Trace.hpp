@@ -0,0 +1,64 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace LinAlg
+{
+
+	// Desglossament del temps d'una resolució (ms). pivot/swap/update només s'omplen amb el traçat activat,
+	// perquè cronometrar cada pas k té un cost petit però no nul.
+	struct PhaseTimes
+	{
+		double copy_ms = 0.0;			// còpies d'A i b per al residu
+		double elimination_ms = 0.0;	// eliminació sencera (inclou pivot, swap i update)
+		double pivot_ms = 0.0;			// cerca del pivot
+		double swap_ms = 0.0;			// intercanvi de files
+		double update_ms = 0.0;			// actualització del submatriu
+		double back_ms = 0.0;			// substitució enrere
+		double residual_ms = 0.0;
+		double condition_ms = 0.0;		// estimació de kappa_1 i creixement dels pivots
+
+		double TotalMs() const { return copy_ms + elimination_ms + back_ms + residual_ms + condition_ms; }
+	};
+
+	// Un tram tancat: temps en microsegons des de l'inici del procés.
+	struct TraceEvent
+	{
+		const char* name = "";
+		std::uint32_t tid = 0;
+		std::uint32_t depth = 0;		// nivell d'imbricació dins del fil
+		double start_us = 0.0;
+		double dur_us = 0.0;
+	};
+
+	// Interruptor global (desactivat per defecte): sense traçat, TraceSpan només llegeix un atòmic.
+	void SetTracingEnabled(bool on);
+	bool TracingEnabled();
+
+	double TraceNowUs();
+	std::uint32_t TraceThreadId();						// identificador petit i estable per fil
+	void SetTraceThreadName(const std::string& name);	// apareix com a nom del fil al visor
+
+	// Tram RAII. 'name' ha de viure fins a l'exportació (normalment un literal).
+	class TraceSpan
+	{
+	public:
+		explicit TraceSpan(const char* name);
+		~TraceSpan();
+
+		TraceSpan(const TraceSpan&) = delete;
+		TraceSpan& operator=(const TraceSpan&) = delete;
+
+	private:
+		const char* name_;
+		double start_us_ = 0.0;
+		bool active_ = false;
+	};
+
+	std::vector<TraceEvent> CollectTrace();		// tots els fils, ordenats per inici
+	void ClearTrace();
+
+	// Format "Trace Event" de Chrome (chrome://tracing, ui.perfetto.dev).
+	bool WriteChromeTrace(const std::string& path);
+}
\ No newline at end of file
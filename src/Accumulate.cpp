@@ -0,0 +1,163 @@
+#include "Accumulate.hpp"
+#include <cmath>
+#include <stdexcept>
+
+namespace LinAlg
+{
+
+    namespace
+    {
+        constexpr std::size_t kLanes = 4;
+        constexpr std::size_t kPairwiseBlock = 128;    // fulla de l'arbre: suma directa en carrils
+
+        // s + e = a + b exactament (Knuth, sense condicions sobre |a| i |b|).
+        inline void TwoSum(double a, double b, double& s, double& e)
+        {
+            s = a + b;
+            const double bb = s - a;
+            e = (a - (s - bb)) + (b - bb);
+        }
+
+        // p + e = a * b exactament; amb FMA hardware és una sola instrucció extra.
+        inline void TwoProd(double a, double b, double& p, double& e)
+        {
+            p = a * b;
+            e = std::fma(a, b, -p);
+        }
+
+        double DotPlain(const double* x, const double* y, std::size_t n, double init)
+        {
+            double acc = init;
+            for (std::size_t i = 0; i < n; ++i) acc += x[i] * y[i];
+            return acc;
+        }
+
+        double DotNeumaier(const double* x, const double* y, std::size_t n, double init)
+        {
+            // Cada carril porta la seva suma i la seva correcció; la tria de branca es vectoritza com a blend.
+            double s[kLanes] = { init, 0.0, 0.0, 0.0 }, c[kLanes] = {};
+            std::size_t i = 0;
+            for (; i + kLanes <= n; i += kLanes) {
+                for (std::size_t l = 0; l < kLanes; ++l) {
+                    const double p = x[i + l] * y[i + l];
+                    const double t = s[l] + p;
+                    c[l] += std::abs(s[l]) >= std::abs(p) ? (s[l] - t) + p : (p - t) + s[l];
+                    s[l] = t;
+                }
+            }
+            for (; i < n; ++i) {
+                const double p = x[i] * y[i];
+                const double t = s[0] + p;
+                c[0] += std::abs(s[0]) >= std::abs(p) ? (s[0] - t) + p : (p - t) + s[0];
+                s[0] = t;
+            }
+
+            // Reunim els carrils amb la mateixa suma compensada.
+            double sum = s[0], comp = c[0];
+            for (std::size_t l = 1; l < kLanes; ++l) {
+                const double t = sum + s[l];
+                comp += std::abs(sum) >= std::abs(s[l]) ? (sum - t) + s[l] : (s[l] - t) + sum;
+                sum = t;
+                comp += c[l];
+            }
+            return sum + comp;
+        }
+
+        // init entra com a primer terme de la fulla de més a l'esquerra: amb init = -b la cancel·lació
+        // amb A x passa dins l'arbre, com als altres modes, i no en una suma final fora d'ell.
+        double PairwiseRec(const double* x, const double* y, std::size_t n, double init)
+        {
+            if (n <= kPairwiseBlock) {
+                double s[kLanes] = { init, 0.0, 0.0, 0.0 };
+                std::size_t i = 0;
+                for (; i + kLanes <= n; i += kLanes) {
+                    for (std::size_t l = 0; l < kLanes; ++l) s[l] += x[i + l] * y[i + l];
+                }
+                for (; i < n; ++i) s[0] += x[i] * y[i];
+                return (s[0] + s[1]) + (s[2] + s[3]);
+            }
+            // Tall en un múltiple del bloc perquè les fulles quedin plenes.
+            const std::size_t half = ((n / 2 + kPairwiseBlock - 1) / kPairwiseBlock) * kPairwiseBlock;
+            return PairwiseRec(x, y, half, init) + PairwiseRec(x + half, y + half, n - half, 0.0);
+        }
+
+        double DotDoubleDouble(const double* x, const double* y, std::size_t n, double init)
+        {
+            // Dot2: la part alta s'acumula amb TwoSum i tots els errors (de producte i de suma) a c.
+            double s[kLanes] = { init, 0.0, 0.0, 0.0 }, c[kLanes] = {};
+            std::size_t i = 0;
+            for (; i + kLanes <= n; i += kLanes) {
+                for (std::size_t l = 0; l < kLanes; ++l) {
+                    double p, ep, q;
+                    TwoProd(x[i + l], y[i + l], p, ep);
+                    TwoSum(s[l], p, s[l], q);
+                    c[l] += q + ep;
+                }
+            }
+            for (; i < n; ++i) {
+                double p, ep, q;
+                TwoProd(x[i], y[i], p, ep);
+                TwoSum(s[0], p, s[0], q);
+                c[0] += q + ep;
+            }
+
+            double sum = s[0], comp = c[0];
+            for (std::size_t l = 1; l < kLanes; ++l) {
+                double q;
+                TwoSum(sum, s[l], sum, q);
+                comp += q + c[l];
+            }
+            return sum + comp;
+        }
+    }
+
+    const char* AccumModeName(AccumMode m)
+    {
+        switch (m) {
+        case AccumMode::Plain: return "plain";
+        case AccumMode::Neumaier: return "neumaier";
+        case AccumMode::Pairwise: return "pairwise";
+        case AccumMode::DoubleDouble: return "dd";
+        }
+        return "?";
+    }
+
+    bool ParseAccumMode(const std::string& name, AccumMode& out)
+    {
+        for (AccumMode m : { AccumMode::Plain, AccumMode::Neumaier, AccumMode::Pairwise, AccumMode::DoubleDouble }) {
+            if (name == AccumModeName(m)) { out = m; return true; }
+        }
+        return false;
+    }
+
+    double Dot(const double* x, const double* y, std::size_t n, AccumMode mode, double init)
+    {
+        switch (mode) {
+        case AccumMode::Plain: return DotPlain(x, y, n, init);
+        case AccumMode::Neumaier: return DotNeumaier(x, y, n, init);
+        case AccumMode::Pairwise: return PairwiseRec(x, y, n, init);
+        case AccumMode::DoubleDouble: return DotDoubleDouble(x, y, n, init);
+        }
+        return DotPlain(x, y, n, init);
+    }
+
+    Vec MatVec(const Matrix& A, const Vec& x, AccumMode mode, OpsCounter* op)
+    {
+        if (mode == AccumMode::Plain) {
+            return A.Multiply(x, op);
+        }
+        if (A.cols != x.size()) {
+            throw std::invalid_argument("MatVec: dimensions incompatibles");
+        }
+
+        Vec y(A.rows);
+        for (std::size_t i = 0; i < A.rows; ++i) {
+            y[i] = Dot(A.a.data() + i * A.cols, x.data(), A.cols, mode);
+        }
+        if (op && A.cols) {
+            op->IncMul(A.rows * A.cols);
+            op->IncAdd(A.rows * (A.cols - 1));
+        }
+        return y;
+    }
+}
@@ -0,0 +1,384 @@
+#include "BenchHarness.hpp"
+#include "Timer.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <sstream>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#endif
+
+namespace Bench
+{
+
+    bool PinThisThread(int cpu)
+    {
+        if (cpu < 0) return false;
+#if defined(_WIN32)
+        return SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << cpu) != 0;
+#elif defined(__linux__)
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+        return false;
+#endif
+    }
+
+    RunInfo CollectRunInfo(const HarnessConfig& cfg)
+    {
+        RunInfo info;
+        info.warmups = cfg.warmups;
+        info.reps = cfg.reps;
+        info.pin_cpu = cfg.pin_cpu;
+
+#if defined(_WIN32)
+        const char* host = std::getenv("COMPUTERNAME");
+        info.host = host ? host : "unknown";
+#else
+        char host[256] = {};
+        info.host = (gethostname(host, sizeof(host) - 1) == 0) ? host : "unknown";
+#endif
+
+#if defined(__clang__)
+        info.compiler = std::string("clang ") + __clang_version__;
+#elif defined(__GNUC__)
+        info.compiler = std::string("gcc ") + __VERSION__;
+#elif defined(_MSC_VER)
+        info.compiler = "msvc " + std::to_string(_MSC_VER);
+#else
+        info.compiler = "unknown";
+#endif
+
+        std::time_t now = std::time(nullptr);
+        char buf[32];
+        std::strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+        info.timestamp = buf;
+        return info;
+    }
+
+    BenchStats Measure(const std::string& kernel, std::size_t n, double bytes,
+        const std::function<void(OpsCounter*)>& body, const HarnessConfig& cfg, double flops)
+    {
+        BenchStats s;
+        s.kernel = kernel;
+        s.n = n;
+        s.bytes = bytes;
+
+        // 1) Passada de comptatge: el comptador frena el kernel, per això va fora del cronòmetre.
+        if (flops >= 0.0) {
+            s.flops = flops;
+        }
+        else {
+            OpsCounter op;
+            body(&op);
+            s.flops = double(op.add + op.sub + op.mul + op.div_);
+        }
+
+        // 2) Escalfament: caches, TLB i freqüència de la CPU.
+        for (int i = 0; i < cfg.warmups; ++i) body(nullptr);
+
+        // 3) Repeticions mesurades.
+        const int reps = std::max(1, cfg.reps);
+        std::vector<double> t((std::size_t)reps);
+        LinAlg::HwCounters hw;
+        for (int i = 0; i < reps; ++i) {
+            LinAlg::HwScope scope(cfg.hw_counters ? &hw : nullptr);
+            Timer timer;
+            timer.Tic();
+            body(nullptr);
+            t[(std::size_t)i] = timer.TocMs();
+        }
+        if (hw.valid) {
+            s.hw = hw;
+            s.hw.cycles /= std::uint64_t(reps); s.hw.instructions /= std::uint64_t(reps);
+            s.hw.l1d_misses /= std::uint64_t(reps); s.hw.llc_misses /= std::uint64_t(reps);
+            s.hw.dtlb_misses /= std::uint64_t(reps); s.hw.branch_misses /= std::uint64_t(reps);
+        }
+
+        std::sort(t.begin(), t.end());
+        s.reps = reps;
+        s.min_ms = t.front();
+        s.median_ms = (reps % 2) ? t[(std::size_t)reps / 2] : 0.5 * (t[(std::size_t)reps / 2 - 1] + t[(std::size_t)reps / 2]);
+        s.p95_ms = t[(std::size_t)std::max(0, int(std::ceil(0.95 * reps)) - 1)];
+
+        double sum = 0.0;
+        for (double v : t) sum += v;
+        s.mean_ms = sum / reps;
+        double var = 0.0;
+        for (double v : t) var += (v - s.mean_ms) * (v - s.mean_ms);
+        s.stddev_ms = reps > 1 ? std::sqrt(var / (reps - 1)) : 0.0;
+
+        // El rendiment es calcula sobre la mediana, que és robusta a interrupcions puntuals.
+        if (s.median_ms > 0.0) {
+            s.gflops = s.flops / (s.median_ms * 1e6);
+            s.gbps = s.bytes / (s.median_ms * 1e6);
+        }
+        return s;
+    }
+
+    double MeasurePeakGflops(int reps)
+    {
+        // 32 cadenes independents acc = acc * m + c: prou per amagar la latència de l'FMA
+        // i que el compilador les vectoritzi. Sense -ffast-math no pot reordenar-les.
+        constexpr int kLanes = 32;
+        constexpr long kIters = 1 << 21;
+        double best = 0.0;
+        for (int r = 0; r < std::max(1, reps); ++r) {
+            double acc[kLanes];
+            for (int l = 0; l < kLanes; ++l) acc[l] = 1.0 + l * 1e-3;
+            const double m = 0.999999, c = 1e-7;
+
+            Timer timer;
+            timer.Tic();
+            for (long it = 0; it < kIters; ++it) {
+                for (int l = 0; l < kLanes; ++l) acc[l] = acc[l] * m + c;
+            }
+            double ms = timer.TocMs();
+
+            volatile double sink = 0.0;
+            for (int l = 0; l < kLanes; ++l) sink = sink + acc[l];
+            if (ms > 0.0) best = std::max(best, 2.0 * kLanes * double(kIters) / (ms * 1e6));
+        }
+        return best;
+    }
+
+    double MeasureStreamGbps(std::size_t doubles_per_array, int reps)
+    {
+        std::vector<double> a(doubles_per_array, 0.0), b(doubles_per_array, 1.0), c(doubles_per_array, 2.0);
+        const double scalar = 3.0;
+        double best = 0.0;
+        for (int r = 0; r < std::max(1, reps); ++r) {
+            Timer timer;
+            timer.Tic();
+            for (std::size_t i = 0; i < doubles_per_array; ++i) a[i] = b[i] + scalar * c[i];
+            double ms = timer.TocMs();
+
+            volatile double sink = a[doubles_per_array / 2];
+            (void)sink;
+            // Convenció de STREAM: 2 lectures + 1 escriptura, sense comptar el write-allocate.
+            if (ms > 0.0) best = std::max(best, 3.0 * sizeof(double) * double(doubles_per_array) / (ms * 1e6));
+        }
+        return best;
+    }
+
+    // ---------------- Porta de regressió ----------------
+
+    GateVerdict CheckAgainstBaseline(const BenchStats& base, const BenchStats& cur, const GateConfig& cfg)
+    {
+        GateVerdict v;
+        if (base.min_ms <= 0.0 || cur.min_ms <= 0.0) {
+            return v;
+        }
+        // Es compara el millor temps de cada mesura: les interferències (altres processos, la
+        // freqüència de la CPU) només poden alentir, així que el mínim és el més estable entre
+        // execucions. El llindar s'eixampla amb el soroll relatiu de la línia base (no el de la
+        // mesura actual, que una regressió sorollosa podria fer créixer) i té un sostre, perquè
+        // cap quantitat de soroll pugui amagar un kernel el doble de lent.
+        const double rb = base.median_ms > 0.0 ? base.stddev_ms / base.median_ms : 0.0;
+        v.slowdown = cur.min_ms / base.min_ms - 1.0;
+        v.limit = std::min(cfg.threshold + cfg.noise_k * rb, cfg.max_factor * cfg.threshold);
+        v.regression = v.slowdown > v.limit && cur.median_ms > base.p95_ms;
+        v.faster = v.slowdown < -v.limit && cur.p95_ms < base.min_ms;
+        return v;
+    }
+
+    std::string BaselinePath(const std::string& dir, const std::string& host)
+    {
+        std::string name = host.empty() ? std::string("unknown") : host;
+        for (char& c : name) {
+            if (!std::isalnum((unsigned char)c) && c != '.' && c != '_' && c != '-') c = '_';
+        }
+        return dir + "/" + name + ".json";
+    }
+
+    // ---------------- JSON / CSV ----------------
+
+    static std::string Quote(const std::string& v)
+    {
+        std::string out = "\"";
+        for (char c : v) {
+            if (c == '"' || c == '\\') out += '\\';
+            if (c == '\n') { out += "\\n"; continue; }
+            out += c;
+        }
+        return out + "\"";
+    }
+
+    bool WriteJson(const std::string& path, const RunInfo& info, const std::vector<BenchStats>& results)
+    {
+        std::ofstream f(path, std::ios::trunc);
+        if (!f) return false;
+        f.precision(17);
+        f << "{\n"
+            << "  \"host\": " << Quote(info.host) << ",\n"
+            << "  \"compiler\": " << Quote(info.compiler) << ",\n"
+            << "  \"timestamp\": " << Quote(info.timestamp) << ",\n"
+            << "  \"warmups\": " << info.warmups << ",\n"
+            << "  \"reps\": " << info.reps << ",\n"
+            << "  \"pin_cpu\": " << info.pin_cpu << ",\n"
+            << "  \"results\": [\n";
+        for (std::size_t i = 0; i < results.size(); ++i) {
+            const BenchStats& s = results[i];
+            f << "    {\"kernel\": " << Quote(s.kernel) << ", \"n\": " << s.n << ", \"reps\": " << s.reps
+                << ", \"min_ms\": " << s.min_ms << ", \"median_ms\": " << s.median_ms << ", \"p95_ms\": " << s.p95_ms
+                << ", \"mean_ms\": " << s.mean_ms << ", \"stddev_ms\": " << s.stddev_ms
+                << ", \"flops\": " << s.flops << ", \"bytes\": " << s.bytes
+                << ", \"gflops\": " << s.gflops << ", \"gbps\": " << s.gbps;
+            if (s.hw.valid) {
+                f << ", \"cycles\": " << s.hw.cycles << ", \"instructions\": " << s.hw.instructions
+                    << ", \"l1d_misses\": " << s.hw.l1d_misses << ", \"llc_misses\": " << s.hw.llc_misses
+                    << ", \"dtlb_misses\": " << s.hw.dtlb_misses << ", \"branch_misses\": " << s.hw.branch_misses;
+            }
+            f << "}"
+                << (i + 1 < results.size() ? ",\n" : "\n");
+        }
+        f << "  ]\n}\n";
+        return bool(f);
+    }
+
+    bool WriteCsv(const std::string& path, const std::vector<BenchStats>& results)
+    {
+        std::ofstream f(path, std::ios::trunc);
+        if (!f) return false;
+        f.precision(17);
+        // Les columnes hardware queden buides si no s'han pogut mesurar.
+        f << "kernel,n,reps,min_ms,median_ms,p95_ms,mean_ms,stddev_ms,flops,bytes,gflops,gbps,"
+            << "cycles,instructions,l1d_misses,llc_misses,dtlb_misses,branch_misses\n";
+        for (const BenchStats& s : results) {
+            f << s.kernel << ',' << s.n << ',' << s.reps << ',' << s.min_ms << ',' << s.median_ms << ','
+                << s.p95_ms << ',' << s.mean_ms << ',' << s.stddev_ms << ',' << s.flops << ',' << s.bytes << ','
+                << s.gflops << ',' << s.gbps << ',';
+            if (s.hw.valid) {
+                f << s.hw.cycles << ',' << s.hw.instructions << ',' << s.hw.l1d_misses << ','
+                    << s.hw.llc_misses << ',' << s.hw.dtlb_misses << ',' << s.hw.branch_misses;
+            }
+            else {
+                f << ",,,,,";
+            }
+            f << '\n';
+        }
+        return bool(f);
+    }
+
+    // Lector mínim per al JSON que escriu WriteJson: objectes, llistes, cadenes i números.
+    namespace
+    {
+        struct JsonReader
+        {
+            const std::string& s;
+            std::size_t p = 0;
+
+            void Ws() { while (p < s.size() && std::isspace((unsigned char)s[p])) ++p; }
+            bool Eat(char c) { Ws(); if (p < s.size() && s[p] == c) { ++p; return true; } return false; }
+
+            bool String(std::string& out)
+            {
+                if (!Eat('"')) return false;
+                out.clear();
+                while (p < s.size() && s[p] != '"') {
+                    if (s[p] == '\\' && p + 1 < s.size()) {
+                        ++p;
+                        out += (s[p] == 'n') ? '\n' : s[p];
+                    }
+                    else {
+                        out += s[p];
+                    }
+                    ++p;
+                }
+                return Eat('"');
+            }
+
+            bool Number(double& out)
+            {
+                Ws();
+                const char* begin = s.c_str() + p;
+                char* end = nullptr;
+                out = std::strtod(begin, &end);
+                if (end == begin) return false;
+                p += std::size_t(end - begin);
+                return true;
+            }
+
+            // Recorre un objecte pla cridant field(clau) per a cada parella; field consumeix el valor.
+            template <class Field>
+            bool Object(Field&& field)
+            {
+                if (!Eat('{')) return false;
+                if (Eat('}')) return true;
+                do {
+                    std::string key;
+                    if (!String(key) || !Eat(':')) return false;
+                    if (!field(key)) return false;
+                } while (Eat(','));
+                return Eat('}');
+            }
+        };
+    }
+
+    bool ReadJson(const std::string& path, RunInfo& info, std::vector<BenchStats>& results)
+    {
+        std::ifstream f(path);
+        if (!f) return false;
+        std::stringstream ss;
+        ss << f.rdbuf();
+        const std::string text = ss.str();
+        JsonReader r{ text };
+
+        results.clear();
+        return r.Object([&](const std::string& key) {
+            double num = 0.0;
+            if (key == "host") return r.String(info.host);
+            if (key == "compiler") return r.String(info.compiler);
+            if (key == "timestamp") return r.String(info.timestamp);
+            if (key == "results") {
+                if (!r.Eat('[')) return false;
+                if (r.Eat(']')) return true;
+                do {
+                    BenchStats s;
+                    bool ok = r.Object([&](const std::string& k) {
+                        if (k == "kernel") return r.String(s.kernel);
+                        double v = 0.0;
+                        if (!r.Number(v)) return false;
+                        if (k == "n") s.n = std::size_t(v);
+                        else if (k == "reps") s.reps = int(v);
+                        else if (k == "min_ms") s.min_ms = v;
+                        else if (k == "median_ms") s.median_ms = v;
+                        else if (k == "p95_ms") s.p95_ms = v;
+                        else if (k == "mean_ms") s.mean_ms = v;
+                        else if (k == "stddev_ms") s.stddev_ms = v;
+                        else if (k == "flops") s.flops = v;
+                        else if (k == "bytes") s.bytes = v;
+                        else if (k == "gflops") s.gflops = v;
+                        else if (k == "gbps") s.gbps = v;
+                        else if (k == "cycles") { s.hw.valid = true; s.hw.cycles = std::uint64_t(v); }
+                        else if (k == "instructions") s.hw.instructions = std::uint64_t(v);
+                        else if (k == "l1d_misses") s.hw.l1d_misses = std::uint64_t(v);
+                        else if (k == "llc_misses") s.hw.llc_misses = std::uint64_t(v);
+                        else if (k == "dtlb_misses") s.hw.dtlb_misses = std::uint64_t(v);
+                        else if (k == "branch_misses") s.hw.branch_misses = std::uint64_t(v);
+                        return true;
+                    });
+                    if (!ok) return false;
+                    results.push_back(s);
+                } while (r.Eat(','));
+                return r.Eat(']');
+            }
+            if (!r.Number(num)) return false;
+            if (key == "warmups") info.warmups = int(num);
+            else if (key == "reps") info.reps = int(num);
+            else if (key == "pin_cpu") info.pin_cpu = int(num);
+            return true;
+        });
+    }
+}
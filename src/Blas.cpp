@@ -0,0 +1,220 @@
+#include "Blas.hpp"
+#include "Parallel.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+namespace LinAlg
+{
+
+    namespace
+    {
+        constexpr std::size_t kBlock = 64;
+
+        // C = beta * C (o zeros si beta == 0), abans d'acumular-hi el producte.
+        void ScaleOutput(double beta, double* c, std::size_t count)
+        {
+            if (beta == 0.0) {
+                std::fill(c, c + count, 0.0);
+            }
+            else if (beta != 1.0) {
+                for (std::size_t i = 0; i < count; ++i) c[i] *= beta;
+            }
+        }
+
+        // Operacions lògiques de alpha * op(A) op(B) + beta * C, amb el mateix criteri que
+        // Multiply (K productes i K-1 sumes per element) més l'escalat i la suma de beta * C.
+        void CountGemm(std::size_t m, std::size_t n, std::size_t k, double alpha, double beta, OpsCounter* op)
+        {
+            if (!op || m == 0 || n == 0) return;
+            const std::size_t mn = m * n;
+            if (k > 0) {
+                op->IncMul(mn * k);
+                op->IncAdd(mn * (k - 1));
+            }
+            if (alpha != 1.0) op->IncMul(mn);
+            if (beta != 0.0) {
+                if (beta != 1.0) op->IncMul(mn);
+                op->IncAdd(mn);
+            }
+        }
+
+        // C += alpha * A * B (i-k-j per blocs: files contigües de B i C al bucle intern).
+        void KernelNN(double alpha, const double* A, const double* B, double* C, std::size_t m, std::size_t n, std::size_t k)
+        {
+            for (std::size_t kk = 0; kk < k; kk += kBlock) {
+                const std::size_t ke = std::min(kk + kBlock, k);
+                for (std::size_t jj = 0; jj < n; jj += kBlock) {
+                    const std::size_t je = std::min(jj + kBlock, n);
+                    for (std::size_t i = 0; i < m; ++i) {
+                        double* c = C + i * n;
+                        for (std::size_t p = kk; p < ke; ++p) {
+                            const double a = alpha * A[i * k + p];
+                            const double* b = B + p * n;
+                            for (std::size_t j = jj; j < je; ++j) c[j] += a * b[j];
+                        }
+                    }
+                }
+            }
+        }
+
+        // C += alpha * A^T * B, amb A (k x m): la fila p d'A i la de B s'usen senceres.
+        void KernelTN(double alpha, const double* A, const double* B, double* C, std::size_t m, std::size_t n, std::size_t k)
+        {
+            for (std::size_t ii = 0; ii < m; ii += kBlock) {
+                const std::size_t ie = std::min(ii + kBlock, m);
+                for (std::size_t p = 0; p < k; ++p) {
+                    const double* arow = A + p * m;
+                    const double* b = B + p * n;
+                    for (std::size_t i = ii; i < ie; ++i) {
+                        const double a = alpha * arow[i];
+                        double* c = C + i * n;
+                        for (std::size_t j = 0; j < n; ++j) c[j] += a * b[j];
+                    }
+                }
+            }
+        }
+
+        // C += alpha * A * B^T, amb B (n x k): cada element és un producte escalar de dues files.
+        void KernelNT(double alpha, const double* A, const double* B, double* C, std::size_t m, std::size_t n, std::size_t k)
+        {
+            for (std::size_t i = 0; i < m; ++i) {
+                const double* a = A + i * k;
+                double* c = C + i * n;
+                for (std::size_t j = 0; j < n; ++j) {
+                    const double* b = B + j * k;
+                    double acc = 0.0;
+                    for (std::size_t p = 0; p < k; ++p) acc += a[p] * b[p];
+                    c[j] += alpha * acc;
+                }
+            }
+        }
+
+        // C += alpha * A^T * B^T, amb A (k x m) i B (n x k). Transposem rajoles d'A a la pila
+        // per poder fer productes escalars contigus amb les files de B.
+        void KernelTT(double alpha, const double* A, const double* B, double* C, std::size_t m, std::size_t n, std::size_t k)
+        {
+            double tile[kBlock * kBlock];
+            for (std::size_t ii = 0; ii < m; ii += kBlock) {
+                const std::size_t ie = std::min(ii + kBlock, m);
+                for (std::size_t kk = 0; kk < k; kk += kBlock) {
+                    const std::size_t ke = std::min(kk + kBlock, k);
+                    for (std::size_t p = kk; p < ke; ++p) {
+                        for (std::size_t i = ii; i < ie; ++i) tile[(i - ii) * kBlock + (p - kk)] = A[p * m + i];
+                    }
+                    for (std::size_t i = ii; i < ie; ++i) {
+                        const double* a = tile + (i - ii) * kBlock;
+                        double* c = C + i * n;
+                        for (std::size_t j = 0; j < n; ++j) {
+                            const double* b = B + j * k + kk;
+                            double acc = 0.0;
+                            for (std::size_t p = 0; p < ke - kk; ++p) acc += a[p] * b[p];
+                            c[j] += alpha * acc;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    void Gemm(Trans ta, Trans tb, double alpha, const Matrix& A, const Matrix& B, double beta, Matrix& C, OpsCounter* op)
+    {
+        const std::size_t m = (ta == Trans::No) ? A.rows : A.cols;
+        const std::size_t k = (ta == Trans::No) ? A.cols : A.rows;
+        const std::size_t kb = (tb == Trans::No) ? B.rows : B.cols;
+        const std::size_t n = (tb == Trans::No) ? B.cols : B.rows;
+
+        if (k != kb || C.rows != m || C.cols != n) {
+            throw std::invalid_argument("Gemm: dimensions incompatibles");
+        }
+        if (&C == &A || &C == &B) {
+            throw std::invalid_argument("Gemm: C no pot compartir memoria amb A o B");
+        }
+
+        ScaleOutput(beta, C.a.data(), C.a.size());
+        CountGemm(m, n, k, alpha, beta, op);
+        if (m == 0 || n == 0 || k == 0 || alpha == 0.0) {
+            return;
+        }
+
+        const double* a = A.a.data();
+        const double* b = B.a.data();
+        double* c = C.a.data();
+        if (ta == Trans::No && tb == Trans::No) KernelNN(alpha, a, b, c, m, n, k);
+        else if (ta == Trans::Yes && tb == Trans::No) KernelTN(alpha, a, b, c, m, n, k);
+        else if (ta == Trans::No && tb == Trans::Yes) KernelNT(alpha, a, b, c, m, n, k);
+        else KernelTT(alpha, a, b, c, m, n, k);
+    }
+
+    void GemmParallel(Trans ta, Trans tb, double alpha, const Matrix& A, const Matrix& B, double beta, Matrix& C,
+        std::size_t threads, OpsCounter* op)
+    {
+        const std::size_t t = threads ? threads : HardwareThreads();
+        if (ta == Trans::Yes || t <= 1 || C.rows < 2 * kBlock) {
+            Gemm(ta, tb, alpha, A, B, beta, C, op);
+            return;
+        }
+
+        const std::size_t m = A.rows, k = A.cols;
+        const std::size_t kb = (tb == Trans::No) ? B.rows : B.cols;
+        const std::size_t n = (tb == Trans::No) ? B.cols : B.rows;
+        if (k != kb || C.rows != m || C.cols != n) {
+            throw std::invalid_argument("GemmParallel: dimensions incompatibles");
+        }
+        if (&C == &A || &C == &B) {
+            throw std::invalid_argument("GemmParallel: C no pot compartir memoria amb A o B");
+        }
+
+        ScaleOutput(beta, C.a.data(), C.a.size());
+        CountGemm(m, n, k, alpha, beta, op);
+        if (n == 0 || k == 0 || alpha == 0.0) {
+            return;
+        }
+
+        // Blocs de files contigus, un per fil: A i C avancen amb el mateix desplaçament.
+        ParallelFor(t, [&](std::size_t w) {
+            const std::size_t r0 = m * w / t, r1 = m * (w + 1) / t;
+            if (r0 == r1) return;
+            const double* a = A.a.data() + r0 * k;
+            double* c = C.a.data() + r0 * n;
+            if (tb == Trans::No) KernelNN(alpha, a, B.a.data(), c, r1 - r0, n, k);
+            else KernelNT(alpha, a, B.a.data(), c, r1 - r0, n, k);
+        }, t);
+    }
+
+    void Gemv(Trans ta, double alpha, const Matrix& A, const Vec& x, double beta, Vec& y, OpsCounter* op)
+    {
+        const std::size_t m = (ta == Trans::No) ? A.rows : A.cols;
+        const std::size_t k = (ta == Trans::No) ? A.cols : A.rows;
+        if (x.size() != k || y.size() != m) {
+            throw std::invalid_argument("Gemv: dimensions incompatibles");
+        }
+        if (&x == &y) {
+            throw std::invalid_argument("Gemv: x i y no poden ser el mateix vector");
+        }
+
+        ScaleOutput(beta, y.data(), y.size());
+        CountGemm(m, 1, k, alpha, beta, op);
+        if (m == 0 || k == 0 || alpha == 0.0) {
+            return;
+        }
+
+        const double* a = A.a.data();
+        if (ta == Trans::No) {
+            // y[i] += alpha * <A[i,:], x>
+            for (std::size_t i = 0; i < m; ++i) {
+                const double* row = a + i * k;
+                double acc = 0.0;
+                for (std::size_t p = 0; p < k; ++p) acc += row[p] * x[p];
+                y[i] += alpha * acc;
+            }
+        }
+        else {
+            // A^T x com a combinació de files: y += (alpha * x[p]) * A[p,:], sempre contigu.
+            for (std::size_t p = 0; p < k; ++p) {
+                const double s = alpha * x[p];
+                const double* row = a + p * m;
+                for (std::size_t i = 0; i < m; ++i) y[i] += s * row[i];
+            }
+        }
+    }
+}
@@ -1,4 +1,8 @@
 #include "DatasetIO.hpp"
+#include "Parallel.hpp"
+#include "Timer.hpp"
+#include <algorithm>
+#include <cstring>
 #include <fstream>
 #include <filesystem>
 
@@ -53,4 +57,390 @@ bool SaveVectorBin(const std::string& path, const Vec& v)
     const std::streamsize bytes = static_cast<std::streamsize>(v.size() * sizeof(double));
     f.write(reinterpret_cast<const char*>(v.data()), bytes);
     return bool(f);
-}
\ No newline at end of file
+}
+
+// ================= Contenidor comprimit (.lbz) =================
+// Capçalera de 64 bytes (little-endian):
+//   magic[8] | versio u32 | chunk_doubles u32 | mantissa_bits u32 | reservat u32 |
+//   rows u64 | cols u64 | count u64 | index_offset u64 | nchunks u64
+// Després, els blocs codificats un darrere l'altre i, al final, l'índex (offset u64, mida u64).
+// Cada bloc són 8 plans (byte p de cada double) i cada pla comença amb un byte de mode:
+//   0      constant: 1 byte
+//   1..7   diccionari: (distints - 1) u8, diccionari, índexs empaquetats a k bits (LSB primer)
+//   8      cru: m bytes
+//   9      esparsa: valor dominant u8, nombre d'excepcions (varint), parelles (salt varint, byte)
+
+namespace
+{
+    constexpr char kLbzMagic[8] = { 'L', 'A', 'L', 'Z', 'B', 'I', 'N', '1' };
+    constexpr std::size_t kLbzHeader = 64;
+    constexpr std::uint8_t kModeConst = 0, kModeRaw = 8, kModeSparse = 9;
+
+    void PutU32(std::uint8_t* p, std::uint32_t v) { for (int i = 0; i < 4; ++i) p[i] = std::uint8_t(v >> (8 * i)); }
+    void PutU64(std::uint8_t* p, std::uint64_t v) { for (int i = 0; i < 8; ++i) p[i] = std::uint8_t(v >> (8 * i)); }
+    std::uint32_t GetU32(const std::uint8_t* p) { std::uint32_t v = 0; for (int i = 0; i < 4; ++i) v |= std::uint32_t(p[i]) << (8 * i); return v; }
+    std::uint64_t GetU64(const std::uint8_t* p) { std::uint64_t v = 0; for (int i = 0; i < 8; ++i) v |= std::uint64_t(p[i]) << (8 * i); return v; }
+
+    void PutVarint(std::vector<std::uint8_t>& o, std::uint64_t v)
+    {
+        while (v >= 0x80) { o.push_back(std::uint8_t(v) | 0x80); v >>= 7; }
+        o.push_back(std::uint8_t(v));
+    }
+
+    bool GetVarint(const std::uint8_t*& p, const std::uint8_t* end, std::uint64_t& v)
+    {
+        v = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (p >= end) return false;
+            const std::uint8_t b = *p++;
+            v |= std::uint64_t(b & 0x7F) << shift;
+            if (!(b & 0x80)) return true;
+        }
+        return false;
+    }
+
+    // Arrodoneix la mantissa a 'bits' bits (al més proper). NaN i infinits no es toquen, i un
+    // arrodoniment que desbordaria a infinit es trunca.
+    double RoundMantissa(double x, int bits)
+    {
+        std::uint64_t u;
+        std::memcpy(&u, &x, sizeof u);
+        if (((u >> 52) & 0x7FF) == 0x7FF) return x;
+        const int drop = 52 - bits;
+        const std::uint64_t mask = (std::uint64_t(1) << drop) - 1;
+        std::uint64_t r = (u + (std::uint64_t(1) << (drop - 1))) & ~mask;
+        if (((r >> 52) & 0x7FF) == 0x7FF) r = u & ~mask;
+        std::memcpy(&x, &r, sizeof r);
+        return x;
+    }
+
+    // Codifica el pla format pels bytes b[0], b[8], b[16]... (m valors) amb el mode més curt.
+    void EncodePlane(const std::uint8_t* b, std::size_t m, std::vector<std::uint8_t>& out)
+    {
+        std::size_t hist[256] = {};
+        for (std::size_t i = 0; i < m; ++i) ++hist[b[8 * i]];
+        std::size_t distinct = 0, dominant = 0;
+        for (std::size_t v = 0; v < 256; ++v) {
+            if (hist[v]) ++distinct;
+            if (hist[v] > hist[dominant]) dominant = v;
+        }
+
+        if (distinct <= 1) {
+            out.push_back(kModeConst);
+            out.push_back(m ? b[0] : 0);
+            return;
+        }
+
+        unsigned k = 1;
+        while ((std::size_t(1) << k) < distinct) ++k;
+        const std::size_t raw_size = 1 + m;
+        const std::size_t dict_size = k < 8 ? 2 + distinct + (m * k + 7) / 8 : raw_size + 1;
+
+        // L'esparsa només val la pena amb poques excepcions; la construïm i la comparem.
+        const std::size_t exceptions = m - hist[dominant];
+        if (exceptions * 3 < std::min(raw_size, dict_size)) {
+            std::vector<std::uint8_t> sp;
+            sp.push_back(kModeSparse);
+            sp.push_back(std::uint8_t(dominant));
+            PutVarint(sp, exceptions);
+            std::size_t next = 0;
+            for (std::size_t i = 0; i < m; ++i) {
+                if (b[8 * i] == dominant) continue;
+                PutVarint(sp, i - next);
+                sp.push_back(b[8 * i]);
+                next = i + 1;
+            }
+            if (sp.size() < std::min(raw_size, dict_size)) {
+                out.insert(out.end(), sp.begin(), sp.end());
+                return;
+            }
+        }
+
+        if (dict_size < raw_size) {
+            std::uint8_t code[256] = {};
+            out.push_back(std::uint8_t(k));
+            out.push_back(std::uint8_t(distinct - 1));
+            std::uint8_t c = 0;
+            for (std::size_t v = 0; v < 256; ++v) {
+                if (!hist[v]) continue;
+                code[v] = c++;
+                out.push_back(std::uint8_t(v));
+            }
+            std::uint64_t acc = 0;
+            unsigned bits = 0;
+            for (std::size_t i = 0; i < m; ++i) {
+                acc |= std::uint64_t(code[b[8 * i]]) << bits;
+                bits += k;
+                while (bits >= 8) { out.push_back(std::uint8_t(acc)); acc >>= 8; bits -= 8; }
+            }
+            if (bits) out.push_back(std::uint8_t(acc));
+            return;
+        }
+
+        out.push_back(kModeRaw);
+        for (std::size_t i = 0; i < m; ++i) out.push_back(b[8 * i]);
+    }
+
+    // Inversa d'EncodePlane: escriu els m bytes del pla a d[0], d[8]... Retorna false si les dades
+    // són incoherents (no es llegeix mai fora de [p, end)).
+    bool DecodePlane(const std::uint8_t*& p, const std::uint8_t* end, std::uint8_t* d, std::size_t m)
+    {
+        if (p >= end) return false;
+        const std::uint8_t mode = *p++;
+        if (mode == kModeConst) {
+            if (p >= end) return false;
+            const std::uint8_t v = *p++;
+            for (std::size_t i = 0; i < m; ++i) d[8 * i] = v;
+            return true;
+        }
+        if (mode == kModeRaw) {
+            if (std::size_t(end - p) < m) return false;
+            for (std::size_t i = 0; i < m; ++i) d[8 * i] = p[i];
+            p += m;
+            return true;
+        }
+        if (mode == kModeSparse) {
+            if (p >= end) return false;
+            const std::uint8_t v = *p++;
+            std::uint64_t count;
+            if (!GetVarint(p, end, count) || count > m) return false;
+            for (std::size_t i = 0; i < m; ++i) d[8 * i] = v;
+            std::size_t pos = 0;
+            for (std::uint64_t e = 0; e < count; ++e) {
+                std::uint64_t gap;
+                if (!GetVarint(p, end, gap) || p >= end || gap >= m - pos) return false;
+                pos += std::size_t(gap);
+                d[8 * pos] = *p++;
+                ++pos;
+            }
+            return true;
+        }
+        if (mode >= 1 && mode <= 7) {
+            const unsigned k = mode;
+            if (p >= end) return false;
+            const std::size_t distinct = std::size_t(*p++) + 1;
+            const std::size_t packed = (m * k + 7) / 8;
+            if (std::size_t(end - p) < distinct + packed) return false;
+            std::uint8_t dict[256] = {};
+            std::memcpy(dict, p, distinct);
+            p += distinct;
+            const std::uint8_t* q = p;
+            const std::uint64_t mask = (std::uint64_t(1) << k) - 1;
+            std::uint64_t acc = 0;
+            unsigned bits = 0;
+            for (std::size_t i = 0; i < m; ++i) {
+                while (bits < k) { acc |= std::uint64_t(*q++) << bits; bits += 8; }
+                d[8 * i] = dict[acc & mask];
+                acc >>= k;
+                bits -= k;
+            }
+            p += packed;
+            return true;
+        }
+        return false;
+    }
+
+    std::vector<std::uint8_t> EncodeChunk(const double* x, std::size_t m, int mantissa_bits)
+    {
+        std::vector<double> rounded;
+        if (mantissa_bits < 52) {
+            rounded.assign(x, x + m);
+            for (double& v : rounded) v = RoundMantissa(v, mantissa_bits);
+            x = rounded.data();
+        }
+        // Byte-shuffle implícit: cada pla es llegeix amb pas 8 directament dels doubles.
+        const std::uint8_t* b = reinterpret_cast<const std::uint8_t*>(x);
+        std::vector<std::uint8_t> out;
+        out.reserve(m + 64);
+        for (int plane = 0; plane < 8; ++plane) EncodePlane(b + plane, m, out);
+        return out;
+    }
+
+    bool DecodeChunk(const std::uint8_t* p, std::size_t len, double* dst, std::size_t m)
+    {
+        const std::uint8_t* end = p + len;
+        std::uint8_t* d = reinterpret_cast<std::uint8_t*>(dst);
+        for (int plane = 0; plane < 8; ++plane) {
+            if (!DecodePlane(p, end, d + plane, m)) return false;
+        }
+        return p == end;
+    }
+}
+
+bool CompressedWriter::Open(const std::string& path, std::size_t cols, const CompressOptions& opt)
+{
+    std::error_code ec;
+    std::filesystem::create_directories(std::filesystem::path(path).parent_path(), ec);
+
+    opt_ = opt;
+    opt_.mantissa_bits = std::min(52, std::max(1, opt_.mantissa_bits));
+    opt_.chunk_doubles = std::max<std::size_t>(opt_.chunk_doubles, 1024);
+    cols_ = std::max<std::size_t>(cols, 1);
+    count_ = 0;
+    index_.clear();
+    pending_.clear();
+    pending_.reserve(opt_.chunk_doubles * (opt_.threads ? opt_.threads : LinAlg::HardwareThreads()));
+    ms_ = 0.0;
+    path_ = path;
+
+    f_.open(path, std::ios::binary | std::ios::trunc | std::ios::out);
+    const std::uint8_t zeros[kLbzHeader] = {};
+    f_.write(reinterpret_cast<const char*>(zeros), kLbzHeader);
+    offset_ = kLbzHeader;
+    ok_ = bool(f_);
+    return ok_;
+}
+
+void CompressedWriter::Write(const double* p, std::size_t count)
+{
+    Timer t;
+    t.Tic();
+    while (count) {
+        const std::size_t take = std::min(count, pending_.capacity() - pending_.size());
+        pending_.insert(pending_.end(), p, p + take);
+        p += take;
+        count -= take;
+        count_ += take;
+        if (pending_.size() == pending_.capacity()) Flush(false);
+    }
+    ms_ += t.TocMs();
+}
+
+void CompressedWriter::Flush(bool final_chunk)
+{
+    const std::size_t chunk = opt_.chunk_doubles;
+    const std::size_t n = final_chunk ? (pending_.size() + chunk - 1) / chunk : pending_.size() / chunk;
+    if (n == 0) return;
+
+    // Els blocs pendents es codifiquen en paral·lel i s'escriuen en ordre.
+    std::vector<std::vector<std::uint8_t>> enc(n);
+    LinAlg::ParallelFor(n, [&](std::size_t c) {
+        const std::size_t m = std::min(chunk, pending_.size() - c * chunk);
+        enc[c] = EncodeChunk(pending_.data() + c * chunk, m, opt_.mantissa_bits);
+    }, opt_.threads);
+    for (const auto& e : enc) {
+        f_.write(reinterpret_cast<const char*>(e.data()), std::streamsize(e.size()));
+        index_.push_back(offset_);
+        index_.push_back(e.size());
+        offset_ += e.size();
+    }
+    pending_.erase(pending_.begin(), pending_.begin() + std::min(pending_.size(), n * chunk));
+}
+
+bool CompressedWriter::Close(CompressStats* stats)
+{
+    if (!f_.is_open()) return false;
+    // Una fila incompleta deixaria un fitxer que cap lector acceptaria: el descartem.
+    if (count_ % cols_ != 0) {
+        f_.close();
+        std::error_code ec;
+        std::filesystem::remove(path_, ec);
+        return false;
+    }
+    Timer t;
+    t.Tic();
+    Flush(true);
+
+    std::vector<std::uint8_t> idx(index_.size() * 8);
+    for (std::size_t i = 0; i < index_.size(); ++i) PutU64(&idx[i * 8], index_[i]);
+    f_.write(reinterpret_cast<const char*>(idx.data()), std::streamsize(idx.size()));
+
+    std::uint8_t h[kLbzHeader] = {};
+    std::memcpy(h, kLbzMagic, 8);
+    PutU32(h + 8, 1);
+    PutU32(h + 12, std::uint32_t(opt_.chunk_doubles));
+    PutU32(h + 16, std::uint32_t(opt_.mantissa_bits));
+    PutU64(h + 24, count_ / cols_);
+    PutU64(h + 32, cols_);
+    PutU64(h + 40, count_);
+    PutU64(h + 48, offset_);
+    PutU64(h + 56, index_.size() / 2);
+    f_.seekp(0);
+    f_.write(reinterpret_cast<const char*>(h), kLbzHeader);
+    f_.close();
+    ms_ += t.TocMs();
+
+    if (stats) {
+        stats->raw_bytes = count_ * sizeof(double);
+        stats->stored_bytes = offset_ + idx.size();
+        stats->ms = ms_;
+    }
+    return ok_ && bool(f_);
+}
+
+bool SaveMatrixCompressed(const std::string& path, const Matrix& A, const CompressOptions& opt, CompressStats* stats)
+{
+    CompressedWriter w;
+    if (!w.Open(path, A.cols, opt)) return false;
+    w.Write(A.a.data(), A.a.size());
+    return w.Close(stats);
+}
+
+bool SaveVectorCompressed(const std::string& path, const Vec& v, const CompressOptions& opt, CompressStats* stats)
+{
+    CompressedWriter w;
+    if (!w.Open(path, 1, opt)) return false;
+    w.Write(v.data(), v.size());
+    return w.Close(stats);
+}
+
+bool LoadMatrixCompressed(const std::string& path, Matrix& A, std::size_t threads, CompressStats* stats)
+{
+    Timer t;
+    t.Tic();
+    std::ifstream f(path, std::ios::binary);
+    if (!f) return false;
+    f.seekg(0, std::ios::end);
+    const std::streamsize N = f.tellg();
+    if (N < std::streamsize(kLbzHeader)) return false;
+    f.seekg(0, std::ios::beg);
+    std::vector<std::uint8_t> buf(static_cast<std::size_t>(N));
+    if (!f.read(reinterpret_cast<char*>(buf.data()), N)) return false;
+
+    const std::uint8_t* h = buf.data();
+    if (std::memcmp(h, kLbzMagic, 8) != 0 || GetU32(h + 8) != 1) return false;
+    const std::size_t chunk = GetU32(h + 12);
+    const std::size_t rows = GetU64(h + 24), cols = GetU64(h + 32), count = GetU64(h + 40);
+    const std::size_t index_offset = GetU64(h + 48), nchunks = GetU64(h + 56);
+    if (chunk == 0 || rows * cols != count || (count + chunk - 1) / chunk != nchunks
+        || index_offset > buf.size() || (buf.size() - index_offset) / 16 < nchunks) {
+        return false;
+    }
+
+    Matrix M;
+    M.rows = rows;
+    M.cols = cols;
+    M.a.resize(count);
+    std::vector<char> ok(nchunks, 0);
+    LinAlg::ParallelFor(nchunks, [&](std::size_t c) {
+        const std::uint64_t off = GetU64(buf.data() + index_offset + 16 * c);
+        const std::uint64_t len = GetU64(buf.data() + index_offset + 16 * c + 8);
+        if (off < kLbzHeader || off > index_offset || len > index_offset - off) return;
+        const std::size_t m = std::min(chunk, count - c * chunk);
+        ok[c] = DecodeChunk(buf.data() + off, std::size_t(len), M.a.data() + c * chunk, m);
+    }, threads);
+    if (std::find(ok.begin(), ok.end(), 0) != ok.end()) return false;
+
+    A = std::move(M);
+    if (stats) {
+        stats->raw_bytes = count * sizeof(double);
+        stats->stored_bytes = buf.size();
+        stats->ms = t.TocMs();
+    }
+    return true;
+}
+
+bool LoadVectorCompressed(const std::string& path, Vec& v, std::size_t threads, CompressStats* stats)
+{
+    Matrix M;
+    if (!LoadMatrixCompressed(path, M, threads, stats)) return false;
+    v = std::move(M.a);
+    return true;
+}
+
+bool IsCompressedDataset(const std::string& path)
+{
+    std::ifstream f(path, std::ios::binary);
+    char magic[8] = {};
+    return f.read(magic, 8) && std::memcmp(magic, kLbzMagic, 8) == 0;
+}
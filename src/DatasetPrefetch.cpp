@@ -0,0 +1,242 @@
+#include "DatasetPrefetch.hpp"
+#include "Timer.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace LinAlg
+{
+
+    namespace
+    {
+        constexpr std::size_t kAlign = 4096;                    // alineació segura per a O_DIRECT
+        constexpr std::size_t kBounceBytes = std::size_t(4) << 20;
+
+        struct FreeDeleter { void operator()(void* p) const { std::free(p); } };
+        using Bounce = std::unique_ptr<char, FreeDeleter>;
+
+#if defined(__linux__) && defined(O_DIRECT)
+        // Lectura sense cache de pàgines: blocs alineats al buffer intermedi i còpia al Vec.
+        // Retorna false (sense tocar 'out') si el sistema de fitxers rebutja l'E/S directa.
+        bool ReadDirect(int fd, std::size_t size, Vec& out, Bounce& bounce)
+        {
+            if (!bounce) {
+                void* p = nullptr;
+                if (posix_memalign(&p, kAlign, kBounceBytes) != 0) return false;
+                bounce.reset(static_cast<char*>(p));
+            }
+            Vec data(size / sizeof(double));
+            char* dst = reinterpret_cast<char*>(data.data());
+            std::size_t off = 0;
+            while (off < size) {
+                const std::size_t want = std::min(kBounceBytes, (size - off + kAlign - 1) / kAlign * kAlign);
+                const ssize_t got = pread(fd, bounce.get(), want, off_t(off));
+                if (got <= 0) return false;
+                const std::size_t use = std::min(std::size_t(got), size - off);
+                std::memcpy(dst + off, bounce.get(), use);
+                off += use;
+                if (std::size_t(got) < want && off < size) return false;
+            }
+            out = std::move(data);
+            return true;
+        }
+#endif
+
+#if !defined(__linux__)
+        bool ReadPortable(const std::string& path, Vec& out)
+        {
+            std::ifstream f(path, std::ios::binary);
+            if (!f) return false;
+            f.seekg(0, std::ios::end);
+            const std::streamsize N = f.tellg();
+            if (N < 0 || N % std::streamsize(sizeof(double)) != 0) return false;
+            f.seekg(0, std::ios::beg);
+            out.resize(std::size_t(N) / sizeof(double));
+            return bool(f.read(reinterpret_cast<char*>(out.data()), N));
+        }
+#endif
+
+        bool ReadFile(const std::string& path, Vec& out, bool direct, Bounce& bounce, bool& used_direct)
+        {
+            used_direct = false;
+#if defined(__linux__)
+            const int fd = open(path.c_str(), O_RDONLY);
+            if (fd < 0) return false;
+            struct stat st;
+            if (fstat(fd, &st) != 0 || st.st_size % off_t(sizeof(double)) != 0) { close(fd); return false; }
+            const std::size_t size = std::size_t(st.st_size);
+
+#if defined(O_DIRECT)
+            if (direct && size > 0) {
+                const int dfd = open(path.c_str(), O_RDONLY | O_DIRECT);
+                if (dfd >= 0) {
+                    used_direct = ReadDirect(dfd, size, out, bounce);
+                    close(dfd);
+                    if (used_direct) { close(fd); return true; }
+                }
+            }
+#else
+            (void)direct; (void)bounce;
+#endif
+            // Lectura seqüencial normal directament sobre el Vec.
+#if defined(POSIX_FADV_SEQUENTIAL)
+            posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+            out.resize(size / sizeof(double));
+            char* dst = reinterpret_cast<char*>(out.data());
+            std::size_t off = 0;
+            while (off < size) {
+                const ssize_t got = read(fd, dst + off, size - off);
+                if (got <= 0) { close(fd); return false; }
+                off += std::size_t(got);
+            }
+            close(fd);
+            return true;
+#else
+            (void)direct; (void)bounce;
+            return ReadPortable(path, out);
+#endif
+        }
+
+        std::size_t JobBytes(const std::vector<std::string>& files)
+        {
+            std::size_t total = 0;
+            for (const std::string& f : files) {
+                std::error_code ec;
+                const auto s = std::filesystem::file_size(f, ec);
+                if (!ec) total += std::size_t(s);
+            }
+            return total;
+        }
+    }
+
+    Matrix PrefetchedJob::TakeMatrix(std::size_t i, std::size_t rows, std::size_t cols)
+    {
+        if (i >= buffers.size() || buffers[i].size() != rows * cols) {
+            throw std::invalid_argument("PrefetchedJob::TakeMatrix: mida incompatible");
+        }
+        Matrix M;
+        M.rows = rows;
+        M.cols = cols;
+        M.a = std::move(buffers[i]);
+        return M;
+    }
+
+    Vec PrefetchedJob::TakeVector(std::size_t i)
+    {
+        if (i >= buffers.size()) {
+            throw std::invalid_argument("PrefetchedJob::TakeVector: index fora de rang");
+        }
+        return std::move(buffers[i]);
+    }
+
+    DatasetPrefetcher::DatasetPrefetcher(std::vector<std::vector<std::string>> jobs, PrefetchConfig cfg)
+        : jobs_(std::move(jobs)), cfg_(cfg)
+    {
+        if (cfg_.depth == 0) cfg_.depth = 1;
+        io_ = std::thread(&DatasetPrefetcher::Run, this);
+    }
+
+    DatasetPrefetcher::~DatasetPrefetcher()
+    {
+        {
+            std::lock_guard<std::mutex> lk(mtx_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        io_.join();
+    }
+
+    void DatasetPrefetcher::Run()
+    {
+        Bounce bounce;
+        for (std::size_t j = 0; j < jobs_.size(); ++j) {
+            const std::size_t need = JobBytes(jobs_[j]);
+            {
+                // Esperem lloc a la cua i dins del pressupost (o que no hi hagi res retingut).
+                std::unique_lock<std::mutex> lk(mtx_);
+                cv_.wait(lk, [&] {
+                    return stop_ || (ready_.size() < cfg_.depth && (held_bytes_ == 0 || held_bytes_ + need <= cfg_.max_bytes));
+                });
+                if (stop_) return;
+                held_bytes_ += need;
+                stats_.peak_bytes = std::max(stats_.peak_bytes, held_bytes_);
+            }
+
+            PrefetchedJob job;
+            job.index = j;
+            job.ok = true;
+            job.bytes = need;
+            job.buffers.resize(jobs_[j].size());
+            job.loaded.assign(jobs_[j].size(), false);
+            std::size_t direct = 0, buffered = 0;
+            Timer t;
+            t.Tic();
+            for (std::size_t f = 0; f < jobs_[j].size(); ++f) {
+                bool used_direct = false;
+                if (!ReadFile(jobs_[j][f], job.buffers[f], cfg_.direct_io, bounce, used_direct)) {
+                    job.ok = false;
+                    job.missing.push_back(jobs_[j][f]);
+                    job.buffers[f].clear();
+                    continue;
+                }
+                job.loaded[f] = true;
+                ++(used_direct ? direct : buffered);
+            }
+            job.load_ms = t.TocMs();
+
+            {
+                std::lock_guard<std::mutex> lk(mtx_);
+                stats_.load_ms += job.load_ms;
+                stats_.direct_reads += direct;
+                stats_.buffered_reads += buffered;
+                ready_.push_back(std::move(job));
+            }
+            cv_.notify_all();
+        }
+    }
+
+    bool DatasetPrefetcher::Next(PrefetchedJob& out)
+    {
+        Timer t;
+        t.Tic();
+        std::unique_lock<std::mutex> lk(mtx_);
+
+        // El treball lliurat abans ja no compta: el consumidor l'ha acabat de fer servir.
+        held_bytes_ -= lent_bytes_;
+        lent_bytes_ = 0;
+        cv_.notify_all();
+
+        if (next_out_ >= jobs_.size()) {
+            return false;
+        }
+        cv_.wait(lk, [&] { return !ready_.empty(); });
+        out = std::move(ready_.front());
+        ready_.pop_front();
+        ++next_out_;
+        lent_bytes_ = out.bytes;
+
+        stats_.jobs += 1;
+        stats_.bytes += out.bytes;
+        stats_.wait_ms += t.TocMs();
+        lk.unlock();
+        cv_.notify_all();
+        return true;
+    }
+
+    PrefetchStats DatasetPrefetcher::Stats() const
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        return stats_;
+    }
+}
@@ -0,0 +1,128 @@
+#include "Determinant.hpp"
+#include "Parallel.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+namespace LinAlg
+{
+
+    LogDet LogDeterminant(const Matrix& LU, std::size_t swaps, OpsCounter* op)
+    {
+        if (!LU.IsSquare()) {
+            throw std::invalid_argument("LogDeterminant: la matriu ha de ser quadrada");
+        }
+
+        const std::size_t n = LU.rows;
+        LogDet d;
+        d.log_abs = 0.0;
+        d.sign = (swaps % 2) ? -1 : 1;
+        for (std::size_t k = 0; k < n; ++k) {
+            const double u = LU.a[k * n + k];
+            if (u == 0.0) {
+                return LogDet{};
+            }
+            if (u < 0.0) d.sign = -d.sign;
+            d.log_abs += std::log(std::abs(u));
+        }
+        if (op && n) {
+            op->IncCmp(n);
+            op->IncAdd(n - 1);
+        }
+        return d;
+    }
+
+    LogDet LogDeterminant(const LUFactors& F, OpsCounter* op)
+    {
+        // Una factorització aturada per un pivot < tol no té una U completa: la tractem com a det = 0.
+        if (F.singular) {
+            return LogDet{};
+        }
+        return LogDeterminant(F.LU, F.swaps, op);
+    }
+
+    double Determinant(const LUFactors& F, OpsCounter* op)
+    {
+        const LogDet d = LogDeterminant(F, op);
+        return d.sign == 0 ? 0.0 : d.sign * std::exp(d.log_abs);
+    }
+
+    Matrix Inverse(const LUFactors& F, std::size_t block, std::size_t threads, OpsCounter* op)
+    {
+        if (F.singular) {
+            throw std::invalid_argument("Inverse: factoritzacio singular");
+        }
+        if (block == 0) {
+            throw std::invalid_argument("Inverse: el bloc ha de ser > 0");
+        }
+
+        const std::size_t n = F.LU.rows;
+        Matrix X(n, n);
+        if (n == 0) {
+            return X;
+        }
+
+        // PA = LU => A^-1 = Y P amb Y = (LU)^-1. Si perm[i] és la fila d'A que acaba a la
+        // posició i, la columna i de Y és la columna perm[i] de A^-1.
+        std::vector<std::size_t> perm(n);
+        for (std::size_t i = 0; i < n; ++i) perm[i] = i;
+        for (std::size_t k = 0; k < F.piv.size(); ++k) std::swap(perm[k], perm[F.piv[k]]);
+
+        const double* lu = F.LU.a.data();
+        const std::size_t blocks = (n + block - 1) / block;
+        std::vector<OpsCounter> block_ops(op ? blocks : 0);
+
+        ParallelFor(blocks, [&](std::size_t bi) {
+            const std::size_t c0 = bi * block;
+            const std::size_t m = std::min(block, n - c0);
+
+            // B = columnes [c0, c0 + m) de la identitat, en row-major n x m. Les files < c0 són
+            // zero i es queden zero durant la substitució endavant: comencem a c0.
+            std::vector<double> B((n - c0) * m, 0.0);
+            for (std::size_t j = 0; j < m; ++j) B[j * m + j] = 1.0;
+            auto row = [&](std::size_t i) { return B.data() + (i - c0) * m; };
+
+            // L Z = B (L unitària).
+            for (std::size_t i = c0 + 1; i < n; ++i) {
+                double* row_i = row(i);
+                for (std::size_t k = c0; k < i; ++k) {
+                    const double l_ik = lu[i * n + k];
+                    const double* row_k = row(k);
+                    for (std::size_t j = 0; j < m; ++j) row_i[j] -= l_ik * row_k[j];
+                }
+            }
+
+            // U Y = Z. Les files < c0 de Z són zero però les de Y no: ampliem el bloc cap amunt.
+            std::vector<double> Y(n * m, 0.0);
+            std::copy(B.begin(), B.end(), Y.begin() + c0 * m);
+            for (std::size_t i = n; i-- > 0;) {
+                double* row_i = Y.data() + i * m;
+                for (std::size_t k = i + 1; k < n; ++k) {
+                    const double u_ik = lu[i * n + k];
+                    const double* row_k = Y.data() + k * m;
+                    for (std::size_t j = 0; j < m; ++j) row_i[j] -= u_ik * row_k[j];
+                }
+                const double u_ii = lu[i * n + i];
+                for (std::size_t j = 0; j < m; ++j) row_i[j] /= u_ii;
+            }
+
+            // Desfem la permutació: columna c0 + j de Y -> columna perm[c0 + j] de X.
+            for (std::size_t i = 0; i < n; ++i) {
+                const double* row_i = Y.data() + i * m;
+                for (std::size_t j = 0; j < m; ++j) X.a[i * n + perm[c0 + j]] = row_i[j];
+            }
+
+            if (op) {
+                OpsCounter& o = block_ops[bi];
+                const std::size_t rows = n - c0;    // files actives a la substitució endavant
+                o.IncMul(m * rows * (rows - 1) / 2);
+                o.IncSub(m * rows * (rows - 1) / 2);
+                o.IncMul(m * n * (n - 1) / 2);
+                o.IncSub(m * n * (n - 1) / 2);
+                o.IncDiv(m * n);
+            }
+        }, threads);
+
+        for (const OpsCounter& o : block_ops) op->Merge(o);
+        return X;
+    }
+}
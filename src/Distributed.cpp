@@ -0,0 +1,951 @@
+#include "Distributed.hpp"
+#include "Timer.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+#if !defined(_WIN32)
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <cstdio>
+#include <iostream>
+#endif
+
+namespace LinAlg
+{
+
+    namespace
+    {
+        using Bytes = std::vector<unsigned char>;
+
+        // Bústia d'un rang: una cua per (origen, etiqueta). Els dos backends hi deixen els
+        // missatges que arriben i Recv només n'hi treu.
+        class Mailbox
+        {
+        public:
+            explicit Mailbox(int sources) : closed_(std::size_t(sources), false) {}
+
+            void Push(int src, int tag, Bytes msg)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(m_);
+                    q_[{ src, tag }].push_back(std::move(msg));
+                }
+                cv_.notify_all();
+            }
+
+            void Pop(int src, int tag, void* out, std::size_t bytes)
+            {
+                std::unique_lock<std::mutex> lock(m_);
+                auto& q = q_[{ src, tag }];
+                cv_.wait(lock, [&] { return !q.empty() || closed_[std::size_t(src)]; });
+                if (q.empty()) {
+                    throw std::runtime_error("Transport: el rang " + std::to_string(src) + " s'ha desconnectat");
+                }
+                Bytes msg = std::move(q.front());
+                q.pop_front();
+                lock.unlock();
+                if (msg.size() != bytes) {
+                    throw std::runtime_error("Transport: mida de missatge inesperada");
+                }
+                if (bytes) std::memcpy(out, msg.data(), bytes);
+            }
+
+            void Close(int src)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(m_);
+                    closed_[std::size_t(src)] = true;
+                }
+                cv_.notify_all();
+            }
+
+        private:
+            std::mutex m_;
+            std::condition_variable cv_;
+            std::map<std::pair<int, int>, std::deque<Bytes>> q_;
+            std::vector<bool> closed_;
+        };
+
+        Bytes Copy(const void* data, std::size_t bytes)
+        {
+            const unsigned char* p = static_cast<const unsigned char*>(data);
+            return Bytes(p, p + bytes);
+        }
+    }
+
+    // ---------------------------------------------------------------------------------------
+    // Backend de memòria compartida
+
+    struct LocalFabric::State
+    {
+        std::vector<std::unique_ptr<Mailbox>> boxes;
+    };
+
+    namespace
+    {
+        class LocalTransport : public Transport
+        {
+        public:
+            LocalTransport(std::shared_ptr<LocalFabric::State> s, int rank) : s_(std::move(s)), rank_(rank) {}
+
+            int Rank() const override { return rank_; }
+            int Size() const override { return int(s_->boxes.size()); }
+
+            void Send(int dest, int tag, const void* data, std::size_t bytes) override
+            {
+                s_->boxes.at(std::size_t(dest))->Push(rank_, tag, Copy(data, bytes));
+                bytes_sent_ += bytes;
+                ++messages_sent_;
+            }
+
+            void Recv(int src, int tag, void* data, std::size_t bytes) override
+            {
+                s_->boxes[std::size_t(rank_)]->Pop(src, tag, data, bytes);
+            }
+
+        private:
+            std::shared_ptr<LocalFabric::State> s_;
+            int rank_;
+        };
+    }
+
+    LocalFabric::LocalFabric(int size) : state_(std::make_shared<State>())
+    {
+        if (size <= 0) {
+            throw std::invalid_argument("LocalFabric: cal almenys un rang");
+        }
+        for (int r = 0; r < size; ++r) state_->boxes.push_back(std::make_unique<Mailbox>(size));
+    }
+
+    LocalFabric::~LocalFabric() = default;
+
+    std::unique_ptr<Transport> LocalFabric::Endpoint(int rank)
+    {
+        if (rank < 0 || rank >= int(state_->boxes.size())) {
+            throw std::invalid_argument("LocalFabric: rang fora de rang");
+        }
+        return std::make_unique<LocalTransport>(state_, rank);
+    }
+
+    void LocalFabric::Close(int rank)
+    {
+        for (auto& box : state_->boxes) box->Close(rank);
+    }
+
+    void RunThreadRanks(int size, const std::function<void(Transport&)>& fn)
+    {
+        LocalFabric fabric(size);
+        std::vector<std::exception_ptr> errors(static_cast<std::size_t>(size));
+        std::vector<std::thread> pool;
+        for (int r = 0; r < size; ++r) {
+            pool.emplace_back([&, r] {
+                try {
+                    auto t = fabric.Endpoint(r);
+                    fn(*t);
+                }
+                catch (...) {
+                    errors[std::size_t(r)] = std::current_exception();
+                }
+                // Un cop acabat, ja no enviarà res més: qui encara n'esperi alguna cosa falla.
+                fabric.Close(r);
+            });
+        }
+        for (auto& th : pool) th.join();
+        for (auto& e : errors) {
+            if (e) std::rethrow_exception(e);
+        }
+    }
+
+    // ---------------------------------------------------------------------------------------
+    // Backend de sockets
+
+#if !defined(_WIN32)
+    namespace
+    {
+        bool WriteAll(int fd, const void* data, std::size_t bytes)
+        {
+            const char* p = static_cast<const char*>(data);
+            while (bytes > 0) {
+                ssize_t w = ::send(fd, p, bytes, MSG_NOSIGNAL);
+                if (w <= 0) return false;
+                p += w;
+                bytes -= std::size_t(w);
+            }
+            return true;
+        }
+
+        bool ReadAll(int fd, void* data, std::size_t bytes)
+        {
+            char* p = static_cast<char*>(data);
+            while (bytes > 0) {
+                ssize_t r = ::recv(fd, p, bytes, 0);
+                if (r <= 0) return false;
+                p += r;
+                bytes -= std::size_t(r);
+            }
+            return true;
+        }
+
+        // Capçalera de cada missatge al fil: etiqueta (4 bytes) i mida de la càrrega (8 bytes), empaquetades
+        // camp a camp perquè el farciment d'un struct no surti mai al socket. Ordre de bytes de la màquina:
+        // tots dos extrems són al mateix host.
+        constexpr std::size_t kFrameBytes = sizeof(std::int32_t) + sizeof(std::uint64_t);
+
+        void PackFrame(unsigned char* h, int tag, std::size_t bytes)
+        {
+            const std::int32_t t = std::int32_t(tag);
+            const std::uint64_t b = std::uint64_t(bytes);
+            std::memcpy(h, &t, sizeof(t));
+            std::memcpy(h + sizeof(t), &b, sizeof(b));
+        }
+
+        void UnpackFrame(const unsigned char* h, int& tag, std::size_t& bytes)
+        {
+            std::int32_t t;
+            std::uint64_t b;
+            std::memcpy(&t, h, sizeof(t));
+            std::memcpy(&b, h + sizeof(t), sizeof(b));
+            tag = int(t);
+            bytes = std::size_t(b);
+        }
+
+        class SocketTransport : public Transport
+        {
+        public:
+            SocketTransport(int rank, std::vector<int> fds)
+                : rank_(rank), fds_(std::move(fds)), box_(int(fds_.size()))
+            {
+                for (std::size_t q = 0; q < fds_.size(); ++q) send_m_.push_back(std::make_unique<std::mutex>());
+                for (std::size_t q = 0; q < fds_.size(); ++q) {
+                    if (int(q) != rank_) readers_.emplace_back([this, q] { ReadLoop(int(q)); });
+                }
+            }
+
+            ~SocketTransport() override
+            {
+                // Tancament ordenat: deixem d'escriure i esperem que cada parell faci el mateix, de
+                // manera que cap missatge encara en vol es perdi per un close() prematur.
+                for (int fd : fds_) {
+                    if (fd >= 0) ::shutdown(fd, SHUT_WR);
+                }
+                for (auto& th : readers_) th.join();
+                for (int fd : fds_) {
+                    if (fd >= 0) ::close(fd);
+                }
+            }
+
+            int Rank() const override { return rank_; }
+            int Size() const override { return int(fds_.size()); }
+
+            void Send(int dest, int tag, const void* data, std::size_t bytes) override
+            {
+                if (dest == rank_) {
+                    box_.Push(rank_, tag, Copy(data, bytes));
+                }
+                else {
+                    const int fd = fds_.at(std::size_t(dest));
+                    unsigned char h[kFrameBytes];
+                    PackFrame(h, tag, bytes);
+                    std::lock_guard<std::mutex> lock(*send_m_[std::size_t(dest)]);
+                    if (!WriteAll(fd, h, kFrameBytes) || !WriteAll(fd, data, bytes)) {
+                        throw std::runtime_error("Transport: no s'ha pogut enviar al rang " + std::to_string(dest));
+                    }
+                }
+                bytes_sent_ += bytes;
+                ++messages_sent_;
+            }
+
+            void Recv(int src, int tag, void* data, std::size_t bytes) override
+            {
+                box_.Pop(src, tag, data, bytes);
+            }
+
+        private:
+            void ReadLoop(int q)
+            {
+                const int fd = fds_[std::size_t(q)];
+                unsigned char h[kFrameBytes];
+                while (ReadAll(fd, h, kFrameBytes)) {
+                    int tag;
+                    std::size_t bytes;
+                    UnpackFrame(h, tag, bytes);
+                    Bytes msg(bytes);
+                    if (!ReadAll(fd, msg.data(), msg.size())) break;
+                    box_.Push(q, tag, std::move(msg));
+                }
+                box_.Close(q);
+            }
+
+            int rank_;
+            std::vector<int> fds_;
+            Mailbox box_;
+            std::vector<std::unique_ptr<std::mutex>> send_m_;
+            std::vector<std::thread> readers_;
+        };
+
+        sockaddr_in Loopback(int port)
+        {
+            sockaddr_in addr{};
+            addr.sin_family = AF_INET;
+            addr.sin_port = htons(std::uint16_t(port));
+            addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            return addr;
+        }
+
+        void NoDelay(int fd)
+        {
+            int one = 1;
+            ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        }
+    }
+
+    std::unique_ptr<Transport> ConnectLocalSockets(int rank, int size, int base_port, double timeout_s)
+    {
+        if (size <= 0 || rank < 0 || rank >= size || base_port <= 0 || base_port + size > 65535) {
+            return nullptr;
+        }
+        std::vector<int> fds(std::size_t(size), -1);
+        auto fail = [&](int listener) -> std::unique_ptr<Transport> {
+            if (listener >= 0) ::close(listener);
+            for (int fd : fds) {
+                if (fd >= 0) ::close(fd);
+            }
+            return nullptr;
+        };
+
+        // 1) Escoltem abans de connectar: el nucli accepta les connexions a la cua de listen()
+        //    encara que no haguem cridat accept(), així que l'ordre entre processos no importa.
+        int listener = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (listener < 0) return fail(-1);
+        int one = 1;
+        ::setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        sockaddr_in self = Loopback(base_port + rank);
+        if (::bind(listener, reinterpret_cast<sockaddr*>(&self), sizeof(self)) != 0 || ::listen(listener, size) != 0) {
+            return fail(listener);
+        }
+
+        // 2) Connectem amb els rangs més baixos (reintentant mentre no escoltin) i ens presentem.
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::duration<double>(timeout_s);
+        for (int q = 0; q < rank; ++q) {
+            sockaddr_in peer = Loopback(base_port + q);
+            for (;;) {
+                int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+                if (fd < 0) return fail(listener);
+                if (::connect(fd, reinterpret_cast<sockaddr*>(&peer), sizeof(peer)) == 0) {
+                    fds[std::size_t(q)] = fd;
+                    break;
+                }
+                ::close(fd);
+                if (std::chrono::steady_clock::now() > deadline) return fail(listener);
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+            const std::int32_t me = rank;
+            if (!WriteAll(fds[std::size_t(q)], &me, sizeof(me))) return fail(listener);
+        }
+
+        // 3) Acceptem els rangs més alts; cadascun ens diu qui és. El mateix termini val aquí: un
+        //    rang que no arriba mai (no s'ha pogut crear, no ha pogut escoltar o ha petat) no ha
+        //    de deixar els altres bloquejats a accept().
+        for (int k = rank + 1; k < size; ++k) {
+            const double left_ms = std::chrono::duration<double, std::milli>(deadline - std::chrono::steady_clock::now()).count();
+            pollfd pfd{ listener, POLLIN, 0 };
+            if (left_ms <= 0.0 || ::poll(&pfd, 1, int(std::ceil(left_ms))) <= 0 || !(pfd.revents & POLLIN)) {
+                return fail(listener);
+            }
+            int fd = ::accept(listener, nullptr, nullptr);
+            std::int32_t who = -1;
+            if (fd < 0) return fail(listener);
+            if (!ReadAll(fd, &who, sizeof(who)) || who <= rank || who >= size || fds[std::size_t(who)] >= 0) {
+                ::close(fd);
+                return fail(listener);
+            }
+            fds[std::size_t(who)] = fd;
+        }
+        ::close(listener);
+
+        for (int fd : fds) {
+            if (fd >= 0) NoDelay(fd);
+        }
+        return std::make_unique<SocketTransport>(rank, std::move(fds));
+    }
+
+    int SpawnRanks(int size, const std::function<int(int)>& fn)
+    {
+        if (size <= 0) return -1;
+
+        // El que hi hagi als buffers de sortida s'escriuria un cop per cada fill.
+        std::cout.flush();
+        std::fflush(nullptr);
+
+        std::vector<pid_t> kids;
+        for (int r = 1; r < size; ++r) {
+            pid_t pid = ::fork();
+            if (pid == 0) {
+                int rc = 1;
+                try {
+                    rc = fn(r);
+                }
+                catch (...) {
+                    rc = 1;
+                }
+                std::cout.flush();
+                std::fflush(nullptr);
+                ::_exit(rc);
+            }
+            if (pid < 0) break;
+            kids.push_back(pid);
+        }
+
+        int rc = int(kids.size()) == size - 1 ? 0 : 1;
+        try {
+            if (fn(0) != 0) rc = 1;
+        }
+        catch (...) {
+            rc = 1;
+        }
+        for (pid_t pid : kids) {
+            int status = 0;
+            if (::waitpid(pid, &status, 0) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0) rc = 1;
+        }
+        return rc;
+    }
+#else
+    std::unique_ptr<Transport> ConnectLocalSockets(int, int, int, double)
+    {
+        return nullptr;
+    }
+
+    int SpawnRanks(int, const std::function<int(int)>&)
+    {
+        return -1;
+    }
+#endif
+
+    // ---------------------------------------------------------------------------------------
+    // Graella i matriu distribuïda
+
+    ProcessGrid ProcessGrid::For(const Transport& t, int rows, int cols)
+    {
+        if (rows <= 0 || cols <= 0 || rows * cols != t.Size()) {
+            throw std::invalid_argument("ProcessGrid: la graella no coincideix amb el nombre de rangs");
+        }
+        ProcessGrid g;
+        g.rows = rows;
+        g.cols = cols;
+        g.myrow = t.Rank() / cols;
+        g.mycol = t.Rank() % cols;
+        return g;
+    }
+
+    ProcessGrid ProcessGrid::Square(const Transport& t)
+    {
+        const int p = t.Size();
+        int rows = int(std::sqrt(double(p)));
+        while (rows > 1 && p % rows != 0) --rows;
+        return For(t, rows, p / rows);
+    }
+
+    std::vector<std::size_t> DistMatrix::LocalIndices(std::size_t n, std::size_t nb, int p, int P)
+    {
+        std::vector<std::size_t> idx;
+        for (std::size_t b0 = std::size_t(p) * nb; b0 < n; b0 += std::size_t(P) * nb) {
+            for (std::size_t i = b0; i < std::min(n, b0 + nb); ++i) idx.push_back(i);
+        }
+        return idx;
+    }
+
+    DistMatrix DistMatrix::Create(std::size_t n, std::size_t nb, const ProcessGrid& g)
+    {
+        if (nb == 0) {
+            throw std::invalid_argument("DistMatrix: la mida de bloc ha de ser positiva");
+        }
+        DistMatrix A;
+        A.n = n;
+        A.nb = nb;
+        A.grid = g;
+        A.grow = LocalIndices(n, nb, g.myrow, g.rows);
+        A.gcol = LocalIndices(n, nb, g.mycol, g.cols);
+        A.local = Matrix(A.grow.size(), A.gcol.size(), 0.0);
+        return A;
+    }
+
+    DistMatrix DistMatrix::FromGlobal(const Matrix& A, std::size_t nb, const ProcessGrid& g)
+    {
+        if (!A.IsSquare()) {
+            throw std::invalid_argument("DistMatrix: la matriu ha de ser quadrada");
+        }
+        DistMatrix D = Create(A.rows, nb, g);
+        for (std::size_t li = 0; li < D.grow.size(); ++li) {
+            const double* src = A.a.data() + D.grow[li] * A.cols;
+            double* dst = D.local.a.data() + li * D.local.cols;
+            for (std::size_t lj = 0; lj < D.gcol.size(); ++lj) dst[lj] = src[D.gcol[lj]];
+        }
+        return D;
+    }
+
+    namespace
+    {
+        enum Tag : int
+        {
+            kTagGather = 1,
+            kTagMaxLoc,
+            kTagSwap,
+            kTagPanelRow,
+            kTagPivots,
+            kTagLPanel,
+            kTagUPanel,
+            kTagSum,
+            kTagSolve,
+        };
+
+        // Primer índex local amb índex global >= g (els índexs locals estan en ordre global).
+        std::size_t FirstLocal(const std::vector<std::size_t>& idx, std::size_t g)
+        {
+            return std::size_t(std::lower_bound(idx.begin(), idx.end(), g) - idx.begin());
+        }
+
+        int OwnerOf(std::size_t g, std::size_t nb, int P)
+        {
+            return int((g / nb) % std::size_t(P));
+        }
+
+        std::size_t LocalOf(std::size_t g, std::size_t nb, int P)
+        {
+            return (g / nb / std::size_t(P)) * nb + g % nb;
+        }
+
+        std::vector<int> RowGroup(const ProcessGrid& g, int r)
+        {
+            std::vector<int> group;
+            for (int c = 0; c < g.cols; ++c) group.push_back(g.RankOf(r, c));
+            return group;
+        }
+
+        std::vector<int> ColGroup(const ProcessGrid& g, int c)
+        {
+            std::vector<int> group;
+            for (int r = 0; r < g.rows; ++r) group.push_back(g.RankOf(r, c));
+            return group;
+        }
+
+        // Difusió lineal des de 'root' (membre del grup). Les graelles són petites i cada membre
+        // rep un sol missatge, així que un arbre no hi guanyaria res.
+        void Bcast(Transport& t, const std::vector<int>& group, int root, void* data, std::size_t bytes, int tag)
+        {
+            if (t.Rank() == root) {
+                for (int q : group) {
+                    if (q != root) t.Send(q, tag, data, bytes);
+                }
+            }
+            else {
+                t.Recv(root, tag, data, bytes);
+            }
+        }
+
+        // Suma element a element a 'root'; l'ordre de la suma és el del grup, fix a tots els rangs.
+        void ReduceSum(Transport& t, const std::vector<int>& group, int root, double* data, std::size_t count, int tag)
+        {
+            if (t.Rank() != root) {
+                t.Send(root, tag, data, count * sizeof(double));
+                return;
+            }
+            Vec part(count), total(count, 0.0);
+            for (int q : group) {
+                const double* src = data;
+                if (q != root) {
+                    t.Recv(q, tag, part.data(), count * sizeof(double));
+                    src = part.data();
+                }
+                for (std::size_t i = 0; i < count; ++i) total[i] += src[i];
+            }
+            std::copy(total.begin(), total.end(), data);
+        }
+
+        struct MaxLoc
+        {
+            double abs = -1.0;
+            double value = 0.0;
+            double row = 0.0;	// índex global (exacte en double fins a 2^53)
+        };
+
+        // El mateix criteri que la cerca del pivot seqüencial: més gran en valor absolut i, si
+        // empaten, la fila més baixa.
+        MaxLoc AllReduceMaxLoc(Transport& t, const std::vector<int>& group, MaxLoc mine, int tag)
+        {
+            const int root = group.front();
+            if (t.Rank() == root) {
+                for (int q : group) {
+                    if (q == root) continue;
+                    MaxLoc other;
+                    t.Recv(q, tag, &other, sizeof(other));
+                    if (other.abs > mine.abs || (other.abs == mine.abs && other.row < mine.row)) mine = other;
+                }
+            }
+            else {
+                t.Send(root, tag, &mine, sizeof(mine));
+            }
+            Bcast(t, group, root, &mine, sizeof(mine), tag);
+            return mine;
+        }
+
+        // Intercanvia les files globals i1 i i2 a les columnes locals [c0, c1) i [c2, c3) dins d'una
+        // columna de processos: si les dues files són del mateix procés és un swap local; si no,
+        // els dos propietaris s'envien el tram i cadascun es queda el de l'altre.
+        void SwapRowSegments(DistMatrix& A, Transport& t, std::size_t i1, std::size_t i2,
+            std::size_t c0, std::size_t c1, std::size_t c2, std::size_t c3, std::vector<double>& buf)
+        {
+            const ProcessGrid& g = A.grid;
+            const int o1 = OwnerOf(i1, A.nb, g.rows), o2 = OwnerOf(i2, A.nb, g.rows);
+            if (g.myrow != o1 && g.myrow != o2) return;
+            const std::size_t w = (c1 - c0) + (c3 - c2);
+            if (w == 0) return;
+            const std::size_t ld = A.local.cols;
+            double* data = A.local.a.data();
+
+            if (o1 == o2) {
+                double* r1 = data + LocalOf(i1, A.nb, g.rows) * ld;
+                double* r2 = data + LocalOf(i2, A.nb, g.rows) * ld;
+                std::swap_ranges(r1 + c0, r1 + c1, r2 + c0);
+                std::swap_ranges(r1 + c2, r1 + c3, r2 + c2);
+                return;
+            }
+            const bool first = g.myrow == o1;
+            double* mine = data + LocalOf(first ? i1 : i2, A.nb, g.rows) * ld;
+            const int peer = g.RankOf(first ? o2 : o1, g.mycol);
+            buf.resize(w);
+            std::copy(mine + c0, mine + c1, buf.begin());
+            std::copy(mine + c2, mine + c3, buf.begin() + std::ptrdiff_t(c1 - c0));
+            t.Send(peer, kTagSwap, buf.data(), w * sizeof(double));
+            t.Recv(peer, kTagSwap, buf.data(), w * sizeof(double));
+            std::copy(buf.begin(), buf.begin() + std::ptrdiff_t(c1 - c0), mine + c0);
+            std::copy(buf.begin() + std::ptrdiff_t(c1 - c0), buf.end(), mine + c2);
+        }
+    }
+
+    Matrix DistMatrix::Gather(Transport& t, int root) const
+    {
+        if (t.Rank() != root) {
+            t.Send(root, kTagGather, local.a.data(), local.a.size() * sizeof(double));
+            return Matrix();
+        }
+        Matrix A(n, n, 0.0);
+        Matrix part;
+        for (int q = 0; q < t.Size(); ++q) {
+            const int pr = q / grid.cols, pc = q % grid.cols;
+            const auto rows = LocalIndices(n, nb, pr, grid.rows);
+            const auto cols = LocalIndices(n, nb, pc, grid.cols);
+            const Matrix* src = &local;
+            if (q != root) {
+                part = Matrix(rows.size(), cols.size(), 0.0);
+                t.Recv(q, kTagGather, part.a.data(), part.a.size() * sizeof(double));
+                src = &part;
+            }
+            for (std::size_t li = 0; li < rows.size(); ++li) {
+                for (std::size_t lj = 0; lj < cols.size(); ++lj) A.At(rows[li], cols[lj]) = src->At(li, lj);
+            }
+        }
+        return A;
+    }
+
+    bool LoadDistMatrixBin(const std::string& path, DistMatrix& A)
+    {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) return false;
+        in.seekg(0, std::ios::end);
+        if (std::size_t(in.tellg()) != A.n * A.n * sizeof(double)) return false;
+
+        // Els blocs de columnes locals són trams contigus de cada fila: una lectura per tram.
+        const std::size_t ld = A.local.cols;
+        for (std::size_t li = 0; li < A.grow.size(); ++li) {
+            for (std::size_t lj = 0; lj < A.gcol.size();) {
+                std::size_t len = 1;
+                while (lj + len < A.gcol.size() && A.gcol[lj + len] == A.gcol[lj] + len) ++len;
+                in.seekg(std::streamoff((A.grow[li] * A.n + A.gcol[lj]) * sizeof(double)));
+                in.read(reinterpret_cast<char*>(A.local.a.data() + li * ld + lj), std::streamsize(len * sizeof(double)));
+                if (!in) return false;
+                lj += len;
+            }
+        }
+        return true;
+    }
+
+    // ---------------------------------------------------------------------------------------
+    // Factorització
+
+    bool DistFactorizeLU(DistMatrix& A, std::vector<std::size_t>& piv, double tol, Transport& t)
+    {
+        const std::size_t n = A.n, nb = A.nb;
+        const ProcessGrid& g = A.grid;
+        piv.assign(n, 0);
+        for (std::size_t k = 0; k < n; ++k) piv[k] = k;
+
+        const std::size_t lr = A.grow.size(), lc = A.gcol.size(), ld = A.local.cols;
+        double* data = A.local.a.data();
+        const std::vector<int> my_row_group = RowGroup(g, g.myrow);
+        const std::vector<int> my_col_group = ColGroup(g, g.mycol);
+        std::vector<int> everyone(std::size_t(t.Size()));
+        for (int q = 0; q < t.Size(); ++q) everyone[std::size_t(q)] = q;
+
+        std::vector<double> buf, urow, Lbuf, Ubuf, pivmsg;
+
+        for (std::size_t k0 = 0; k0 < n; k0 += nb) {
+            const std::size_t kb = std::min(nb, n - k0), k1 = k0 + kb;
+            const int prK = OwnerOf(k0, nb, g.rows), pcK = OwnerOf(k0, nb, g.cols);
+            const std::size_t lc0 = FirstLocal(A.gcol, k0);    // columna local de k0 (si és meva)
+
+            // 1) Panell: la columna de processos pcK factoritza les columnes [k0, k1) sencera a
+            //    la vegada. pivmsg = {singular, piv[k0], ..., piv[k1-1]} per a la resta de rangs.
+            pivmsg.assign(kb + 1, 0.0);
+            if (g.mycol == pcK) {
+                const std::vector<int> col_group = ColGroup(g, pcK);
+                for (std::size_t j = k0; j < k1; ++j) {
+                    const std::size_t lj = lc0 + (j - k0);
+                    MaxLoc m;
+                    for (std::size_t li = FirstLocal(A.grow, j); li < lr; ++li) {
+                        const double v = data[li * ld + lj];
+                        if (std::abs(v) > m.abs) m = MaxLoc{ std::abs(v), v, double(A.grow[li]) };
+                    }
+                    m = AllReduceMaxLoc(t, col_group, m, kTagMaxLoc);
+                    if (!(m.abs > tol)) {
+                        pivmsg[0] = 1.0;  // Pivot massa petit: la matriu es considera singular.
+                        break;
+                    }
+                    const std::size_t p = std::size_t(m.row);
+                    pivmsg[1 + (j - k0)] = double(p);
+                    if (p != j) SwapRowSegments(A, t, j, p, lc0, lc0 + kb, 0, 0, buf);
+
+                    // Multiplicadors sota la diagonal i actualització de la resta del panell amb
+                    // la fila j, que difon el seu propietari dins de la columna de processos.
+                    const double pivot = m.value;
+                    const std::size_t li1 = FirstLocal(A.grow, j + 1);
+                    for (std::size_t li = li1; li < lr; ++li) data[li * ld + lj] /= pivot;
+                    const std::size_t w = k1 - j - 1;
+                    if (w == 0) continue;
+                    urow.resize(w);
+                    const int prj = OwnerOf(j, nb, g.rows);
+                    if (g.myrow == prj) {
+                        const double* src = data + LocalOf(j, nb, g.rows) * ld + lj + 1;
+                        std::copy(src, src + w, urow.begin());
+                    }
+                    Bcast(t, col_group, g.RankOf(prj, pcK), urow.data(), w * sizeof(double), kTagPanelRow);
+                    for (std::size_t li = li1; li < lr; ++li) {
+                        double* row = data + li * ld + lj;
+                        const double l = row[0];
+                        for (std::size_t c = 0; c < w; ++c) row[1 + c] -= l * urow[c];
+                    }
+                }
+            }
+            Bcast(t, everyone, g.RankOf(0, pcK), pivmsg.data(), pivmsg.size() * sizeof(double), kTagPivots);
+            if (pivmsg[0] != 0.0) {
+                return false;
+            }
+            for (std::size_t j = k0; j < k1; ++j) piv[j] = std::size_t(pivmsg[1 + (j - k0)]);
+
+            // 2) Intercanvis a la resta de columnes (a pcK, les del panell ja estan fetes).
+            for (std::size_t j = k0; j < k1; ++j) {
+                if (piv[j] == j) continue;
+                if (g.mycol == pcK) SwapRowSegments(A, t, j, piv[j], 0, lc0, lc0 + kb, lc, buf);
+                else SwapRowSegments(A, t, j, piv[j], 0, lc, 0, 0, buf);
+            }
+            if (k1 >= n) break;
+
+            // 3) Difusió de L (files >= k0 del panell) per files de processos.
+            const std::size_t liL = FirstLocal(A.grow, k0), rowsL = lr - liL;
+            Lbuf.resize(rowsL * kb);
+            if (g.mycol == pcK) {
+                for (std::size_t r = 0; r < rowsL; ++r) {
+                    const double* src = data + (liL + r) * ld + lc0;
+                    std::copy(src, src + kb, Lbuf.begin() + std::ptrdiff_t(r * kb));
+                }
+            }
+            Bcast(t, my_row_group, g.RankOf(g.myrow, pcK), Lbuf.data(), Lbuf.size() * sizeof(double), kTagLPanel);
+
+            // 4) U12 = L11^{-1} A12 a la fila de processos prK (L11 unitària: les primeres kb
+            //    files de Lbuf), i difusió per columnes de processos.
+            const std::size_t lcT = FirstLocal(A.gcol, k1), w = lc - lcT;
+            Ubuf.resize(kb * w);
+            if (g.myrow == prK) {
+                for (std::size_t r = 0; r < kb; ++r) {
+                    double* u = data + (liL + r) * ld + lcT;
+                    for (std::size_t s = 0; s < r; ++s) {
+                        const double l = Lbuf[r * kb + s];
+                        const double* us = data + (liL + s) * ld + lcT;
+                        for (std::size_t c = 0; c < w; ++c) u[c] -= l * us[c];
+                    }
+                    std::copy(u, u + w, Ubuf.begin() + std::ptrdiff_t(r * w));
+                }
+            }
+            Bcast(t, my_col_group, g.RankOf(prK, g.mycol), Ubuf.data(), Ubuf.size() * sizeof(double), kTagUPanel);
+
+            // 5) Complement de Schur local: A22 -= L21 U12 (bucle i-s-j, axpy contigus).
+            const std::size_t liT = FirstLocal(A.grow, k1);
+            for (std::size_t li = liT; li < lr; ++li) {
+                double* row = data + li * ld + lcT;
+                const double* l = Lbuf.data() + (li - liL) * kb;
+                for (std::size_t s = 0; s < kb; ++s) {
+                    const double ls = l[s];
+                    const double* u = Ubuf.data() + s * w;
+                    for (std::size_t c = 0; c < w; ++c) row[c] -= ls * u[c];
+                }
+            }
+        }
+        return true;
+    }
+
+    // ---------------------------------------------------------------------------------------
+    // Substitucions
+
+    void DistSolveFactorized(const DistMatrix& LU, const std::vector<std::size_t>& piv, Vec& b, Transport& t)
+    {
+        const std::size_t n = LU.n, nb = LU.nb;
+        if (b.size() != n || piv.size() != n) {
+            throw std::invalid_argument("DistSolveFactorized: dimensions incompatibles");
+        }
+        const ProcessGrid& g = LU.grid;
+        const std::size_t ld = LU.local.cols, lc = LU.gcol.size();
+        const double* data = LU.local.a.data();
+        std::vector<int> everyone(std::size_t(t.Size()));
+        for (int q = 0; q < t.Size(); ++q) everyone[std::size_t(q)] = q;
+
+        for (std::size_t k = 0; k < n; ++k) {
+            if (piv[k] != k) std::swap(b[k], b[piv[k]]);
+        }
+
+        // Per cada bloc de files K: la fila de processos prK suma les contribucions de les seves
+        // columnes ja resoltes, el propietari del bloc diagonal les redueix i resol el bloc, i la
+        // solució es difon a tots els rangs (b és replicat).
+        Vec part;
+        auto solve_block = [&](std::size_t k0, bool lower) {
+            const std::size_t kb = std::min(nb, n - k0), k1 = k0 + kb;
+            const int prK = OwnerOf(k0, nb, g.rows), pcK = OwnerOf(k0, nb, g.cols);
+            const int diag = g.RankOf(prK, pcK);
+            part.assign(kb, 0.0);
+            if (g.myrow == prK) {
+                const std::size_t li0 = LocalOf(k0, nb, g.rows);
+                const std::size_t c0 = lower ? 0 : FirstLocal(LU.gcol, k1);
+                const std::size_t c1 = lower ? FirstLocal(LU.gcol, k0) : lc;
+                for (std::size_t r = 0; r < kb; ++r) {
+                    const double* row = data + (li0 + r) * ld;
+                    double acc = 0.0;
+                    for (std::size_t c = c0; c < c1; ++c) acc += row[c] * b[LU.gcol[c]];
+                    part[r] = acc;
+                }
+                ReduceSum(t, RowGroup(g, prK), diag, part.data(), kb, kTagSum);
+            }
+            if (t.Rank() == diag) {
+                const std::size_t li0 = LocalOf(k0, nb, g.rows), lj0 = LocalOf(k0, nb, g.cols);
+                if (lower) {
+                    for (std::size_t r = 0; r < kb; ++r) {
+                        const double* row = data + (li0 + r) * ld + lj0;
+                        double acc = b[k0 + r] - part[r];
+                        for (std::size_t s = 0; s < r; ++s) acc -= row[s] * b[k0 + s];
+                        b[k0 + r] = acc;
+                    }
+                }
+                else {
+                    for (std::size_t r = kb; r-- > 0;) {
+                        const double* row = data + (li0 + r) * ld + lj0;
+                        double acc = b[k0 + r] - part[r];
+                        for (std::size_t s = r + 1; s < kb; ++s) acc -= row[s] * b[k0 + s];
+                        b[k0 + r] = acc / row[r];
+                    }
+                }
+            }
+            Bcast(t, everyone, diag, b.data() + k0, kb * sizeof(double), kTagSolve);
+        };
+
+        for (std::size_t k0 = 0; k0 < n; k0 += nb) solve_block(k0, true);
+        if (n == 0) return;
+        for (std::size_t k0 = ((n - 1) / nb) * nb;; k0 -= nb) {
+            solve_block(k0, false);
+            if (k0 == 0) break;
+        }
+    }
+
+    double DistRelativeResidual(const DistMatrix& A, const Vec& x, const Vec& b, Transport& t)
+    {
+        if (x.size() != A.n || b.size() != A.n) {
+            throw std::invalid_argument("DistRelativeResidual: dimensions incompatibles");
+        }
+        // Cada rang aporta el producte parcial de les seves files i columnes; la suma de tots
+        // els vectors parcials dona A x sencer al rang 0, que en calcula el residu i el difon.
+        Vec ax(A.n, 0.0);
+        for (std::size_t li = 0; li < A.grow.size(); ++li) {
+            const double* row = A.local.a.data() + li * A.local.cols;
+            double acc = 0.0;
+            for (std::size_t lj = 0; lj < A.gcol.size(); ++lj) acc += row[lj] * x[A.gcol[lj]];
+            ax[A.grow[li]] = acc;
+        }
+        std::vector<int> everyone(std::size_t(t.Size()));
+        for (int q = 0; q < t.Size(); ++q) everyone[std::size_t(q)] = q;
+        ReduceSum(t, everyone, 0, ax.data(), ax.size(), kTagSum);
+
+        double rr = 0.0;
+        if (t.Rank() == 0) {
+            double num = 0.0, den = 0.0;
+            for (std::size_t i = 0; i < A.n; ++i) {
+                const double r = ax[i] - b[i];
+                num += r * r;
+                den += b[i] * b[i];
+            }
+            rr = den > 0.0 ? std::sqrt(num / den) : std::sqrt(num);
+        }
+        Bcast(t, everyone, 0, &rr, sizeof(rr), kTagSum);
+        return rr;
+    }
+
+    DistSolveReport DistSolvePartialPivot(DistMatrix A, Vec b, double tol, Transport& t)
+    {
+        DistSolveReport report;
+        report.n = A.n;
+        if (b.size() != A.n) {
+            return report;
+        }
+        const std::size_t bytes0 = t.BytesSent(), msgs0 = t.MessagesSent();
+
+        // Còpia local per al residu: cada rang només en guarda la seva part.
+        const DistMatrix A_orig = A;
+        const Vec b_orig = b;
+
+        Timer timer, phase;
+        timer.Tic();
+        phase.Tic();
+        std::vector<std::size_t> piv;
+        const bool ok = DistFactorizeLU(A, piv, tol, t);
+        report.factor_ms = phase.TocMs();
+        if (!ok) {
+            report.singular = true;
+            report.ms = timer.TocMs();
+            report.bytes_sent = t.BytesSent() - bytes0;
+            report.messages = t.MessagesSent() - msgs0;
+            return report;
+        }
+        phase.Tic();
+        DistSolveFactorized(A, piv, b, t);
+        report.solve_ms = phase.TocMs();
+        report.ms = timer.TocMs();
+        report.x = std::move(b);
+        report.bytes_sent = t.BytesSent() - bytes0;
+        report.messages = t.MessagesSent() - msgs0;
+
+        report.rel_resid = DistRelativeResidual(A_orig, report.x, b_orig, t);
+        return report;
+    }
+}
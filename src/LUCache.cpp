@@ -0,0 +1,205 @@
+#include "LUCache.hpp"
+#include "Condition.hpp"
+#include "Determinant.hpp"
+#include "LinAlg.hpp"
+#include "Timer.hpp"
+#include <cstring>
+#include <stdexcept>
+
+namespace LinAlg
+{
+
+    static inline std::uint64_t Rotl(std::uint64_t x, int r)
+    {
+        return (x << r) | (x >> (64 - r));
+    }
+
+    static inline std::uint64_t Finalize(std::uint64_t x)
+    {
+        x ^= x >> 33; x *= 0xFF51AFD7ED558CCDull;
+        x ^= x >> 33; x *= 0xC4CEB9FE1A85EC53ull;
+        x ^= x >> 33;
+        return x;
+    }
+
+    MatrixKey HashMatrix(const Matrix& A, double tol)
+    {
+        MatrixKey key;
+        key.rows = A.rows;
+        key.cols = A.cols;
+        key.tol = tol;
+
+        // Dues cadenes independents sobre les paraules de 64 bits d'A (una sola lectura de memòria).
+        std::uint64_t h0 = 0x9E3779B97F4A7C15ull ^ A.rows;
+        std::uint64_t h1 = 0xD6E8FEB86659FD93ull ^ A.cols;
+        const double* p = A.a.data();
+        for (std::size_t i = 0; i < A.a.size(); ++i) {
+            std::uint64_t w;
+            std::memcpy(&w, p + i, sizeof(w));
+            h0 = Rotl(h0 ^ (w * 0x87C37B91114253D5ull), 31) * 0x4CF5AD432745937Full;
+            h1 = Rotl(h1 + (w * 0x52DCE729ull), 27) * 0x9E3779B97F4A7C15ull + w;
+        }
+        key.h0 = Finalize(h0 ^ A.a.size());
+        key.h1 = Finalize(h1 + h0);
+        return key;
+    }
+
+    static std::size_t EntryBytes(const Matrix& A, const LUFactors& F)
+    {
+        return sizeof(Matrix) + A.a.size() * sizeof(double)
+            + sizeof(LUFactors) + F.LU.a.size() * sizeof(double) + F.piv.size() * sizeof(std::size_t);
+    }
+
+    static bool SameContent(const Matrix& A, const Matrix& B)
+    {
+        return A.rows == B.rows && A.cols == B.cols && A.a.size() == B.a.size()
+            && (A.a.empty() || std::memcmp(A.a.data(), B.a.data(), A.a.size() * sizeof(double)) == 0);
+    }
+
+    LUCache::LUCache(std::size_t max_bytes) : max_bytes_(max_bytes)
+    {
+    }
+
+    std::shared_ptr<const LUFactors> LUCache::Lookup(const MatrixKey& key, const Matrix& A, FactorInfo* info)
+    {
+        std::shared_ptr<const Matrix> stored;
+        std::shared_ptr<const LUFactors> F;
+        FactorInfo found;
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            auto it = index_.find(key);
+            if (it == index_.end()) {
+                ++stats_.misses;
+                return nullptr;
+            }
+            // Candidat: l'entrada passa a ser la més recent. Ens quedem els punters perquè una
+            // expulsió concurrent no els alliberi mentre comparem.
+            lru_.splice(lru_.begin(), lru_, it->second);
+            stored = it->second->A;
+            F = it->second->F;
+            found = it->second->info;
+        }
+
+        const bool same = SameContent(*stored, A);
+        std::lock_guard<std::mutex> lock(mtx_);
+        if (!same) {
+            ++stats_.collisions;
+            ++stats_.misses;
+            return nullptr;
+        }
+        ++stats_.hits;
+        if (info) *info = found;
+        return F;
+    }
+
+    void LUCache::EvictToFit()
+    {
+        while (stats_.bytes > max_bytes_ && !lru_.empty()) {
+            const Entry& victim = lru_.back();
+            stats_.bytes -= victim.bytes;
+            index_.erase(victim.key);
+            lru_.pop_back();
+            ++stats_.evictions;
+        }
+        stats_.entries = lru_.size();
+    }
+
+    std::shared_ptr<const LUFactors> LUCache::Find(const Matrix& A, double tol, FactorInfo* info)
+    {
+        return Lookup(HashMatrix(A, tol), A, info);
+    }
+
+    void LUCache::Insert(const MatrixKey& key, std::shared_ptr<const Matrix> A, std::shared_ptr<const LUFactors> F, const FactorInfo& info)
+    {
+        std::size_t bytes = EntryBytes(*A, *F);
+        std::lock_guard<std::mutex> lock(mtx_);
+        if (bytes > max_bytes_) {
+            return;  // No hi cap mai: no té sentit buidar la cache per ella.
+        }
+
+        auto it = index_.find(key);
+        if (it != index_.end()) {
+            // Un altre fil l'ha inserida mentrestant (o és una col·lisió): ens quedem amb l'existent.
+            lru_.splice(lru_.begin(), lru_, it->second);
+            return;
+        }
+
+        lru_.push_front(Entry{ key, std::move(A), std::move(F), info, bytes });
+        index_[key] = lru_.begin();
+        stats_.bytes += bytes;
+        EvictToFit();
+    }
+
+    std::shared_ptr<const LUFactors> LUCache::GetOrFactorize(const Matrix& A, double tol, OpsCounter* op, bool* hit, FactorInfo* info)
+    {
+        MatrixKey key = HashMatrix(A, tol);
+        if (auto F = Lookup(key, A, info)) {
+            if (hit) *hit = true;
+            return F;
+        }
+        if (hit) *hit = false;
+
+        // La factorització (i els diagnòstics, O(n^2)) es fa fora del mutex per no bloquejar els altres fils.
+        auto F = std::make_shared<const LUFactors>(FactorizeLU(A, tol, op));
+        FactorInfo fi;
+        if (!F->singular) {
+            fi.cond1 = EstimateCond1(A, *F);
+            fi.pivot_growth = PivotGrowth(A, F->LU);
+        }
+        Insert(key, std::make_shared<const Matrix>(A), F, fi);
+        if (info) *info = fi;
+        return F;
+    }
+
+    CacheStats LUCache::Stats() const
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        return stats_;
+    }
+
+    void LUCache::Clear()
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        lru_.clear();
+        index_.clear();
+        stats_.bytes = 0;
+        stats_.entries = 0;
+    }
+
+    SolveReport SolveCached(LUCache& cache, const Matrix& A, Vec b, double tol)
+    {
+        SolveReport report;
+        report.n = A.rows;
+
+        if (!A.IsSquare() || b.size() != A.rows) {
+            return report;
+        }
+
+        Vec b_orig = b;
+
+        Timer timer;
+        timer.Tic();
+
+        FactorInfo info;
+        std::shared_ptr<const LUFactors> F = cache.GetOrFactorize(A, tol, &report.ops, nullptr, &info);
+        if (F->singular) {
+            report.singular = true;
+            report.ms = timer.TocMs();
+            return report;
+        }
+
+        SolveFactorized(*F, b, &report.ops);
+        report.x = std::move(b);
+        report.ms = timer.TocMs();
+
+        // El determinant surt gratis dels factors guardats (O(n)); condició i creixement, de l'entrada.
+        report.cond1 = info.cond1;
+        report.pivot_growth = info.pivot_growth;
+        const LogDet det = LogDeterminant(*F);
+        report.log_abs_det = det.log_abs;
+        report.det_sign = det.sign;
+
+        report.rel_resid = RelativeResidual(A, report.x, b_orig, nullptr);
+        return report;
+    }
+}
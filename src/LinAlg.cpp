@@ -5,8 +5,17 @@
 namespace LinAlg 
 {
 
-    double L2Norm(const Vec& v, OpsCounter* op) 
+    double L2Norm(const Vec& v, OpsCounter* op, AccumMode mode) 
     {
+        if (mode != AccumMode::Plain) {
+            // Mateixes operacions nominals que el bucle clàssic; només canvia com s'acumulen.
+            if (op && !v.empty()) {
+                op->IncMul(v.size());
+                op->IncAdd(v.size() - 1);
+            }
+            return std::sqrt(Dot(v.data(), v.data(), v.size(), mode));
+        }
+
         // Acumulador de la suma dels quadrats de cada component del vector.
         double sum = 0.0;
 
@@ -27,10 +36,34 @@ namespace LinAlg
         return std::sqrt(sum);
     }
 
-    double RelativeResidual(const Matrix& A, const Vec& x, const Vec& b, OpsCounter* op) 
+    double RelativeResidual(const Matrix& A, const Vec& x, const Vec& b, OpsCounter* op, AccumMode mode) 
     {
         // Residual relatiu definit com ||Ax - b||₂ / ||b||₂.
 
+        if (mode != AccumMode::Plain) {
+            if (A.cols != x.size() || A.rows != b.size()) {
+                throw std::invalid_argument("RelativeResidual: dimensions incompatibles");
+            }
+            // Cada r[i] = -b[i] + sum_j a[i, j] x[j] s'acumula sencer amb el mode triat: així la
+            // cancel·lació entre (Ax)[i] i b[i] no es produeix en aritmètica double plana.
+            Vec r(A.rows);
+            for (std::size_t i = 0; i < A.rows; ++i) {
+                r[i] = Dot(A.a.data() + i * A.cols, x.data(), A.cols, mode, -b[i]);
+            }
+            if (op && A.cols) {
+                op->IncMul(A.rows * A.cols);
+                op->IncAdd(A.rows * (A.cols - 1));
+                op->IncSub(A.rows);
+            }
+            const double norm_r = L2Norm(r, op, mode);
+            const double norm_b = L2Norm(b, op, mode);
+            if (norm_b == 0.0) {
+                return norm_r;
+            }
+            if (op) op->IncDiv();
+            return norm_r / norm_b;
+        }
+
         // Pas 1: construïm el producte Ax.
         Vec Ax = A.Multiply(x, op);
 
@@ -0,0 +1,197 @@
+#include "LowRankUpdate.hpp"
+#include "Condition.hpp"
+#include "LinAlg.hpp"
+#include "Timer.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace LinAlg
+{
+
+    // A + U V^T construïda explícitament (només per al camí de refactorització).
+    static Matrix AddLowRank(const Matrix& A, const Matrix& U, const Matrix& V, OpsCounter* op)
+    {
+        const std::size_t n = A.rows, k = U.cols;
+        Matrix M = A;
+        for (std::size_t i = 0; i < n; ++i) {
+            double* row = M.a.data() + i * n;
+            for (std::size_t p = 0; p < k; ++p) {
+                const double u = U.a[i * k + p];
+                const double* v = V.a.data() + p;
+                for (std::size_t j = 0; j < n; ++j) row[j] += u * v[j * k];
+            }
+        }
+        if (op) {
+            op->IncMul(n * n * k);
+            op->IncAdd(n * n * k);
+        }
+        return M;
+    }
+
+    RankUpdate UpdateLowRank(std::shared_ptr<const LUFactors> F, const Matrix& A, const Matrix& U, const Matrix& V,
+        double max_cond, OpsCounter* op)
+    {
+        const std::size_t n = A.rows;
+        const std::size_t k = U.cols;
+        if (!F || !A.IsSquare() || F->LU.rows != n || U.rows != n || V.rows != n || V.cols != k) {
+            throw std::invalid_argument("UpdateLowRank: dimensions incompatibles");
+        }
+
+        RankUpdate W;
+        W.base = F;
+        W.U = U;
+        W.V = V;
+
+        auto refactor = [&]() {
+            W.full = std::make_shared<const LUFactors>(FactorizeLU(AddLowRank(A, U, V, op), F->tol, op));
+            W.refactored = true;
+            return W;
+        };
+
+        // Sense una base vàlida Woodbury no té sentit.
+        if (F->singular) {
+            return refactor();
+        }
+
+        // Z = A^-1 U: k resolucions triangulars en una sola passada multi-RHS, O(n^2 k).
+        W.Z = U;
+        SolveFactorized(*F, W.Z, op);
+
+        // C = I + V^T Z (k x k), recorrent V i Z per files.
+        Matrix C = Matrix::Identity(k);
+        for (std::size_t i = 0; i < n; ++i) {
+            const double* v = V.a.data() + i * k;
+            const double* z = W.Z.a.data() + i * k;
+            for (std::size_t p = 0; p < k; ++p) {
+                for (std::size_t q = 0; q < k; ++q) C.a[p * k + q] += v[p] * z[q];
+            }
+        }
+        if (op) {
+            op->IncMul(n * k * k);
+            op->IncAdd(n * k * k);
+        }
+
+        // Si C és (quasi) singular o mal condicionada, l'actualització amplificaria l'error.
+        W.cap = FactorizeLU(C, F->tol, op);
+        if (W.cap.singular) {
+            W.cap_cond = INFINITY;
+            return refactor();
+        }
+        Matrix Cinv = Matrix::Identity(k);
+        SolveFactorized(W.cap, Cinv, op);
+        W.cap_cond = Norm1(C) * Norm1(Cinv);
+        if (!(W.cap_cond <= max_cond)) {
+            return refactor();
+        }
+
+        return W;
+    }
+
+    void SolveLowRank(const RankUpdate& W, Vec& b, OpsCounter* op)
+    {
+        if (W.refactored) {
+            SolveFactorized(*W.full, b, op);
+            return;
+        }
+
+        const std::size_t n = W.base->LU.rows;
+        const std::size_t k = W.U.cols;
+
+        // y = A^-1 b
+        SolveFactorized(*W.base, b, op);
+
+        // t = C^-1 (V^T y)
+        Vec t(k, 0.0);
+        for (std::size_t i = 0; i < n; ++i) {
+            const double* v = W.V.a.data() + i * k;
+            for (std::size_t p = 0; p < k; ++p) t[p] += v[p] * b[i];
+        }
+        if (op) {
+            op->IncMul(n * k);
+            op->IncAdd(n * k);
+        }
+        SolveFactorized(W.cap, t, op);
+
+        // x = y - Z t
+        for (std::size_t i = 0; i < n; ++i) {
+            const double* z = W.Z.a.data() + i * k;
+            double acc = 0.0;
+            for (std::size_t p = 0; p < k; ++p) acc += z[p] * t[p];
+            b[i] -= acc;
+        }
+        if (op) {
+            op->IncMul(n * k);
+            op->IncAdd(n * k);
+            op->IncSub(n);
+        }
+    }
+
+    // ||(A + U V^T) x - b|| / ||b|| sense formar A + U V^T.
+    static double UpdatedResidual(const Matrix& A, const Matrix& U, const Matrix& V, const Vec& x, const Vec& b)
+    {
+        const std::size_t n = A.rows, k = U.cols;
+        Vec r = A.Multiply(x, nullptr);
+        Vec t(k, 0.0);
+        for (std::size_t i = 0; i < n; ++i) {
+            for (std::size_t p = 0; p < k; ++p) t[p] += V.a[i * k + p] * x[i];
+        }
+        for (std::size_t i = 0; i < n; ++i) {
+            for (std::size_t p = 0; p < k; ++p) r[i] += U.a[i * k + p] * t[p];
+            r[i] -= b[i];
+        }
+        double norm_b = L2Norm(b, nullptr);
+        double norm_r = L2Norm(r, nullptr);
+        return norm_b == 0.0 ? norm_r : norm_r / norm_b;
+    }
+
+    SolveReport SolveUpdated(std::shared_ptr<const LUFactors> F, const Matrix& A, const Matrix& U, const Matrix& V,
+        Vec b, double max_cond, double max_resid, bool* refactored)
+    {
+        SolveReport report;
+        report.n = A.rows;
+        if (refactored) *refactored = false;
+
+        if (!A.IsSquare() || b.size() != A.rows) {
+            return report;
+        }
+
+        Vec b_orig = b;
+
+        Timer timer;
+        timer.Tic();
+
+        RankUpdate W = UpdateLowRank(F, A, U, V, max_cond, &report.ops);
+        if (W.refactored && W.full->singular) {
+            report.singular = true;
+            report.ms = timer.TocMs();
+            if (refactored) *refactored = true;
+            return report;
+        }
+
+        SolveLowRank(W, b, &report.ops);
+        report.ms = timer.TocMs();
+        report.rel_resid = UpdatedResidual(A, U, V, b, b_orig);
+
+        // Darrera xarxa de seguretat: si Woodbury ha perdut precisió, refactoritzem.
+        if (!W.refactored && !(report.rel_resid <= max_resid)) {
+            timer.Tic();
+            LUFactors full = FactorizeLU(AddLowRank(A, U, V, &report.ops), F->tol, &report.ops);
+            W.refactored = true;
+            if (full.singular) {
+                report.singular = true;
+                report.ms += timer.TocMs();
+                if (refactored) *refactored = true;
+                return report;
+            }
+            b = b_orig;
+            SolveFactorized(full, b, &report.ops);
+            report.ms += timer.TocMs();
+            report.rel_resid = UpdatedResidual(A, U, V, b, b_orig);
+        }
+
+        if (refactored) *refactored = W.refactored;
+        report.x = std::move(b);
+        return report;
+    }
+}
@@ -1,4 +1,6 @@
 #include "Matrix.hpp"
+#include "PerfCounters.hpp"
+#include "Progress.hpp"
 #include <stdexcept>
 
 Matrix Matrix::Identity(std::size_t n) 
@@ -26,6 +28,7 @@ Vec Matrix::Multiply(const Vec& x, OpsCounter* op) const
     if (cols != x.size()) {
         throw std::invalid_argument("Matrix::Multiply(mat-vec): dimensions incompatibles");
     }
+    LinAlg::MultiplyHwRecord hw;    // només mesura si els comptadors hardware estan activats
 
     Vec y(rows);
     if (rows == 0 || cols == 0) {
@@ -51,11 +54,12 @@ Vec Matrix::Multiply(const Vec& x, OpsCounter* op) const
     return y;
 }
 
-Matrix Matrix::Multiply(const Matrix& B, OpsCounter* op) const 
+Matrix Matrix::Multiply(const Matrix& B, OpsCounter* op, LinAlg::ProgressToken* progress) const 
 {
     if (cols != B.rows) {
         throw std::invalid_argument("Matrix::Multiply(mat-mat): dimensions incompatibles");
     }
+    LinAlg::MultiplyHwRecord hw;    // només mesura si els comptadors hardware estan activats
 
     Matrix C(rows, B.cols);
     if (rows == 0 || cols == 0 || B.cols == 0) {
@@ -64,6 +68,11 @@ Matrix Matrix::Multiply(const Matrix& B, OpsCounter* op) const
 
     // Simple triple bucle, amb comptatge d'operacions
     for (std::size_t i = 0; i < rows; ++i) {
+        // Punt de control per fila: si ens cancel·len, C queda a mitges i qui crida ho ha de descartar.
+        if (progress) {
+            if (progress->Cancelled()) return C;
+            progress->Set(double(i) / double(rows));
+        }
         const std::size_t a_row_offset = i * cols;
         for (std::size_t k = 0; k < B.cols; ++k) {
             // Primer producte fora del bucle per evitar suma innecessària
@@ -80,6 +89,7 @@ Matrix Matrix::Multiply(const Matrix& B, OpsCounter* op) const
             C.At(i, k) = acc;
         }
     }
+    if (progress) progress->Set(1.0);
 
     return C;
 }
@@ -0,0 +1,158 @@
+#include "PerfCounters.hpp"
+#include <atomic>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstring>
+#endif
+
+namespace LinAlg
+{
+
+    static std::atomic<bool> g_enabled{ false };
+    static thread_local HwCounters t_last_multiply;
+
+    void SetHwCountersEnabled(bool on)
+    {
+        g_enabled.store(on, std::memory_order_relaxed);
+    }
+
+    bool HwCountersEnabled()
+    {
+        return g_enabled.load(std::memory_order_relaxed);
+    }
+
+    HwCounters LastMultiplyCounters()
+    {
+        return t_last_multiply;
+    }
+
+    void SetLastMultiplyCounters(const HwCounters& c)
+    {
+        t_last_multiply = c;
+    }
+
+    MultiplyHwRecord::MultiplyHwRecord()
+    {
+        if (HwCountersEnabled()) scope_.emplace(&c_);
+    }
+
+    MultiplyHwRecord::~MultiplyHwRecord()
+    {
+        if (!scope_) return;
+        scope_.reset();     // tanca els comptadors i omple c_
+        SetLastMultiplyCounters(c_);
+    }
+
+#if defined(__linux__)
+
+    namespace
+    {
+        struct EventDesc { std::uint32_t type; std::uint64_t config; };
+
+        constexpr std::uint64_t CacheMiss(std::uint64_t cache)
+        {
+            return cache | (std::uint64_t(PERF_COUNT_HW_CACHE_OP_READ) << 8) | (std::uint64_t(PERF_COUNT_HW_CACHE_RESULT_MISS) << 16);
+        }
+
+        // Mateix ordre que els camps de HwCounters.
+        const EventDesc kEvents[6] = {
+            { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+            { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+            { PERF_TYPE_HW_CACHE, CacheMiss(PERF_COUNT_HW_CACHE_L1D) },
+            { PERF_TYPE_HW_CACHE, CacheMiss(PERF_COUNT_HW_CACHE_LL) },
+            { PERF_TYPE_HW_CACHE, CacheMiss(PERF_COUNT_HW_CACHE_DTLB) },
+            { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+        };
+
+        int OpenEvent(const EventDesc& e)
+        {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = e.type;
+            attr.config = e.config;
+            attr.disabled = 1;
+            attr.inherit = 1;           // inclou els fils creats dins del tram (ParallelFor)
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            return int(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+        }
+    }
+
+    bool HwCountersAvailable()
+    {
+        static const bool available = [] {
+            int fd = OpenEvent(kEvents[0]);
+            if (fd < 0) return false;
+            close(fd);
+            return true;
+        }();
+        return available;
+    }
+
+    HwScope::HwScope(HwCounters* dest) : dest_(dest)
+    {
+        for (int& fd : fds_) fd = -1;
+        if (!dest_ || !HwCountersEnabled() || !HwCountersAvailable()) return;
+
+        for (int i = 0; i < 6; ++i) {
+            fds_[i] = OpenEvent(kEvents[i]);   // els que no existeixin es queden a -1 (valor 0)
+            if (fds_[i] >= 0) active_ = true;
+        }
+        for (int fd : fds_) {
+            if (fd < 0) continue;
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+
+    HwScope::~HwScope()
+    {
+        if (!active_) return;
+
+        std::uint64_t values[6] = {};
+        for (int i = 0; i < 6; ++i) {
+            if (fds_[i] < 0) continue;
+            ioctl(fds_[i], PERF_EVENT_IOC_DISABLE, 0);
+            std::uint64_t buf[3] = {};   // valor, temps habilitat, temps en marxa
+            if (read(fds_[i], buf, sizeof(buf)) == ssize_t(sizeof(buf))) {
+                // Si el PMU s'ha multiplexat, extrapolem al temps total.
+                values[i] = (buf[2] > 0 && buf[2] < buf[1]) ? std::uint64_t(double(buf[0]) * double(buf[1]) / double(buf[2])) : buf[0];
+            }
+            close(fds_[i]);
+        }
+
+        HwCounters c;
+        c.valid = true;
+        c.cycles = values[0];
+        c.instructions = values[1];
+        c.l1d_misses = values[2];
+        c.llc_misses = values[3];
+        c.dtlb_misses = values[4];
+        c.branch_misses = values[5];
+        dest_->Merge(c);
+    }
+
+#else
+
+    bool HwCountersAvailable()
+    {
+        return false;
+    }
+
+    HwScope::HwScope(HwCounters* dest) : dest_(dest)
+    {
+        for (int& fd : fds_) fd = -1;
+    }
+
+    HwScope::~HwScope()
+    {
+    }
+
+#endif
+}
@@ -0,0 +1,345 @@
+#include "Pivoting.hpp"
+#include "Parallel.hpp"
+#include <algorithm>
+#include <cmath>
+#include <optional>
+
+namespace LinAlg
+{
+
+    namespace
+    {
+        // Per sota d'aquestes mides, crear fils costa més que la feina que s'hi reparteix.
+        constexpr std::size_t kParallelSearch = std::size_t(1) << 16;     // elements del submatriu
+        constexpr std::size_t kParallelUpdate = std::size_t(1) << 15;
+
+        // El millor de dos candidats: més gran en valor absolut; si empaten, el primer en ordre de files.
+        PivotChoice Better(const PivotChoice& a, const PivotChoice& b)
+        {
+            if (b.value > a.value) return b;
+            if (b.value == a.value && (b.row < a.row || (b.row == a.row && b.col < a.col))) return b;
+            return a;
+        }
+
+        // Màxim de les files [r0, r1) del submatriu A[.., k:]: argmax contigu per fila.
+        PivotChoice SearchRows(const double* data, std::size_t ld, std::size_t k, std::size_t r0, std::size_t r1)
+        {
+            PivotChoice best{ r0, k, -1.0 };
+            for (std::size_t i = r0; i < r1; ++i) {
+                const double* row = data + i * ld + k;
+                const std::size_t j = ArgMaxAbs(row, ld - k);
+                const double v = std::abs(row[j]);
+                if (v > best.value) best = PivotChoice{ i, k + j, v };
+            }
+            return best;
+        }
+
+        PivotChoice SearchComplete(const Matrix& A, std::size_t k, std::size_t threads, WorkerPool* pool)
+        {
+            const std::size_t n = A.rows, rows = n - k;
+            const double* data = A.a.data();
+            std::size_t t = std::min(rows, pool ? pool->Size() : (threads ? threads : HardwareThreads()));
+            if (t <= 1 || rows * (A.cols - k) < kParallelSearch) {
+                return SearchRows(data, A.cols, k, k, n);
+            }
+
+            // Cada fil redueix un bloc contigu de files; després combinem per parelles (log2 t nivells)
+            // sempre amb el bloc de l'esquerra primer, que conserva el desempat de la versió sèrie.
+            std::vector<PivotChoice> part(t);
+            auto search = [&](std::size_t w) {
+                part[w] = SearchRows(data, A.cols, k, k + rows * w / t, k + rows * (w + 1) / t);
+            };
+            if (pool) pool->Run(t, [&](std::size_t, std::size_t w0, std::size_t w1) { for (std::size_t w = w0; w < w1; ++w) search(w); });
+            else ParallelFor(t, search, t);
+            for (std::size_t step = 1; step < t; step *= 2) {
+                for (std::size_t i = 0; i + step < t; i += 2 * step) part[i] = Better(part[i], part[i + step]);
+            }
+            return part[0];
+        }
+
+        PivotChoice SearchRook(const Matrix& A, std::size_t k, OpsCounter* op)
+        {
+            const std::size_t n = A.rows, ld = A.cols;
+            const double* data = A.a.data();
+
+            // Alternem columna i fila fins que l'element és màxim a totes dues (acaba en poques voltes).
+            std::size_t r = k + ArgMaxAbs(data + k * ld + k, n - k, ld);
+            std::size_t c = k;
+            double best = std::abs(data[r * ld + c]);
+            std::size_t scanned = n - k;
+            for (;;) {
+                const std::size_t c2 = k + ArgMaxAbs(data + r * ld + k, ld - k);
+                scanned += ld - k;
+                if (std::abs(data[r * ld + c2]) <= best) break;
+                c = c2;
+                best = std::abs(data[r * ld + c]);
+
+                const std::size_t r2 = k + ArgMaxAbs(data + k * ld + c, n - k, ld);
+                scanned += n - k;
+                if (std::abs(data[r2 * ld + c]) <= best) break;
+                r = r2;
+                best = std::abs(data[r * ld + c]);
+            }
+            if (op) op->IncCmp(scanned - 1);
+            return PivotChoice{ r, c, best };
+        }
+    }
+
+    const char* PivotStrategyName(PivotStrategy s)
+    {
+        switch (s) {
+        case PivotStrategy::None: return "none";
+        case PivotStrategy::Partial: return "partial";
+        case PivotStrategy::ScaledPartial: return "scaled";
+        case PivotStrategy::Rook: return "rook";
+        case PivotStrategy::Complete: return "complete";
+        }
+        return "?";
+    }
+
+    bool ParsePivotStrategy(const std::string& name, PivotStrategy& out)
+    {
+        for (PivotStrategy s : { PivotStrategy::None, PivotStrategy::Partial, PivotStrategy::ScaledPartial,
+                                 PivotStrategy::Rook, PivotStrategy::Complete }) {
+            if (name == PivotStrategyName(s)) { out = s; return true; }
+        }
+        return false;
+    }
+
+    std::size_t ArgMaxAbs(const double* x, std::size_t n, std::size_t stride)
+    {
+        if (n <= 1) return 0;
+
+        // 1) Màxim amb quatre acumuladors: sense dependència entre iteracions el compilador
+        //    ho converteix en maxpd sobre registres vectorials quan stride == 1.
+        double m0 = 0.0, m1 = 0.0, m2 = 0.0, m3 = 0.0;
+        std::size_t i = 0;
+        if (stride == 1) {
+            for (; i + 4 <= n; i += 4) {
+                m0 = std::max(m0, std::abs(x[i]));
+                m1 = std::max(m1, std::abs(x[i + 1]));
+                m2 = std::max(m2, std::abs(x[i + 2]));
+                m3 = std::max(m3, std::abs(x[i + 3]));
+            }
+        }
+        for (; i < n; ++i) m0 = std::max(m0, std::abs(x[i * stride]));
+        const double m = std::max(std::max(m0, m1), std::max(m2, m3));
+
+        // 2) Primer índex que l'assoleix: la comparació és exacta (el màxim és un dels valors).
+        for (i = 0; i < n; ++i) {
+            if (std::abs(x[i * stride]) == m) return i;
+        }
+        return 0;
+    }
+
+    namespace
+    {
+        // Comptador d'una cerca de pivot per columna (Partial / ScaledPartial), tant si la fa
+        // SelectPivot com si ve fusionada amb l'actualització del pas anterior.
+        void CountColumnSearch(PivotStrategy s, std::size_t n, std::size_t k, OpsCounter* op)
+        {
+            if (!op) return;
+            if (s == PivotStrategy::ScaledPartial) op->IncDiv(n - k);
+            op->IncCmp(n - k - 1);
+        }
+
+        PivotChoice SelectPivotWith(PivotStrategy s, const Matrix& A, std::size_t k, const Vec* scale, std::size_t threads,
+            WorkerPool* pool, OpsCounter* op)
+        {
+            const std::size_t n = A.rows, ld = A.cols;
+            const double* data = A.a.data();
+
+            switch (s) {
+            case PivotStrategy::None:
+                return PivotChoice{ k, k, std::abs(data[k * ld + k]) };
+
+            case PivotStrategy::Partial: {
+                const std::size_t r = k + ArgMaxAbs(data + k * ld + k, n - k, ld);
+                CountColumnSearch(s, n, k, op);
+                return PivotChoice{ r, k, std::abs(data[r * ld + k]) };
+            }
+
+            case PivotStrategy::ScaledPartial: {
+                // Comparem |a_ik| / s_i; una fila amb s_i = 0 és nul·la i no pot donar pivot.
+                std::size_t r = k;
+                double best = -1.0;
+                for (std::size_t i = k; i < n; ++i) {
+                    const double si = scale ? (*scale)[i] : 1.0;
+                    const double v = si > 0.0 ? std::abs(data[i * ld + k]) / si : 0.0;
+                    if (v > best) { best = v; r = i; }
+                }
+                CountColumnSearch(s, n, k, op);
+                return PivotChoice{ r, k, std::abs(data[r * ld + k]) };
+            }
+
+            case PivotStrategy::Rook:
+                return SearchRook(A, k, op);
+
+            case PivotStrategy::Complete: {
+                PivotChoice p = SearchComplete(A, k, threads, pool);
+                if (op) op->IncCmp((n - k) * (ld - k) - 1);
+                return p;
+            }
+            }
+            return PivotChoice{ k, k, std::abs(data[k * ld + k]) };
+        }
+    }
+
+    PivotChoice SelectPivot(PivotStrategy s, const Matrix& A, std::size_t k, const Vec* scale, std::size_t threads, OpsCounter* op)
+    {
+        return SelectPivotWith(s, A, k, scale, threads, nullptr, op);
+    }
+
+    bool EliminatePivoted(Matrix& A, Vec* b, PivotStrategy s, double tol, PivotHistory& hist,
+        OpsCounter* op, PhaseTimes* phases, ProgressToken* progress, std::size_t threads)
+    {
+        const std::size_t n = A.rows;
+        hist.row_piv.assign(n, 0);
+        hist.col_piv.assign(n, 0);
+        hist.row_swaps = hist.col_swaps = 0;
+        if (A.cols != n || (b && b->size() != n)) {
+            return false;
+        }
+        if (n == 0) {
+            return true;
+        }
+
+        double* data = A.a.data();
+        const std::size_t ld = A.cols;
+
+        // Escalat per files de la matriu original; viatja amb les files quan s'intercanvien.
+        Vec scale;
+        if (s == PivotStrategy::ScaledPartial) {
+            scale.resize(n);
+            for (std::size_t i = 0; i < n; ++i) scale[i] = std::abs(data[i * ld + ArgMaxAbs(data + i * ld, ld)]);
+        }
+
+        // Els mateixos fils serveixen tots els passos: crear-ne de nous a cada k costaria tant
+        // com l'actualització d'un pas mitjà.
+        std::optional<WorkerPool> pool;
+        if (threads != 1 && n * n >= kParallelUpdate) pool.emplace(threads);
+        WorkerPool* pp = pool ? &*pool : nullptr;
+
+        // Amb Partial / ScaledPartial, l'actualització paral·lela del pas k ja recorre les files
+        // de la columna k+1 i en treu el pivot del pas següent (cerca fusionada per blocs, que es
+        // combinen en ordre de files: mateix desempat que la cerca sèrie).
+        const bool fuse = pp && (s == PivotStrategy::Partial || s == PivotStrategy::ScaledPartial);
+        struct Lane { double key; PivotChoice p; };
+        std::vector<Lane> lanes(pp ? pp->Size() : 0);
+        bool have_next = false;
+        PivotChoice next{};
+
+        // Cronometratge per pas només si ens demanen el desglossament (t: instant de l'últim tall).
+        double t = phases ? TraceNowUs() : 0.0;
+        auto lap = [&](double& acc_ms) {
+            double now = TraceNowUs();
+            acc_ms += (now - t) * 1e-3;
+            t = now;
+        };
+
+        for (std::size_t k = 0; k < n; ++k) {
+            if (progress) {
+                if (progress->Cancelled()) return false;
+                progress->Set(double(k) / double(n));
+            }
+
+            // 1) Selecció del pivot segons l'estratègia.
+            PivotChoice p;
+            if (have_next) {
+                p = next;
+                CountColumnSearch(s, n, k, op);
+            }
+            else {
+                p = SelectPivotWith(s, A, k, scale.empty() ? nullptr : &scale, threads, pp, op);
+            }
+            have_next = false;
+            hist.row_piv[k] = p.row;
+            hist.col_piv[k] = p.col;
+            if (phases) lap(phases->pivot_ms);
+
+            // 2) Intercanvis: la fila arrossega b i l'escalat; la columna, totes les files (també
+            //    la part U ja calculada, perquè els factors corresponguin a A Q).
+            if (p.row != k) {
+                A.SwapRows(k, p.row);
+                if (b) std::swap((*b)[k], (*b)[p.row]);
+                if (!scale.empty()) std::swap(scale[k], scale[p.row]);
+                ++hist.row_swaps;
+                if (op) op->IncSwp(b ? 2 : 1);
+            }
+            if (p.col != k) {
+                for (std::size_t i = 0; i < n; ++i) std::swap(data[i * ld + k], data[i * ld + p.col]);
+                ++hist.col_swaps;
+                if (op) op->IncSwp();
+            }
+            if (phases) lap(phases->swap_ms);
+
+            const double* row_k = data + k * ld;
+            const double pivot = row_k[k];
+            if (op) op->IncCmp();
+            if (std::abs(pivot) <= tol) {
+                return false;  // Pivot massa petit: la matriu es considera singular.
+            }
+
+            if (k == n - 1) {
+                continue;
+            }
+
+            // 3) Eliminació: cada fila i > k és independent, així que es pot repartir entre fils
+            //    sense canviar cap resultat. Guardem el multiplicador just a sota de la diagonal.
+            const std::size_t rows = n - k - 1, cols = ld - k - 1;
+            auto eliminate_row = [&](std::size_t r) {
+                const std::size_t i = k + 1 + r;
+                double* row_i = data + i * ld;
+                const double m_ik = row_i[k] / pivot;
+                row_i[k] = m_ik;
+                for (std::size_t j = k + 1; j < ld; ++j) {
+                    row_i[j] -= m_ik * row_k[j];
+                }
+                if (b) (*b)[i] -= m_ik * (*b)[k];
+            };
+            if (pp && rows * cols >= kParallelUpdate) {
+                pp->Run(rows, [&](std::size_t w, std::size_t r0, std::size_t r1) {
+                    Lane best{ -1.0, PivotChoice{ k + 1 + r0, k + 1, 0.0 } };
+                    for (std::size_t r = r0; r < r1; ++r) {
+                        eliminate_row(r);
+                        if (!fuse) continue;
+                        const std::size_t i = k + 1 + r;
+                        const double a = std::abs(data[i * ld + k + 1]);
+                        const double key = s == PivotStrategy::ScaledPartial ? (scale[i] > 0.0 ? a / scale[i] : 0.0) : a;
+                        if (key > best.key) best = Lane{ key, PivotChoice{ i, k + 1, a } };
+                    }
+                    lanes[w] = best;
+                });
+                if (fuse) {
+                    const std::size_t parts = std::min(rows, pp->Size());
+                    Lane best = lanes[0];
+                    for (std::size_t w = 1; w < parts; ++w) {
+                        if (lanes[w].key > best.key) best = lanes[w];
+                    }
+                    next = best.p;
+                    have_next = true;
+                }
+            }
+            else {
+                for (std::size_t r = 0; r < rows; ++r) eliminate_row(r);
+            }
+
+            if (op) {
+                op->IncDiv(rows);
+                op->IncMul(rows * cols + (b ? rows : 0));
+                op->IncSub(rows * cols + (b ? rows : 0));
+            }
+            if (phases) lap(phases->update_ms);
+        }
+
+        return true;
+    }
+
+    void ApplyColumnPivots(const PivotHistory& hist, Vec& x)
+    {
+        // Q = Q_0 Q_1 ... Q_{n-1}: l'última transposició s'aplica primer.
+        for (std::size_t k = hist.col_piv.size(); k-- > 0;) {
+            if (hist.col_piv[k] != k) std::swap(x[k], x[hist.col_piv[k]]);
+        }
+    }
+}
@@ -0,0 +1,396 @@
+#include "QR.hpp"
+#include "LinAlg.hpp"
+#include "Parallel.hpp"
+#include "Solve.hpp"
+#include "Timer.hpp"
+#include "Trace.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <stdexcept>
+
+namespace LinAlg
+{
+
+    namespace
+    {
+        // Element (i, p) de la V del panell que comença a la columna j0: 1 a la diagonal, 0 a sobre.
+        inline double VAt(const double* a, std::size_t ld, std::size_t j0, std::size_t i, std::size_t p)
+        {
+            const std::size_t j = j0 + p;
+            return i < j ? 0.0 : (i == j ? 1.0 : a[i * ld + j]);
+        }
+
+        // QR sense blocs de les columnes [j0, j1): per a cada columna genera el reflector (com xLARFG:
+        // beta = -sign(alpha) ||x||, v = x / (alpha - beta), v[0] = 1) i l'aplica a la resta del panell.
+        void PanelQR(Matrix& A, std::size_t j0, std::size_t j1, Vec& tau, OpsCounter* op)
+        {
+            const std::size_t m = A.rows, ld = A.cols;
+            double* a = A.a.data();
+            Vec w(j1 - j0);
+
+            for (std::size_t j = j0; j < j1; ++j) {
+                const double alpha = a[j * ld + j];
+                double sigma = 0.0;
+                for (std::size_t i = j + 1; i < m; ++i) sigma += a[i * ld + j] * a[i * ld + j];
+                if (op) {
+                    op->IncMul(m - j - 1);
+                    op->IncAdd(m - j - 1);
+                }
+                if (sigma == 0.0) {
+                    tau[j] = 0.0;      // la columna ja és triangular: H_j = I
+                    continue;
+                }
+
+                const double norm = std::sqrt(alpha * alpha + sigma);
+                const double beta = alpha >= 0.0 ? -norm : norm;
+                tau[j] = (beta - alpha) / beta;
+                const double scale = 1.0 / (alpha - beta);
+                for (std::size_t i = j + 1; i < m; ++i) a[i * ld + j] *= scale;
+                a[j * ld + j] = beta;
+
+                // H_j a les columnes j+1..j1-1: w = v^T C, C -= tau v w^T (per files, accés contigu).
+                const std::size_t c0 = j + 1, nc = j1 - c0;
+                if (nc == 0) continue;
+                for (std::size_t c = 0; c < nc; ++c) w[c] = a[j * ld + c0 + c];
+                for (std::size_t i = j + 1; i < m; ++i) {
+                    const double vi = a[i * ld + j];
+                    const double* ci = a + i * ld + c0;
+                    for (std::size_t c = 0; c < nc; ++c) w[c] += vi * ci[c];
+                }
+                for (std::size_t c = 0; c < nc; ++c) {
+                    w[c] *= tau[j];
+                    a[j * ld + c0 + c] -= w[c];
+                }
+                for (std::size_t i = j + 1; i < m; ++i) {
+                    const double vi = a[i * ld + j];
+                    double* ci = a + i * ld + c0;
+                    for (std::size_t c = 0; c < nc; ++c) ci[c] -= vi * w[c];
+                }
+                if (op) {
+                    op->IncMul(m - j + 2 * (m - j) * nc);
+                    op->IncAdd(2 * (m - j) * nc);
+                }
+            }
+        }
+
+        // T triangular superior amb H_j0 ... H_j1-1 = I - V T V^T (xLARFT endavant per columnes):
+        // T[i][i] = tau_i i T[0:i, i] = -tau_i T[0:i, 0:i] (V^T v_i).
+        Matrix FormT(const Matrix& A, std::size_t j0, std::size_t j1, const Vec& tau, OpsCounter* op)
+        {
+            const std::size_t m = A.rows, ld = A.cols, nb = j1 - j0;
+            const double* a = A.a.data();
+
+            Matrix G(nb, nb);      // G = V^T V (només la part superior)
+            for (std::size_t i = j0; i < m; ++i) {
+                for (std::size_t p = 0; p < nb; ++p) {
+                    const double vp = VAt(a, ld, j0, i, p);
+                    if (vp == 0.0) continue;
+                    for (std::size_t q = p; q < nb; ++q) G.a[p * nb + q] += vp * VAt(a, ld, j0, i, q);
+                }
+            }
+
+            Matrix T(nb, nb);
+            for (std::size_t i = 0; i < nb; ++i) {
+                const double ti = tau[j0 + i];
+                for (std::size_t r = 0; r < i; ++r) {
+                    double acc = 0.0;
+                    for (std::size_t s = r; s < i; ++s) acc += T.a[r * nb + s] * G.a[s * nb + i];
+                    T.a[r * nb + i] = -ti * acc;
+                }
+                T.a[i * nb + i] = ti;
+            }
+            if (op) {
+                op->IncMul((m - j0) * nb * (nb + 1) / 2 + nb * nb * nb / 6);
+                op->IncAdd((m - j0) * nb * (nb + 1) / 2 + nb * nb * nb / 6);
+            }
+            return T;
+        }
+
+        // Q_panell^T aplicat a les columnes [j1, ld): C -= V (T^T (V^T C)). Tres passades per files
+        // que són productes de matrius (BLAS-3) en lloc de nb actualitzacions de rang 1.
+        void ApplyBlockQt(Matrix& A, std::size_t j0, std::size_t j1, const Matrix& T, OpsCounter* op)
+        {
+            const std::size_t m = A.rows, ld = A.cols, nb = j1 - j0, nc = ld - j1;
+            if (nc == 0) return;
+            double* a = A.a.data();
+
+            Matrix W(nb, nc);      // W = V^T C
+            for (std::size_t i = j0; i < m; ++i) {
+                const double* ci = a + i * ld + j1;
+                for (std::size_t p = 0; p < nb; ++p) {
+                    const double v = VAt(a, ld, j0, i, p);
+                    if (v == 0.0) continue;
+                    double* wp = W.a.data() + p * nc;
+                    for (std::size_t c = 0; c < nc; ++c) wp[c] += v * ci[c];
+                }
+            }
+            // W = T^T W en el mateix lloc: la fila p només depèn de les q <= p, així que anem de baix a dalt.
+            for (std::size_t p = nb; p-- > 0;) {
+                double* wp = W.a.data() + p * nc;
+                const double tpp = T.a[p * nb + p];
+                for (std::size_t c = 0; c < nc; ++c) wp[c] *= tpp;
+                for (std::size_t q = 0; q < p; ++q) {
+                    const double tqp = T.a[q * nb + p];
+                    if (tqp == 0.0) continue;
+                    const double* wq = W.a.data() + q * nc;
+                    for (std::size_t c = 0; c < nc; ++c) wp[c] += tqp * wq[c];
+                }
+            }
+            for (std::size_t i = j0; i < m; ++i) {
+                double* ci = a + i * ld + j1;
+                for (std::size_t p = 0; p < nb; ++p) {
+                    const double v = VAt(a, ld, j0, i, p);
+                    if (v == 0.0) continue;
+                    const double* wp = W.a.data() + p * nc;
+                    for (std::size_t c = 0; c < nc; ++c) ci[c] -= v * wp[c];
+                }
+            }
+            if (op) {
+                op->IncMul(2 * (m - j0) * nb * nc + nb * nb * nc / 2);
+                op->IncAdd(2 * (m - j0) * nb * nc + nb * nb * nc / 2);
+            }
+        }
+
+        // R n x n (part superior de les primeres n files de QR).
+        Matrix UpperR(const Matrix& QR)
+        {
+            const std::size_t n = QR.cols;
+            Matrix R(n, n);
+            for (std::size_t i = 0; i < n; ++i)
+                for (std::size_t j = i; j < n; ++j) R.a[i * n + j] = QR.a[i * n + j];
+            return R;
+        }
+
+        // Aplica Q^T a c (m entrades) i en retorna les n primeres; la resta suma al quadrat del residu.
+        Vec ReduceRhs(const QRFactors& F, Vec c, double& tail2, OpsCounter* op)
+        {
+            ApplyQt(F, c, op);
+            const std::size_t n = F.QR.cols;
+            for (std::size_t i = n; i < c.size(); ++i) tail2 += c[i] * c[i];
+            c.resize(n);
+            return c;
+        }
+    }
+
+    namespace
+    {
+        // Nucli de FactorizeQR amb un punt de control per panell. 'done' acumula files x columnes
+        // factoritzades (compartit entre les fulles de TSQR) i el progrés és done / total.
+        // Retorna false si s'ha cancel·lat; F queda a mig fer.
+        bool FactorizeQRPanels(Matrix A, std::size_t block, QRFactors& F, OpsCounter* op,
+            ProgressToken* progress, std::atomic<std::size_t>& done, std::size_t total)
+        {
+            const std::size_t m = A.rows, n = A.cols;
+            F.tau.assign(n, 0.0);
+            const std::size_t nb = std::max<std::size_t>(1, block);
+            for (std::size_t j0 = 0; j0 < n; j0 += nb) {
+                if (progress && progress->Cancelled()) return false;
+                const std::size_t j1 = std::min(n, j0 + nb);
+                PanelQR(A, j0, j1, F.tau, op);
+                if (j1 < n) {
+                    Matrix T = FormT(A, j0, j1, F.tau, op);
+                    ApplyBlockQt(A, j0, j1, T, op);
+                }
+                const std::size_t d = done.fetch_add(m * (j1 - j0)) + m * (j1 - j0);
+                if (progress && total) progress->Set(double(d) / double(total));
+            }
+            F.QR = std::move(A);
+            return true;
+        }
+    }
+
+    QRFactors FactorizeQR(Matrix A, std::size_t block, OpsCounter* op)
+    {
+        if (A.rows < A.cols) {
+            throw std::invalid_argument("FactorizeQR: cal m >= n");
+        }
+        QRFactors F;
+        std::atomic<std::size_t> done{ 0 };
+        FactorizeQRPanels(std::move(A), block, F, op, nullptr, done, 0);
+        return F;
+    }
+
+    void ApplyQt(const QRFactors& F, Vec& b, OpsCounter* op)
+    {
+        const std::size_t m = F.QR.rows, n = F.QR.cols;
+        if (b.size() != m) {
+            throw std::invalid_argument("ApplyQt: dimensions incompatibles");
+        }
+        const double* a = F.QR.a.data();
+
+        // Q^T = H_{n-1} ... H_0: apliquem els reflectors en ordre creixent.
+        for (std::size_t j = 0; j < n; ++j) {
+            const double tau = F.tau[j];
+            if (tau == 0.0) continue;
+            double s = b[j];
+            for (std::size_t i = j + 1; i < m; ++i) s += a[i * n + j] * b[i];
+            s *= tau;
+            b[j] -= s;
+            for (std::size_t i = j + 1; i < m; ++i) b[i] -= s * a[i * n + j];
+            if (op) {
+                op->IncMul(2 * (m - j) - 1);
+                op->IncAdd(2 * (m - j) - 1);
+            }
+        }
+    }
+
+    TSQRFactors FactorizeTSQR(const Matrix& A, std::size_t blocks, std::size_t threads, OpsCounter* op, ProgressToken* progress)
+    {
+        const std::size_t m = A.rows, n = A.cols;
+        if (m < n) {
+            throw std::invalid_argument("FactorizeTSQR: cal m >= n");
+        }
+
+        TSQRFactors F;
+        F.m = m;
+        F.n = n;
+        std::size_t p = blocks ? blocks : (threads ? threads : HardwareThreads());
+        p = std::max<std::size_t>(1, std::min(p, n ? m / n : m));
+        F.row_begin.resize(p + 1);
+        for (std::size_t w = 0; w <= p; ++w) F.row_begin[w] = m * w / p;
+
+        // Fulles: QR independent de cada bloc de files. Cada fil compta en el seu OpsCounter.
+        // El progrés es mesura en files x columnes de les fulles, que són gairebé tota la feina si m >> n.
+        std::vector<OpsCounter> ops(p);
+        F.leaves.resize(p);
+        std::atomic<std::size_t> done{ 0 };
+        ParallelFor(p, [&](std::size_t w) {
+            TraceSpan s("tsqr fulla");
+            const std::size_t r0 = F.row_begin[w], r1 = F.row_begin[w + 1];
+            Matrix blk(r1 - r0, n);
+            std::copy(A.a.begin() + std::ptrdiff_t(r0 * n), A.a.begin() + std::ptrdiff_t(r1 * n), blk.a.begin());
+            FactorizeQRPanels(std::move(blk), 32, F.leaves[w], op ? &ops[w] : nullptr, progress, done, m * n);
+        }, threads);
+        if (progress && progress->Cancelled()) {
+            F.cancelled = true;
+            return F;
+        }
+
+        std::vector<Matrix> Rs(p);
+        for (std::size_t w = 0; w < p; ++w) Rs[w] = UpperR(F.leaves[w].QR);
+
+        // Arbre: cada node factoritza [R_esquerra; R_dreta] (2n x n) i passa el seu R al nivell següent.
+        while (Rs.size() > 1) {
+            if (progress && progress->Cancelled()) {
+                F.cancelled = true;
+                return F;
+            }
+            const std::size_t np = (Rs.size() + 1) / 2;
+            std::vector<QRFactors> level(np);
+            std::vector<Matrix> next(np);
+            ParallelFor(np, [&](std::size_t q) {
+                if (2 * q + 1 >= Rs.size()) {
+                    next[q] = std::move(Rs[2 * q]);
+                    return;
+                }
+                TraceSpan s("tsqr node");
+                Matrix S(2 * n, n);
+                std::copy(Rs[2 * q].a.begin(), Rs[2 * q].a.end(), S.a.begin());
+                std::copy(Rs[2 * q + 1].a.begin(), Rs[2 * q + 1].a.end(), S.a.begin() + std::ptrdiff_t(n * n));
+                level[q] = FactorizeQR(std::move(S), 32, op ? &ops[q] : nullptr);
+                next[q] = UpperR(level[q].QR);
+            }, threads);
+            F.levels.push_back(std::move(level));
+            Rs = std::move(next);
+        }
+        F.R = std::move(Rs[0]);
+
+        if (op) for (const OpsCounter& o : ops) op->Merge(o);
+        return F;
+    }
+
+    LeastSquaresReport SolveLeastSquares(const Matrix& A, const Vec& b, QRMethod method, std::size_t threads, double tol,
+        ProgressToken* progress)
+    {
+        TraceSpan span(method == QRMethod::TSQR ? "SolveLeastSquares(TSQR)" : "SolveLeastSquares");
+        LeastSquaresReport report;
+        report.m = A.rows;
+        report.n = A.cols;
+        if (A.rows < A.cols || b.size() != A.rows || A.cols == 0) {
+            return report;
+        }
+        const std::size_t n = A.cols;
+
+        Timer timer;
+        timer.Tic();
+
+        // c = (Q^T b)[0:n]; la resta de Q^T b és ortogonal a la imatge d'A i dona ||r||.
+        Matrix R;
+        Vec c;
+        double tail2 = 0.0;
+        if (method == QRMethod::TSQR) {
+            TSQRFactors F = FactorizeTSQR(A, 0, threads, &report.ops, progress);
+            if (F.cancelled) {
+                report.cancelled = true;
+                report.ms = timer.TocMs();
+                return report;
+            }
+            const std::size_t p = F.leaves.size();
+            std::vector<Vec> cs(p);
+            std::vector<double> tails(p, 0.0);
+            std::vector<OpsCounter> ops(p);
+            ParallelFor(p, [&](std::size_t w) {
+                Vec slice(b.begin() + std::ptrdiff_t(F.row_begin[w]), b.begin() + std::ptrdiff_t(F.row_begin[w + 1]));
+                cs[w] = ReduceRhs(F.leaves[w], std::move(slice), tails[w], &ops[w]);
+            }, threads);
+            for (std::size_t w = 0; w < p; ++w) { tail2 += tails[w]; report.ops.Merge(ops[w]); }
+
+            for (const auto& level : F.levels) {
+                std::vector<Vec> next(level.size());
+                for (std::size_t q = 0; q < level.size(); ++q) {
+                    if (2 * q + 1 >= cs.size()) { next[q] = std::move(cs[2 * q]); continue; }
+                    Vec s = std::move(cs[2 * q]);
+                    s.insert(s.end(), cs[2 * q + 1].begin(), cs[2 * q + 1].end());
+                    next[q] = ReduceRhs(level[q], std::move(s), tail2, &report.ops);
+                }
+                cs = std::move(next);
+            }
+            c = std::move(cs[0]);
+            R = std::move(F.R);
+        }
+        else {
+            QRFactors F;
+            std::atomic<std::size_t> done{ 0 };
+            if (!FactorizeQRPanels(A, 32, F, &report.ops, progress, done, A.rows * n)) {
+                report.cancelled = true;
+                report.ms = timer.TocMs();
+                return report;
+            }
+            c = ReduceRhs(F, b, tail2, &report.ops);
+            R = UpperR(F.QR);
+        }
+
+        // Rang numèric: un r_jj petit respecte del més gran deixa x indeterminada.
+        double rmax = 0.0;
+        for (std::size_t i = 0; i < n; ++i) rmax = std::max(rmax, std::abs(R.a[i * n + i]));
+        for (std::size_t i = 0; i < n; ++i) {
+            if (std::abs(R.a[i * n + i]) <= tol * rmax || rmax == 0.0) {
+                report.rank_deficient = true;
+                report.ms = timer.TocMs();
+                return report;
+            }
+        }
+
+        BackSubstitution(R, c, &report.ops);
+        report.x = std::move(c);
+        report.ms = timer.TocMs();
+
+        report.resid_norm = std::sqrt(tail2);
+        const double nb = L2Norm(b);
+        report.rel_resid = nb > 0.0 ? report.resid_norm / nb : report.resid_norm;
+
+        // Condició d'optimalitat A^T r = 0, mesurada a part (fora de report.ms).
+        Vec r = A.Multiply(report.x, nullptr);
+        for (std::size_t i = 0; i < r.size(); ++i) r[i] = b[i] - r[i];
+        Vec atr(n, 0.0);
+        double fro2 = 0.0;
+        for (std::size_t i = 0; i < A.rows; ++i) {
+            const double* row = A.a.data() + i * n;
+            for (std::size_t j = 0; j < n; ++j) { atr[j] += row[j] * r[i]; fro2 += row[j] * row[j]; }
+        }
+        const double denom = std::sqrt(fro2) * L2Norm(r);
+        report.optimality = denom > 0.0 ? L2Norm(atr) / denom : 0.0;
+        return report;
+    }
+}
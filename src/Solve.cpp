@@ -1,65 +1,20 @@
 #include "Solve.hpp"
+#include "Condition.hpp"
+#include "Determinant.hpp"
 #include "LinAlg.hpp"
+#include "Pivoting.hpp"
+#include "Trace.hpp"
 #include <stdexcept>
 #include <cmath>
 
 namespace LinAlg 
 {
 
-    bool GaussianElimination(Matrix& A, Vec& b, double tol, OpsCounter* op) 
+    bool GaussianElimination(Matrix& A, Vec& b, double tol, OpsCounter* op, ProgressToken* progress) 
     {
-        std::size_t n = A.rows;
-
-        // Només té sentit per matrius quadrades amb el mateix nombre de components a b.
-        if (A.cols != n || b.size() != n) {
-            return false;
-        }
-        if (n == 0) {
-            return true;
-        }
-
-        // Recorrem cada columna pivot k i anul·lem els elements per sota.
-        for (std::size_t k = 0; k < n; ++k) {
-            double pivot = A.At(k, k);
-
-            // Comprovem la magnitud del pivot respecte la tolerància.
-            if (op) op->IncCmp();
-            if (std::abs(pivot) <= tol) {
-                return false;  // Pivot massa petit: el procés sense pivotatge falla.
-            }
-
-            // Quan som a l'última fila no cal eliminar res per sota.
-            if (k == n - 1) {
-                continue;
-            }
-
-            // Eliminem les contribucions de la columna k a cada fila inferior i guardem el multiplicador.
-            for (std::size_t i = k + 1; i < n; ++i) {
-                double m_ik = A.At(i, k) / pivot;
-                if (op) op->IncDiv();
-
-                // Desem el factor d'eliminació a la part inferior de la matriu per reusar-lo a la substitució.
-                A.At(i, k) = m_ik;
-
-                // Actualitzem totes les entrades a la dreta del pivot a la fila i.
-                for (std::size_t j = k + 1; j < n; ++j) {
-                    A.At(i, j) -= m_ik * A.At(k, j);
-                    if (op) {
-                        op->IncMul();
-                        op->IncSub();
-                    }
-                }
-
-                // Actualitzem també el terme independent corresponent.
-                b[i] -= m_ik * b[k];
-                if (op) {
-                    op->IncMul();
-                    op->IncSub();
-                }
-            }
-        }
-
-        return true;
+        // Sense pivotatge: el pivot és sempre a la diagonal i un valor ~0 fa fallar el procés.
+        PivotHistory hist;
+        return EliminatePivoted(A, &b, PivotStrategy::None, tol, hist, op, nullptr, progress);
     }
 
     void BackSubstitution(const Matrix& U, Vec& c, OpsCounter* op) 
@@ -95,160 +50,245 @@ namespace LinAlg
         }
     }
 
-    SolveReport SolveNoPivot(Matrix A, Vec b, double tol) 
+    SolveReport SolveNoPivot(Matrix A, Vec b, double tol, ProgressToken* progress) 
+    {
+        return SolvePivoted(std::move(A), std::move(b), tol, PivotStrategy::None, 1, progress);
+    }
+
+    bool GaussianEliminationPivot(Matrix& A, Vec& b, double tol, OpsCounter* op, PhaseTimes* phases, ProgressToken* progress) 
+    {
+        // Pivotatge parcial: a cada pas pugem la fila amb |a[p, k]| més gran.
+        PivotHistory hist;
+        return EliminatePivoted(A, &b, PivotStrategy::Partial, tol, hist, op, phases, progress);
+    }
+
+    SolveReport SolvePartialPivot(Matrix A, Vec b, double tol, ProgressToken* progress) 
     {
+        return SolvePivoted(std::move(A), std::move(b), tol, PivotStrategy::Partial, 1, progress);
+    }
+
+    SolveReport SolvePivoted(Matrix A, Vec b, double tol, PivotStrategy strategy, std::size_t threads, ProgressToken* progress)
+    {
+        // Un nom de tram per estratègia (els noms han de ser literals: el traçat guarda el punter).
+        static const char* const kSpanNames[] = { "SolveNoPivot", "SolvePartialPivot", "SolveScaledPivot", "SolveRookPivot", "SolveCompletePivot" };
+        TraceSpan span(kSpanNames[int(strategy)]);
         SolveReport report;
         report.n = A.rows;
 
-        // Validem dimensions: necessitem una matriu quadrada i un vector b compatible.
+        // Validem que tinguem una matriu quadrada i un vector de la mateixa llargada.
         if (!A.IsSquare() || b.size() != A.rows) {
             return report;
         }
 
-        // Conservem còpies per poder calcular el residu amb les dades originals.
-        Matrix A_orig = A;
-        Vec b_orig = b;
+        // Desarem còpies independents per poder calcular el residu relatiu.
+        Timer phase;
+        phase.Tic();
+        Matrix A_orig;
+        Vec b_orig;
+        {
+            TraceSpan s("copia");
+            A_orig = A;
+            b_orig = b;
+        }
+        report.phases.copy_ms = phase.TocMs();
 
         Timer timer;
         timer.Tic();
 
-        // Fase 1: eliminació gaussiana sense pivotatge.
-        bool ge_success = GaussianElimination(A, b, tol, &report.ops);
+        // Fase 1: eliminació gaussiana amb l'estratègia de pivotatge triada.
+        PivotHistory hist;
+        bool ge_success;
+        {
+            TraceSpan s("eliminacio");
+            HwScope hw(&report.hw.elimination);
+            ge_success = EliminatePivoted(A, &b, strategy, tol, hist, &report.ops,
+                TracingEnabled() ? &report.phases : nullptr, progress, threads);
+        }
+        report.phases.elimination_ms = timer.TocMs();
         if (!ge_success) {
-            // Sense pivotatge el cas fallit indica un pivot massa petit.
-            report.pivot_zero = true;
+            if (progress && progress->Cancelled()) {
+                report.cancelled = true;
+            }
+            else if (strategy == PivotStrategy::None) {
+                // Sense pivotatge el cas fallit indica un pivot massa petit.
+                report.pivot_zero = true;
+            }
+            else {
+                // Pivot massa petit tot i pivotar: declarem que la matriu és singular.
+                report.singular = true;
+            }
             report.ms = timer.TocMs();
             return report;
         }
 
-        // Fase 2: substitució enrere utilitzant la part superior triangular d'A.
-        BackSubstitution(A, b, &report.ops);
+        // Fase 2: un cop tenim U triangular superior, fem substitució enrere i desfem
+        // les permutacions de columnes (només Rook i Complete en fan).
+        phase.Tic();
+        {
+            TraceSpan s("substitucio");
+            HwScope hw(&report.hw.back_substitution);
+            BackSubstitution(A, b, &report.ops);
+            ApplyColumnPivots(hist, b);
+        }
+        report.phases.back_ms = phase.TocMs();
 
         // El vector b modificat ja conté la solució final.
         report.x = b;
         report.ms = timer.TocMs();
 
-        // Mesurem el residu relatiu respecte les dades originals.
-        report.rel_resid = RelativeResidual(A_orig, report.x, b_orig, nullptr);
+        // Mesurem el residu relatiu respecte les dades originals (fora de report.ms).
+        phase.Tic();
+        {
+            TraceSpan s("residu");
+            HwScope hw(&report.hw.residual);
+            report.rel_resid = RelativeResidual(A_orig, report.x, b_orig, nullptr);
+        }
+        report.phases.residual_ms = phase.TocMs();
+
+        // Condicionament, creixement dels pivots i determinant reutilitzant els factors d'A (O(n^2)).
+        // Les permutacions de files i columnes no canvien la norma 1 de la inversa; al determinant
+        // només n'hi canvien el signe.
+        phase.Tic();
+        {
+            TraceSpan s("condicio");
+            report.cond1 = Norm1(A_orig) * EstimateInverseNorm1(A);
+            report.pivot_growth = PivotGrowth(A_orig, A);
+            const LogDet det = LogDeterminant(A, hist.row_swaps + hist.col_swaps);
+            report.log_abs_det = det.log_abs;
+            report.det_sign = det.sign;
+        }
+        report.phases.condition_ms = phase.TocMs();
+        if (progress) progress->Set(1.0);
         return report;
     }
 
-    bool GaussianEliminationPivot(Matrix& A, Vec& b, double tol, OpsCounter* op) 
+    bool FactorizePartialPivot(Matrix& A, std::vector<std::size_t>& piv, double tol, OpsCounter* op)
     {
-        std::size_t n = A.rows;
-        if (A.cols != n || b.size() != n) {
-            return false;
+        // Mateix nucli que GaussianEliminationPivot però sense cap terme independent:
+        // guardem l'historial d'intercanvis perquè la factorització es pugui reutilitzar.
+        PivotHistory hist;
+        bool ok = EliminatePivoted(A, nullptr, PivotStrategy::Partial, tol, hist, op);
+        piv = std::move(hist.row_piv);
+        return ok;
+    }
+
+    LUFactors FactorizeLU(Matrix A, double tol, OpsCounter* op)
+    {
+        if (!A.IsSquare()) {
+            throw std::invalid_argument("FactorizeLU: la matriu ha de ser quadrada");
         }
-        if (n == 0) {
-            return true;
+
+        LUFactors F;
+        F.tol = tol;
+        F.singular = !FactorizePartialPivot(A, F.piv, tol, op);
+        for (std::size_t k = 0; k < F.piv.size(); ++k) {
+            if (F.piv[k] != k) ++F.swaps;
         }
+        F.LU = std::move(A);
+        return F;
+    }
 
-        double* data = A.a.data();
-        std::size_t ld = A.cols;
+    void SolveFactorized(const LUFactors& F, Vec& b, OpsCounter* op)
+    {
+        const std::size_t n = F.LU.rows;
+        if (b.size() != n) {
+            throw std::invalid_argument("SolveFactorized: dimensions incompatibles");
+        }
+        if (F.singular) {
+            throw std::invalid_argument("SolveFactorized: factoritzacio singular");
+        }
+        if (n == 0) {
+            return;
+        }
 
-        // Eliminació gaussiana amb pivotatge parcial fila a fila.
+        // 1) Apliquem els intercanvis en el mateix ordre que la factorització (Pb).
         for (std::size_t k = 0; k < n; ++k) {
-            // 1) Selecció del pivot: busquem la fila amb |a[p, k]| més gran al submatriu restant.
-            std::size_t pivot_row = k;
-            double max_pivot = std::abs(data[k * ld + k]);
-
-            for (std::size_t p = k + 1; p < n; ++p) {
-                double current_pivot = std::abs(data[p * ld + k]);
-                if (op) op->IncCmp();
-
-                if (current_pivot > max_pivot) {
-                    max_pivot = current_pivot;
-                    pivot_row = p;
-                }
-            }
-
-            // 2) Si cal, intercanviem la fila actual amb la candidata òptima.
-            if (pivot_row != k) {
-                A.SwapRows(k, pivot_row);
-                std::swap(b[k], b[pivot_row]);
-                // Comptem 2 swaps: un per A, un per b
-                if (op) {
-                    op->IncSwp();
-                    op->IncSwp();
-                }
+            if (F.piv[k] != k) {
+                std::swap(b[k], b[F.piv[k]]);
+                if (op) op->IncSwp();
             }
+        }
 
-            double* row_k = data + k * ld;
-            double pivot = row_k[k];
-            if (op) op->IncCmp();
-            if (std::abs(pivot) <= tol) {
-                return false;  // Pivot massa petit: la matriu es considera singular.
+        // 2) Substitució endavant amb L unitària.
+        const double* lu = F.LU.a.data();
+        for (std::size_t i = 1; i < n; ++i) {
+            const double* row_i = lu + i * n;
+            double acc = b[i];
+            for (std::size_t k = 0; k < i; ++k) {
+                acc -= row_i[k] * b[k];
             }
-
-            if (k == n - 1) {
-                continue;
-            }
-
-            // 3) A partir d'aquí, eliminació gaussiana estàndard reutilitzant el pivot triat.
-            for (std::size_t i = k + 1; i < n; ++i) {
-                double* row_i = data + i * ld;
-                double m_ik = row_i[k] / pivot;
-                if (op) op->IncDiv();
-
-                // Guardem el multiplicador just a sota de la diagonal.
-                row_i[k] = m_ik;
-
-                // Actualitzem la resta d'elements a la fila i.
-                for (std::size_t j = k + 1; j < ld; ++j) {
-                    row_i[j] -= m_ik * row_k[j];
-                    if (op) {
-                        op->IncMul();
-                        op->IncSub();
-                    }
-                }
-
-                // També actualitzem el vector de termes independents.
-                b[i] -= m_ik * b[k];
-                if (op) {
-                    op->IncMul();
-                    op->IncSub();
-                }
+            b[i] = acc;
+            if (op) {
+                op->IncMul(i);
+                op->IncSub(i);
             }
         }
 
-        return true;
+        // 3) Substitució enrere amb U.
+        BackSubstitution(F.LU, b, op);
     }
 
-
-    SolveReport SolvePartialPivot(Matrix A, Vec b, double tol) 
+    void SolveFactorized(const LUFactors& F, Matrix& B, OpsCounter* op)
     {
-        SolveReport report;
-        report.n = A.rows;
-
-        // Validem que tinguem una matriu quadrada i un vector de la mateixa llargada.
-        if (!A.IsSquare() || b.size() != A.rows) {
-            return report;
+        const std::size_t n = F.LU.rows;
+        const std::size_t m = B.cols;
+        if (B.rows != n) {
+            throw std::invalid_argument("SolveFactorized: dimensions incompatibles");
         }
-
-        // Desarem còpies independents per poder calcular el residu relatiu.
-        Matrix A_orig = A;
-        Vec b_orig = b;
-
-        Timer timer;
-        timer.Tic();
-
-        // Fase 1: eliminació gaussiana amb pivotatge parcial fila a fila.
-        bool ge_success = GaussianEliminationPivot(A, b, tol, &report.ops);
-        if (!ge_success) {
-            // Pivot massa petit: declarem que la matriu és singular.
-            report.singular = true;
-            report.ms = timer.TocMs();
-            return report;
+        if (F.singular) {
+            throw std::invalid_argument("SolveFactorized: factoritzacio singular");
+        }
+        if (n == 0 || m == 0) {
+            return;
         }
 
-        // Fase 2: un cop tenim U triangular superior, fem substitució enrere.
-        BackSubstitution(A, b, &report.ops);
+        // Treballem fila a fila sobre B (row-major): cada actualització és un axpy contigu
+        // que avança tots els termes independents alhora.
+        for (std::size_t k = 0; k < n; ++k) {
+            if (F.piv[k] != k) {
+                B.SwapRows(k, F.piv[k]);
+                if (op) op->IncSwp();
+            }
+        }
 
-        // Guardem la solució, el temps i el residu relatiu.
-        report.x = b;
-        report.ms = timer.TocMs();
+        const double* lu = F.LU.a.data();
+        double* data = B.a.data();
+
+        // Substitució endavant: B[i,:] -= L[i,k] * B[k,:]
+        for (std::size_t i = 1; i < n; ++i) {
+            double* row_i = data + i * m;
+            for (std::size_t k = 0; k < i; ++k) {
+                const double l_ik = lu[i * n + k];
+                const double* row_k = data + k * m;
+                for (std::size_t j = 0; j < m; ++j) {
+                    row_i[j] -= l_ik * row_k[j];
+                }
+            }
+            if (op) {
+                op->IncMul(i * m);
+                op->IncSub(i * m);
+            }
+        }
 
-        report.rel_resid = RelativeResidual(A_orig, report.x, b_orig, nullptr);
-        return report;
+        // Substitució enrere: B[i,:] = (B[i,:] - sum U[i,k] * B[k,:]) / U[i,i]
+        for (std::size_t i = n; i-- > 0;) {
+            double* row_i = data + i * m;
+            for (std::size_t k = i + 1; k < n; ++k) {
+                const double u_ik = lu[i * n + k];
+                const double* row_k = data + k * m;
+                for (std::size_t j = 0; j < m; ++j) {
+                    row_i[j] -= u_ik * row_k[j];
+                }
+            }
+            const double u_ii = lu[i * n + i];
+            for (std::size_t j = 0; j < m; ++j) {
+                row_i[j] /= u_ii;
+            }
+            if (op) {
+                op->IncMul((n - i - 1) * m);
+                op->IncSub((n - i - 1) * m);
+                op->IncDiv(m);
+            }
+        }
     }
 }
@@ -0,0 +1,271 @@
+#include "SolveService.hpp"
+#include "Condition.hpp"
+#include "Determinant.hpp"
+#include "LinAlg.hpp"
+#include "Timer.hpp"
+#include "Trace.hpp"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace LinAlg
+{
+
+    struct SolveService::Job
+    {
+        Vec b;
+        std::promise<SolveReport> promise;
+        Timer queued;   // temps des de Submit fins que un worker agafa el lot
+    };
+
+    struct SolveService::Batch
+    {
+        std::shared_ptr<const Matrix> A;
+        std::vector<Job> jobs;
+        Timer oldest;   // arrencat amb la primera petició del lot
+    };
+
+    static bool SameMatrix(const Matrix& X, const Matrix& Y)
+    {
+        return X.rows == Y.rows && X.cols == Y.cols &&
+            std::memcmp(X.a.data(), Y.a.data(), X.a.size() * sizeof(double)) == 0;
+    }
+
+    SolveService::SolveService(const ServiceConfig& cfg) : cfg_(cfg)
+    {
+        std::size_t n = cfg_.workers ? cfg_.workers : std::max(1u, std::thread::hardware_concurrency());
+        workers_.reserve(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            workers_.emplace_back([this, i] {
+                SetTraceThreadName("SolveService worker " + std::to_string(i));
+                WorkerLoop();
+            });
+        }
+    }
+
+    SolveService::~SolveService()
+    {
+        Shutdown();
+    }
+
+    void SolveService::Shutdown()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        for (std::thread& t : workers_) {
+            if (t.joinable()) t.join();
+        }
+        workers_.clear();
+    }
+
+    std::future<SolveReport> SolveService::Submit(Matrix A, Vec b)
+    {
+        if (!A.IsSquare() || b.size() != A.rows) {
+            throw std::invalid_argument("SolveService::Submit: dimensions incompatibles");
+        }
+
+        Job job;
+        job.b = std::move(b);
+        job.queued.Tic();
+        std::future<SolveReport> fut = job.promise.get_future();
+
+        // Si ja hi ha un lot pendent amb la mateixa A, ens hi afegim (coalescència). La comparació
+        // és O(n^2) i es fa fora del mutex sobre una còpia dels punters; després només cal
+        // comprovar que el lot trobat encara és a la cua.
+        std::vector<std::shared_ptr<const Matrix>> candidates;
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            for (auto& p : pending_) {
+                if (p->A->rows == A.rows && p->A->cols == A.cols) candidates.push_back(p->A);
+            }
+        }
+        std::shared_ptr<const Matrix> same;
+        for (auto& c : candidates) {
+            if (SameMatrix(*c, A)) { same = c; break; }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            if (stop_) {
+                throw std::logic_error("SolveService::Submit: servei aturat");
+            }
+
+            Batch* target = nullptr;
+            if (same) {
+                for (auto& p : pending_) {
+                    if (p->A == same) { target = p.get(); break; }
+                }
+            }
+            if (target) {
+                ++metrics_.coalesced;
+            }
+            else {
+                // El lot ja s'ha començat a resoldre: en fem un de nou (amb la mateixa còpia de A si n'hi ha).
+                auto batch = std::make_unique<Batch>();
+                batch->A = same ? same : std::make_shared<const Matrix>(std::move(A));
+                batch->oldest.Tic();
+                target = batch.get();
+                pending_.push_back(std::move(batch));
+            }
+            target->jobs.push_back(std::move(job));
+
+            ++metrics_.submitted;
+            ++metrics_.queue_depth;
+            metrics_.max_queue_depth = std::max(metrics_.max_queue_depth, metrics_.queue_depth);
+        }
+        cv_.notify_one();
+        return fut;
+    }
+
+    ServiceMetrics SolveService::Metrics() const
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        return metrics_;
+    }
+
+    std::unique_ptr<SolveService::Batch> SolveService::PopBatch()
+    {
+        // Primer els lots que ja fa massa que esperen (el més antic), si no el de n més petita.
+        std::size_t best = 0;
+        double best_wait = -1.0;
+        for (std::size_t i = 0; i < pending_.size(); ++i) {
+            double w = pending_[i]->oldest.TocMs();
+            if (w >= cfg_.max_wait_ms && w > best_wait) {
+                best = i;
+                best_wait = w;
+            }
+        }
+        if (best_wait < 0.0) {
+            for (std::size_t i = 1; i < pending_.size(); ++i) {
+                if (pending_[i]->A->rows < pending_[best]->A->rows) best = i;
+            }
+        }
+
+        std::unique_ptr<Batch> batch = std::move(pending_[best]);
+        pending_.erase(pending_.begin() + std::ptrdiff_t(best));
+        return batch;
+    }
+
+    void SolveService::WorkerLoop()
+    {
+        for (;;) {
+            std::unique_ptr<Batch> batch;
+            {
+                std::unique_lock<std::mutex> lock(mtx_);
+                cv_.wait(lock, [this] { return stop_ || !pending_.empty(); });
+                if (pending_.empty()) {
+                    return;  // stop_ i cua buida
+                }
+                batch = PopBatch();
+
+                const std::size_t m = batch->jobs.size();
+                metrics_.queue_depth -= m;
+                for (const Job& j : batch->jobs) {
+                    double w = j.queued.TocMs();
+                    metrics_.total_wait_ms += w;
+                    metrics_.max_wait_ms = std::max(metrics_.max_wait_ms, w);
+                }
+            }
+
+            // Una excepció (p.ex. bad_alloc) no pot deixar cap future sense resposta.
+            try {
+                RunBatch(*batch);
+            }
+            catch (...) {
+                // Les peticions ja no són a la cua: les comptem com a fallades perquè
+                // submitted = completed + failed + pendents continuï quadrant.
+                {
+                    std::lock_guard<std::mutex> lock(mtx_);
+                    metrics_.failed += batch->jobs.size();
+                }
+                const std::exception_ptr e = std::current_exception();
+                for (Job& j : batch->jobs) {
+                    try { j.promise.set_exception(e); }
+                    catch (const std::future_error&) {}     // ja tenia el resultat
+                }
+            }
+        }
+    }
+
+    void SolveService::RunBatch(Batch& batch)
+    {
+        const Matrix& A = *batch.A;
+        const std::size_t n = A.rows;
+        const std::size_t m = batch.jobs.size();
+
+        TraceSpan span("SolveService::RunBatch");
+        OpsCounter ops;
+        Timer timer;
+        timer.Tic();
+
+        std::vector<SolveReport> reports(m);
+        std::shared_ptr<const LUFactors> Fp;
+        FactorInfo info;
+        {
+            TraceSpan s("factoritzacio");
+            Fp = cfg_.cache
+                ? cfg_.cache->GetOrFactorize(A, cfg_.tol, &ops, nullptr, &info)
+                : std::make_shared<const LUFactors>(FactorizeLU(A, cfg_.tol, &ops));
+        }
+        const LUFactors& F = *Fp;
+
+        // Un sol estimador per lot: totes les peticions comparteixen A i els seus factors. Amb cache,
+        // condició i creixement ja venen calculats amb l'entrada.
+        double cond1 = info.cond1, growth = info.pivot_growth;
+        LogDet det;
+        if (!F.singular) {
+            TraceSpan s("condicio");
+            if (!cfg_.cache) {
+                cond1 = EstimateCond1(A, F);
+                growth = PivotGrowth(A, F.LU);
+            }
+            det = LogDeterminant(F);
+        }
+        if (!F.singular) {
+            TraceSpan s("substitucio");
+            // Una sola passada multi-RHS: les columnes de X són els b de cada petició.
+            Matrix X(n, m);
+            for (std::size_t j = 0; j < m; ++j) {
+                for (std::size_t i = 0; i < n; ++i) X.a[i * m + j] = batch.jobs[j].b[i];
+            }
+            SolveFactorized(F, X, &ops);
+            for (std::size_t j = 0; j < m; ++j) {
+                reports[j].x.resize(n);
+                for (std::size_t i = 0; i < n; ++i) reports[j].x[i] = X.a[i * m + j];
+            }
+        }
+        double ms = timer.TocMs();
+
+        for (std::size_t j = 0; j < m; ++j) {
+            SolveReport& r = reports[j];
+            r.n = n;
+            r.singular = F.singular;
+            r.ops = ops;    // operacions del lot sencer (compartit entre peticions)
+            r.ms = ms;
+            r.cond1 = cond1;
+            r.pivot_growth = growth;
+            r.log_abs_det = det.log_abs;
+            r.det_sign = det.sign;
+            if (!F.singular) {
+                TraceSpan s("residu");
+                r.rel_resid = RelativeResidual(A, r.x, batch.jobs[j].b, nullptr);
+            }
+        }
+
+        // Actualitzem les mètriques abans de lliurar els resultats perquè qui espera
+        // el future les vegi ja consolidades.
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            metrics_.completed += m;
+            ++metrics_.batches;
+            metrics_.total_solve_ms += ms;
+            metrics_.max_solve_ms = std::max(metrics_.max_solve_ms, ms);
+        }
+        for (std::size_t j = 0; j < m; ++j) {
+            batch.jobs[j].promise.set_value(std::move(reports[j]));
+        }
+    }
+}
@@ -0,0 +1,175 @@
+#include "Matrix.hpp"
+#include "Parallel.hpp"
+#include "PerfCounters.hpp"
+#include "Trace.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+    constexpr std::size_t kBlock = 64;
+
+    // Cas base: C = A * B (n x n) amb un recorregut i-k-j per blocs, amigable amb row-major.
+    void BaseMultiply(const double* A, std::size_t lda, const double* B, std::size_t ldb,
+        double* C, std::size_t ldc, std::size_t n, OpsCounter* op)
+    {
+        for (std::size_t i = 0; i < n; ++i) {
+            for (std::size_t j = 0; j < n; ++j) C[i * ldc + j] = 0.0;
+        }
+
+        for (std::size_t ii = 0; ii < n; ii += kBlock) {
+            const std::size_t ie = std::min(ii + kBlock, n);
+            for (std::size_t kk = 0; kk < n; kk += kBlock) {
+                const std::size_t ke = std::min(kk + kBlock, n);
+                for (std::size_t jj = 0; jj < n; jj += kBlock) {
+                    const std::size_t je = std::min(jj + kBlock, n);
+                    for (std::size_t i = ii; i < ie; ++i) {
+                        double* c = C + i * ldc;
+                        for (std::size_t k = kk; k < ke; ++k) {
+                            const double a = A[i * lda + k];
+                            const double* b = B + k * ldb;
+                            for (std::size_t j = jj; j < je; ++j) c[j] += a * b[j];
+                        }
+                    }
+                }
+            }
+        }
+
+        // Mateix criteri que Multiply: n productes i n-1 sumes per element de C.
+        if (op && n > 0) {
+            op->IncMul(n * n * n);
+            op->IncAdd(n * n * (n - 1));
+        }
+    }
+
+    void AddBlock(const double* X, std::size_t ldx, const double* Y, std::size_t ldy,
+        double* Z, std::size_t ldz, std::size_t h, OpsCounter* op)
+    {
+        for (std::size_t i = 0; i < h; ++i) {
+            for (std::size_t j = 0; j < h; ++j) Z[i * ldz + j] = X[i * ldx + j] + Y[i * ldy + j];
+        }
+        if (op) op->IncAdd(h * h);
+    }
+
+    void SubBlock(const double* X, std::size_t ldx, const double* Y, std::size_t ldy,
+        double* Z, std::size_t ldz, std::size_t h, OpsCounter* op)
+    {
+        for (std::size_t i = 0; i < h; ++i) {
+            for (std::size_t j = 0; j < h; ++j) Z[i * ldz + j] = X[i * ldx + j] - Y[i * ldy + j];
+        }
+        if (op) op->IncSub(h * h);
+    }
+
+    void StrassenRec(const double* A, std::size_t lda, const double* B, std::size_t ldb,
+        double* C, std::size_t ldc, std::size_t n, std::size_t cutoff, OpsCounter* op, bool parallel)
+    {
+        if (n <= cutoff || n % 2 != 0) {
+            BaseMultiply(A, lda, B, ldb, C, ldc, n, op);
+            return;
+        }
+
+        const std::size_t h = n / 2, hh = h * h;
+        const double* A11 = A; const double* A12 = A + h;
+        const double* A21 = A + h * lda; const double* A22 = A21 + h;
+        const double* B11 = B; const double* B12 = B + h;
+        const double* B21 = B + h * ldb; const double* B22 = B21 + h;
+        double* C11 = C; double* C12 = C + h;
+        double* C21 = C + h * ldc; double* C22 = C21 + h;
+
+        // Temporals contigus (ld = h): S1..S4, T1..T4 i M1..M7.
+        std::vector<double> buf(15 * hh);
+        double* S[4]; double* T[4]; double* M[7];
+        for (int i = 0; i < 4; ++i) { S[i] = buf.data() + i * hh; T[i] = buf.data() + (4 + i) * hh; }
+        for (int i = 0; i < 7; ++i) M[i] = buf.data() + (8 + i) * hh;
+
+        // Variant de Winograd: 8 sumes/restes a l'entrada.
+        AddBlock(A21, lda, A22, lda, S[0], h, h, op);      // S1 = A21 + A22
+        SubBlock(S[0], h, A11, lda, S[1], h, h, op);       // S2 = S1 - A11
+        SubBlock(A11, lda, A21, lda, S[2], h, h, op);      // S3 = A11 - A21
+        SubBlock(A12, lda, S[1], h, S[3], h, h, op);       // S4 = A12 - S2
+        SubBlock(B12, ldb, B11, ldb, T[0], h, h, op);      // T1 = B12 - B11
+        SubBlock(B22, ldb, T[0], h, T[1], h, h, op);       // T2 = B22 - T1
+        SubBlock(B22, ldb, B12, ldb, T[2], h, h, op);      // T3 = B22 - B12
+        SubBlock(T[1], h, B21, ldb, T[3], h, h, op);       // T4 = T2 - B21
+
+        struct Product { const double* X; std::size_t ldx; const double* Y; std::size_t ldy; };
+        const Product P[7] = {
+            { A11, lda, B11, ldb },     // M1
+            { A12, lda, B21, ldb },     // M2
+            { S[3], h, B22, ldb },      // M3
+            { A22, lda, T[3], h },      // M4
+            { S[0], h, T[0], h },       // M5
+            { S[1], h, T[1], h },       // M6
+            { S[2], h, T[2], h },       // M7
+        };
+
+        if (parallel) {
+            // Cada fil compta en el seu propi OpsCounter; els fusionem en acabar.
+            OpsCounter local[7];
+            LinAlg::ParallelFor(7, [&](std::size_t i) {
+                LinAlg::TraceSpan span("Strassen::producte");
+                StrassenRec(P[i].X, P[i].ldx, P[i].Y, P[i].ldy, M[i], h, h, cutoff, op ? &local[i] : nullptr, false);
+            });
+            if (op) {
+                for (const OpsCounter& c : local) op->Merge(c);
+            }
+        }
+        else {
+            for (int i = 0; i < 7; ++i) {
+                StrassenRec(P[i].X, P[i].ldx, P[i].Y, P[i].ldy, M[i], h, h, cutoff, op, false);
+            }
+        }
+
+        // 7 sumes/restes a la sortida.
+        AddBlock(M[0], h, M[1], h, C11, ldc, h, op);       // C11 = M1 + M2
+        AddBlock(M[0], h, M[5], h, M[5], h, h, op);        // U2  = M1 + M6
+        AddBlock(M[5], h, M[6], h, M[6], h, h, op);        // U3  = U2 + M7
+        AddBlock(M[5], h, M[4], h, M[5], h, h, op);        // U4  = U2 + M5
+        AddBlock(M[5], h, M[2], h, C12, ldc, h, op);       // C12 = U4 + M3
+        SubBlock(M[6], h, M[3], h, C21, ldc, h, op);       // C21 = U3 - M4
+        AddBlock(M[6], h, M[4], h, C22, ldc, h, op);       // C22 = U3 + M5
+    }
+}
+
+Matrix Matrix::MultiplyStrassen(const Matrix& B, std::size_t cutoff, OpsCounter* op) const
+{
+    if (cols != B.rows) {
+        throw std::invalid_argument("Matrix::MultiplyStrassen: dimensions incompatibles");
+    }
+
+    // Només té sentit per a quadrades prou grans; la resta va pel camí clàssic.
+    const std::size_t n = rows;
+    if (cutoff == 0) cutoff = 1;
+    if (!IsSquare() || !B.IsSquare() || n <= cutoff) {
+        return Multiply(B, op);
+    }
+    LinAlg::MultiplyHwRecord hw;
+
+    // Mida farcida m = ceil(n / 2^d) * 2^d amb ceil(n / 2^d) <= cutoff: la recursió sempre parteix en parells.
+    std::size_t d = 0;
+    while (((n + (std::size_t(1) << d) - 1) >> d) > cutoff) ++d;
+    const std::size_t m = ((n + (std::size_t(1) << d) - 1) >> d) << d;
+
+    if (m == n) {
+        Matrix C(n, n);
+        StrassenRec(a.data(), n, B.a.data(), n, C.a.data(), n, n, cutoff, op, true);
+        return C;
+    }
+
+    // Farciment amb zeros fins a m x m.
+    Matrix Ap(m, m), Bp(m, m), Cp(m, m);
+    for (std::size_t i = 0; i < n; ++i) {
+        for (std::size_t j = 0; j < n; ++j) {
+            Ap.a[i * m + j] = a[i * n + j];
+            Bp.a[i * m + j] = B.a[i * n + j];
+        }
+    }
+    StrassenRec(Ap.a.data(), m, Bp.a.data(), m, Cp.a.data(), m, m, cutoff, op, true);
+
+    Matrix C(n, n);
+    for (std::size_t i = 0; i < n; ++i) {
+        for (std::size_t j = 0; j < n; ++j) C.a[i * n + j] = Cp.a[i * m + j];
+    }
+    return C;
+}
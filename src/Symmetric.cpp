@@ -0,0 +1,318 @@
+#include "Symmetric.hpp"
+#include "Condition.hpp"
+#include "Parallel.hpp"
+#include "Trace.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace LinAlg
+{
+
+    namespace
+    {
+        // Franges de files del triangle amb una quantitat de feina semblant: la fila i té i+1
+        // elements, així que els talls segueixen sqrt(p / parts) * n.
+        std::vector<std::size_t> TriangleBands(std::size_t n, std::size_t parts)
+        {
+            std::vector<std::size_t> cut(parts + 1, n);
+            cut[0] = 0;
+            for (std::size_t p = 1; p < parts; ++p) {
+                cut[p] = std::min(n, std::size_t(std::llround(n * std::sqrt(double(p) / double(parts)))));
+            }
+            for (std::size_t p = 1; p <= parts; ++p) cut[p] = std::max(cut[p], cut[p - 1]);
+            return cut;
+        }
+
+        // Quatre acumuladors independents: sense -ffast-math el compilador no reordena una sola
+        // suma, i Cholesky i Syrk(No) passen gairebé tot el temps en aquests productes escalars.
+        double Dot(const double* a, const double* b, std::size_t k)
+        {
+            double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+            std::size_t p = 0;
+            for (; p + 4 <= k; p += 4) {
+                s0 += a[p] * b[p];
+                s1 += a[p + 1] * b[p + 1];
+                s2 += a[p + 2] * b[p + 2];
+                s3 += a[p + 3] * b[p + 3];
+            }
+            for (; p < k; ++p) s0 += a[p] * b[p];
+            return (s0 + s1) + (s2 + s3);
+        }
+    }
+
+    SymPacked SymPacked::FromLower(const Matrix& A)
+    {
+        if (!A.IsSquare()) {
+            throw std::invalid_argument("SymPacked::FromLower: la matriu ha de ser quadrada");
+        }
+        SymPacked S(A.rows);
+        for (std::size_t i = 0; i < S.n; ++i) {
+            std::copy(A.a.begin() + i * S.n, A.a.begin() + i * S.n + i + 1, S.ap.begin() + i * (i + 1) / 2);
+        }
+        return S;
+    }
+
+    Matrix SymPacked::ToDense() const
+    {
+        Matrix A(n, n);
+        for (std::size_t i = 0; i < n; ++i) {
+            const double* row = ap.data() + i * (i + 1) / 2;
+            for (std::size_t j = 0; j <= i; ++j) {
+                A.a[i * n + j] = row[j];
+                A.a[j * n + i] = row[j];
+            }
+        }
+        return A;
+    }
+
+    void Spmv(double alpha, const SymPacked& S, const Vec& x, double beta, Vec& y, OpsCounter* op)
+    {
+        const std::size_t n = S.n;
+        if (x.size() != n || y.size() != n) {
+            throw std::invalid_argument("Spmv: dimensions incompatibles");
+        }
+        if (&x == &y) {
+            throw std::invalid_argument("Spmv: x i y no poden ser el mateix vector");
+        }
+
+        if (beta == 0.0) std::fill(y.begin(), y.end(), 0.0);
+        else if (beta != 1.0) for (double& v : y) v *= beta;
+        if (op && n) {
+            op->IncMul(n * n);
+            op->IncAdd(n * (n - 1));
+            if (alpha != 1.0) op->IncMul(n);
+            if (beta != 0.0) {
+                if (beta != 1.0) op->IncMul(n);
+                op->IncAdd(n);
+            }
+        }
+        if (n == 0 || alpha == 0.0) {
+            return;
+        }
+
+        // Fila i del triangle: la part (i, j<i) contribueix a y[i] (producte escalar) i, per
+        // simetria, a y[j] (axpy amb alpha * x[i]). Tot sobre la mateixa fila contigua.
+        const double* ap = S.ap.data();
+        for (std::size_t i = 0; i < n; ++i) {
+            const double* row = ap + i * (i + 1) / 2;
+            const double xi = alpha * x[i];
+            double acc = 0.0;
+            for (std::size_t j = 0; j < i; ++j) {
+                acc += row[j] * x[j];
+                y[j] += row[j] * xi;
+            }
+            y[i] += alpha * acc + row[i] * xi;
+        }
+    }
+
+    void Syrk(Trans ta, double alpha, const Matrix& A, double beta, SymPacked& C, std::size_t threads, OpsCounter* op)
+    {
+        // ta == No: C (m x m) = A A^T amb A m x k; ta == Yes: C (m x m) = A^T A amb A k x m.
+        const std::size_t m = (ta == Trans::No) ? A.rows : A.cols;
+        const std::size_t k = (ta == Trans::No) ? A.cols : A.rows;
+        if (C.n != m) {
+            throw std::invalid_argument("Syrk: dimensions incompatibles");
+        }
+
+        if (beta == 0.0) std::fill(C.ap.begin(), C.ap.end(), 0.0);
+        else if (beta != 1.0) for (double& v : C.ap) v *= beta;
+
+        const std::size_t stored = m * (m + 1) / 2;
+        if (op && stored) {
+            if (k > 0) {
+                op->IncMul(stored * k);
+                op->IncAdd(stored * (k - 1));
+            }
+            if (alpha != 1.0) op->IncMul(stored);
+            if (beta != 0.0) {
+                if (beta != 1.0) op->IncMul(stored);
+                op->IncAdd(stored);
+            }
+        }
+        if (m == 0 || k == 0 || alpha == 0.0) {
+            return;
+        }
+
+        const std::size_t t = std::max<std::size_t>(1, std::min(m, threads ? threads : HardwareThreads()));
+        const std::vector<std::size_t> band = TriangleBands(m, t);
+        const double* a = A.a.data();
+        double* c = C.ap.data();
+
+        if (ta == Trans::No) {
+            // C[i, j] = <A[i,:], A[j,:]> per j <= i: productes escalars de files contigües.
+            ParallelFor(t, [&](std::size_t b) {
+                for (std::size_t i = band[b]; i < band[b + 1]; ++i) {
+                    double* ci = c + i * (i + 1) / 2;
+                    const double* ai = a + i * k;
+                    for (std::size_t j = 0; j <= i; ++j) ci[j] += alpha * Dot(ai, a + j * k, k);
+                }
+            }, t);
+        }
+        else {
+            // C += A[p,:]^T A[p,:] fila a fila de A: per a la fila i de C, axpy de A[p, 0..i] amb
+            // alpha * A[p, i]. Cada fil recorre totes les files de A però només escriu la seva franja.
+            constexpr std::size_t kRows = 64;    // files de A per bloc: les files de C queden a la cache
+            ParallelFor(t, [&](std::size_t b) {
+                for (std::size_t p0 = 0; p0 < k; p0 += kRows) {
+                    const std::size_t p1 = std::min(k, p0 + kRows);
+                    for (std::size_t i = band[b]; i < band[b + 1]; ++i) {
+                        double* ci = c + i * (i + 1) / 2;
+                        for (std::size_t p = p0; p < p1; ++p) {
+                            const double* ap = a + p * m;
+                            const double s = alpha * ap[i];
+                            for (std::size_t j = 0; j <= i; ++j) ci[j] += s * ap[j];
+                        }
+                    }
+                }
+            }, t);
+        }
+    }
+
+    bool FactorizeCholesky(SymPacked& S, double tol, OpsCounter* op)
+    {
+        // Variant per files (Cholesky-Crout): L[i, j] = (a_ij - <L[i, 0..j), L[j, 0..j)>) / L_jj.
+        // Les dues files són prefixos contigus del triangle empaquetat.
+        const std::size_t n = S.n;
+        double* ap = S.ap.data();
+        for (std::size_t i = 0; i < n; ++i) {
+            double* li = ap + i * (i + 1) / 2;
+            for (std::size_t j = 0; j < i; ++j) {
+                const double* lj = ap + j * (j + 1) / 2;
+                li[j] = (li[j] - Dot(li, lj, j)) / lj[j];
+            }
+            const double d = li[i] - Dot(li, li, i);
+            if (op) {
+                op->IncMul(i * (i + 1) / 2);
+                op->IncSub(i * (i + 1) / 2);
+                op->IncDiv(i);
+                op->IncCmp();
+            }
+            if (!(d > tol)) {
+                return false;
+            }
+            li[i] = std::sqrt(d);
+        }
+        return true;
+    }
+
+    void SolveCholesky(const SymPacked& L, Vec& b, OpsCounter* op)
+    {
+        const std::size_t n = L.n;
+        if (b.size() != n) {
+            throw std::invalid_argument("SolveCholesky: dimensions incompatibles");
+        }
+        const double* ap = L.ap.data();
+
+        // L y = b: producte escalar amb el prefix de cada fila.
+        for (std::size_t i = 0; i < n; ++i) {
+            const double* li = ap + i * (i + 1) / 2;
+            b[i] = (b[i] - Dot(li, b.data(), i)) / li[i];
+        }
+        // L^T x = y: la columna i de L^T és la fila i de L; en resoldre x_i el restem de les
+        // incògnites anteriors amb un axpy sobre la mateixa fila.
+        for (std::size_t i = n; i-- > 0;) {
+            const double* li = ap + i * (i + 1) / 2;
+            b[i] /= li[i];
+            const double xi = b[i];
+            for (std::size_t j = 0; j < i; ++j) b[j] -= li[j] * xi;
+        }
+        if (op && n) {
+            op->IncMul(n * (n - 1));
+            op->IncSub(n * (n - 1));
+            op->IncDiv(2 * n);
+        }
+    }
+
+    SolveReport SolveSymmetric(SymPacked S, Vec b, double tol)
+    {
+        TraceSpan span("SolveSymmetric");
+        SolveReport report;
+        report.n = S.n;
+        if (b.size() != S.n) {
+            return report;
+        }
+
+        Timer phase;
+        phase.Tic();
+        SymPacked S_orig;
+        Vec b_orig;
+        {
+            TraceSpan s("copia");
+            S_orig = S;
+            b_orig = b;
+        }
+        report.phases.copy_ms = phase.TocMs();
+
+        Timer timer;
+        timer.Tic();
+        bool ok;
+        {
+            TraceSpan s("eliminacio");
+            HwScope hw(&report.hw.elimination);
+            ok = FactorizeCholesky(S, tol, &report.ops);
+        }
+        report.phases.elimination_ms = timer.TocMs();
+        if (!ok) {
+            report.pivot_zero = true;
+            report.ms = timer.TocMs();
+            return report;
+        }
+
+        phase.Tic();
+        {
+            TraceSpan s("substitucio");
+            HwScope hw(&report.hw.back_substitution);
+            SolveCholesky(S, b, &report.ops);
+        }
+        report.phases.back_ms = phase.TocMs();
+        report.x = std::move(b);
+        report.ms = timer.TocMs();
+
+        phase.Tic();
+        {
+            TraceSpan s("residu");
+            HwScope hw(&report.hw.residual);
+            Vec r = b_orig;
+            Spmv(1.0, S_orig, report.x, -1.0, r);
+            double nr = 0.0, nb = 0.0;
+            for (std::size_t i = 0; i < r.size(); ++i) { nr += r[i] * r[i]; nb += b_orig[i] * b_orig[i]; }
+            report.rel_resid = nb > 0.0 ? std::sqrt(nr / nb) : std::sqrt(nr);
+        }
+        report.phases.residual_ms = phase.TocMs();
+
+        // det(S) = prod(L_jj)^2 > 0. Condició i creixement com a SolvePartialPivot: A^-1 és simètrica,
+        // així que l'estimador fa servir SolveCholesky en tots dos sentits. La U de l'LU sense pivots
+        // d'una SPD és diag(L) L^T, u_ji = L_jj L_ij.
+        phase.Tic();
+        {
+            TraceSpan s("condicio");
+            const std::size_t n = S.n;
+            const double* ap = S.ap.data();
+            Vec col(n, 0.0);
+            double max_a = 0.0, max_u = 0.0;
+            for (std::size_t i = 0; i < n; ++i) {
+                const double* ai = S_orig.ap.data() + i * (i + 1) / 2;
+                const double* li = ap + i * (i + 1) / 2;
+                for (std::size_t j = 0; j <= i; ++j) {
+                    const double v = std::abs(ai[j]);
+                    col[j] += v;
+                    if (j != i) col[i] += v;
+                    max_a = std::max(max_a, v);
+                    max_u = std::max(max_u, std::abs(ap[j * (j + 1) / 2 + j] * li[j]));
+                }
+            }
+            double norm1 = 0.0;
+            for (double c : col) norm1 = std::max(norm1, c);
+            const auto solve = [&](Vec& x) { SolveCholesky(S, x); };
+            report.cond1 = norm1 * EstimateInverseNorm1(n, solve, solve);
+            report.pivot_growth = max_a > 0.0 ? max_u / max_a : 0.0;
+            double log_abs = 0.0;
+            for (std::size_t j = 0; j < S.n; ++j) log_abs += 2.0 * std::log(S.ap[j * (j + 1) / 2 + j]);
+            report.log_abs_det = log_abs;
+            report.det_sign = 1;
+        }
+        report.phases.condition_ms = phase.TocMs();
+        return report;
+    }
+}
@@ -0,0 +1,170 @@
+#include "Trace.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+
+namespace LinAlg
+{
+
+    namespace
+    {
+        // Cada fil escriu al seu buffer; el mutex propi només es disputa quan algú exporta.
+        struct ThreadBuffer
+        {
+            std::mutex mtx;
+            std::uint32_t tid = 0;
+            std::string name;
+            std::uint32_t depth = 0;
+            std::vector<TraceEvent> events;
+        };
+
+        struct Registry
+        {
+            std::mutex mtx;
+            std::vector<std::shared_ptr<ThreadBuffer>> buffers;     // sobreviuen als fils
+            std::uint32_t next_tid = 1;
+        };
+
+        std::atomic<bool> g_enabled{ false };
+        const auto g_epoch = std::chrono::steady_clock::now();
+
+        Registry& GetRegistry()
+        {
+            static Registry r;
+            return r;
+        }
+
+        ThreadBuffer& LocalBuffer()
+        {
+            thread_local std::shared_ptr<ThreadBuffer> local = [] {
+                auto buf = std::make_shared<ThreadBuffer>();
+                Registry& r = GetRegistry();
+                std::lock_guard<std::mutex> lock(r.mtx);
+                buf->tid = r.next_tid++;
+                r.buffers.push_back(buf);
+                return buf;
+            }();
+            return *local;
+        }
+
+        std::string Quote(const std::string& v)
+        {
+            std::string out = "\"";
+            for (char c : v) {
+                if (c == '"' || c == '\\') out += '\\';
+                out += c;
+            }
+            return out + "\"";
+        }
+    }
+
+    void SetTracingEnabled(bool on)
+    {
+        g_enabled.store(on, std::memory_order_relaxed);
+    }
+
+    bool TracingEnabled()
+    {
+        return g_enabled.load(std::memory_order_relaxed);
+    }
+
+    double TraceNowUs()
+    {
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - g_epoch).count();
+    }
+
+    std::uint32_t TraceThreadId()
+    {
+        return LocalBuffer().tid;
+    }
+
+    void SetTraceThreadName(const std::string& name)
+    {
+        ThreadBuffer& buf = LocalBuffer();
+        std::lock_guard<std::mutex> lock(buf.mtx);
+        buf.name = name;
+    }
+
+    TraceSpan::TraceSpan(const char* name) : name_(name)
+    {
+        if (!TracingEnabled()) return;
+        active_ = true;
+        ++LocalBuffer().depth;
+        start_us_ = TraceNowUs();
+    }
+
+    TraceSpan::~TraceSpan()
+    {
+        if (!active_) return;
+        double end_us = TraceNowUs();
+        ThreadBuffer& buf = LocalBuffer();
+        --buf.depth;
+
+        TraceEvent e;
+        e.name = name_;
+        e.tid = buf.tid;
+        e.depth = buf.depth;
+        e.start_us = start_us_;
+        e.dur_us = end_us - start_us_;
+        std::lock_guard<std::mutex> lock(buf.mtx);
+        buf.events.push_back(e);
+    }
+
+    std::vector<TraceEvent> CollectTrace()
+    {
+        std::vector<TraceEvent> all;
+        Registry& r = GetRegistry();
+        std::lock_guard<std::mutex> lock(r.mtx);
+        for (const auto& buf : r.buffers) {
+            std::lock_guard<std::mutex> block(buf->mtx);
+            all.insert(all.end(), buf->events.begin(), buf->events.end());
+        }
+        // A igual inici, el pare (menys profund) primer.
+        std::sort(all.begin(), all.end(), [](const TraceEvent& a, const TraceEvent& b) {
+            return a.start_us != b.start_us ? a.start_us < b.start_us : a.depth < b.depth;
+        });
+        return all;
+    }
+
+    void ClearTrace()
+    {
+        Registry& r = GetRegistry();
+        std::lock_guard<std::mutex> lock(r.mtx);
+        for (const auto& buf : r.buffers) {
+            std::lock_guard<std::mutex> block(buf->mtx);
+            buf->events.clear();
+        }
+    }
+
+    bool WriteChromeTrace(const std::string& path)
+    {
+        std::ofstream f(path, std::ios::trunc);
+        if (!f) return false;
+        f.precision(15);
+
+        f << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+        bool first = true;
+        {
+            Registry& r = GetRegistry();
+            std::lock_guard<std::mutex> lock(r.mtx);
+            for (const auto& buf : r.buffers) {
+                std::lock_guard<std::mutex> block(buf->mtx);
+                if (buf->events.empty()) continue;
+                std::string name = buf->name.empty() ? "fil " + std::to_string(buf->tid) : buf->name;
+                f << (first ? "" : ",\n") << "{\"ph\": \"M\", \"name\": \"thread_name\", \"pid\": 1, \"tid\": " << buf->tid
+                    << ", \"args\": {\"name\": " << Quote(name) << "}}";
+                first = false;
+            }
+        }
+        for (const TraceEvent& e : CollectTrace()) {
+            f << (first ? "" : ",\n") << "{\"ph\": \"X\", \"name\": " << Quote(e.name) << ", \"pid\": 1, \"tid\": " << e.tid
+                << ", \"ts\": " << e.start_us << ", \"dur\": " << e.dur_us << "}";
+            first = false;
+        }
+        f << "\n]}\n";
+        return bool(f);
+    }
+}